@@ -0,0 +1,155 @@
+#ifndef MATHLIB_BENCH_HPP
+#define MATHLIB_BENCH_HPP
+#pragma once
+
+#include <math/math.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace math::bench
+{
+	// OPTIMIZATION BARRIERS
+
+	void UseCharPointer(const volatile char* p);
+
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "m"(value) : "memory");
+#endif
+	}
+
+	// REGISTRY
+
+	// One benchmark: run(iterations) performs `iterations` operations, each touching `items` elements.
+	struct Case
+	{
+		std::string name;
+		size_t items = 1;
+		std::function<void(size_t)> run;
+	};
+
+	std::vector<Case>& Registry();
+
+	constexpr size_t POOL_SIZE = 1024;
+
+	class Suite
+	{
+	public:
+		explicit Suite(std::string group, void (*define)(Suite&)) : group(std::move(group)) { define(*this); }
+
+		// Per-call benchmark: f(i) is called with i cycling through the input pools.
+		template<typename F>
+		void Add(const std::string& name, F f)
+		{
+			Registry().push_back({ group + "/" + name, 1, [f](size_t iterations)
+			{
+				for (size_t n = 0; n < iterations; ++n)
+				{
+					if constexpr (std::is_void_v<decltype(f(size_t(0)))>)
+					{
+						f(n & (POOL_SIZE - 1));
+					}
+					else
+					{
+						DoNotOptimize(f(n & (POOL_SIZE - 1)));
+					}
+				}
+			} });
+		}
+
+		// Batch benchmark: one call of f() processes `items` elements.
+		template<typename F>
+		void AddBatch(const std::string& name, size_t items, F f)
+		{
+			Registry().push_back({ group + "/" + name, items, [f](size_t iterations)
+			{
+				for (size_t n = 0; n < iterations; ++n)
+				{
+					f();
+				}
+			} });
+		}
+
+	private:
+		std::string group;
+	};
+
+	// INPUT POOLS
+
+	template<typename T>
+	T Random(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float32> dist(-1.0f, 1.0f);
+
+		if constexpr (std::is_same_v<T, float32>)
+		{
+			return dist(rng);
+		}
+		else if constexpr (std::is_same_v<T, Quaternion>)
+		{
+			return Quaternion(dist(rng), dist(rng), dist(rng), dist(rng) + 2.0f).Normalize();
+		}
+		else if constexpr (requires { T::rows; })
+		{
+			T m;
+			for (size_t col = 0; col < T::cols; ++col)
+			{
+				for (size_t row = 0; row < T::rows; ++row)
+				{
+					m(row, col) = dist(rng) + (row == col ? 4.0f : 0.0f);
+				}
+			}
+			return m;
+		}
+		else
+		{
+			T v;
+			for (size_t i = 0; i < sizeof(T) / sizeof(v[0]); ++i)
+			{
+				v[i] = dist(rng);
+			}
+			return v;
+		}
+	}
+
+	template<typename T>
+	std::vector<T> RandomVector(size_t count, uint32_t seed)
+	{
+		std::mt19937 rng(seed * 7919u + static_cast<uint32_t>(sizeof(T)));
+		std::vector<T> values(count);
+		for (T& value : values)
+		{
+			value = Random<T>(rng);
+		}
+		return values;
+	}
+
+	// POOL_SIZE deterministic values; different seeds give independent pools.
+	template<typename T>
+	const std::vector<T>& Pool(uint32_t seed = 0)
+	{
+		static std::map<uint32_t, std::vector<T>> pools;
+		auto it = pools.find(seed);
+		if (it == pools.end())
+		{
+			it = pools.emplace(seed, RandomVector<T>(POOL_SIZE, seed)).first;
+		}
+		return it->second;
+	}
+}
+
+#endif // MATHLIB_BENCH_HPP
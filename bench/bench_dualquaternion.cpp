@@ -0,0 +1,105 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	constexpr size_t BATCH = 10000;
+
+	void Define(Suite& s)
+	{
+		const Quaternion* a = Pool<Quaternion>(0).data();
+		const Quaternion* b = Pool<Quaternion>(1).data();
+		const Vec3* v = Pool<Vec3>(0).data();
+		const Vec3* w = Pool<Vec3>(1).data();
+		const float32* t = Pool<float32>(0).data();
+
+		static const std::vector<DualQuaternion> dualA = [&]
+		{
+			std::vector<DualQuaternion> d(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) d[i] = DualQuaternion::FromRotationTranslation(a[i], v[i]);
+			return d;
+		}();
+		static const std::vector<DualQuaternion> dualB = [&]
+		{
+			std::vector<DualQuaternion> d(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) d[i] = DualQuaternion::FromRotationTranslation(b[i], w[i]);
+			return d;
+		}();
+		static const std::vector<Mat4> matA = [&]
+		{
+			std::vector<Mat4> m(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) m[i] = dualA[i].ToMatrix4();
+			return m;
+		}();
+		static const std::vector<Mat4> matB = [&]
+		{
+			std::vector<Mat4> m(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) m[i] = dualB[i].ToMatrix4();
+			return m;
+		}();
+		const DualQuaternion* da = dualA.data();
+		const DualQuaternion* db = dualB.data();
+		const Mat4* ma = matA.data();
+		const Mat4* mb = matB.data();
+
+		// CONSTRUCTION
+		s.Add("FromRotationTranslation", [=](size_t i) { return DualQuaternion::FromRotationTranslation(a[i], v[i]); });
+		s.Add("FromMatrix", [=](size_t i) { return DualQuaternion::FromMatrix(ma[i]); });
+		s.Add("ToMatrix4", [=](size_t i) { return da[i].ToMatrix4(); });
+
+		// COMPOSITION, against the Mat4 equivalents
+		s.Add("operator*", [=](size_t i) { return da[i] * db[i]; });
+		s.Add("operator*(Mat4)", [=](size_t i) { return ma[i] * mb[i]; });
+		s.Add("TransformPoint", [=](size_t i) { return da[i].TransformPoint(w[i]); });
+		s.Add("TransformPoint(Mat4)", [=](size_t i) { return ma[i] * Vec4(w[i][0], w[i][1], w[i][2], 1.0f); });
+		s.Add("Inverse", [=](size_t i) { return da[i].Conjugate(); });
+		s.Add("Inverse(Mat4)", [=](size_t i) { return InverseAffine(ma[i]); });
+
+		// MEMBERS
+		s.Add("Normalize", [=](size_t i) { return (da[i] * 1.5f).Normalize(); });
+		s.Add("GetTranslation", [=](size_t i) { return da[i].GetTranslation(); });
+
+		// BLENDING
+		s.Add("Sclerp", [=](size_t i) { return Sclerp(da[i], db[i], t[i] * 0.5f + 0.5f); });
+		s.Add("Sclerp(Accurate)", [=](size_t i) { return Sclerp(da[i], db[i], t[i] * 0.5f + 0.5f, TrigPrecision::Accurate); });
+		s.Add("Dlb", [=](size_t i) { return Dlb(da[i], db[i], t[i] * 0.5f + 0.5f); });
+
+		// BATCHED
+		static const DualQuaternionStream streamA = [&]
+		{
+			DualQuaternionStream d(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) d.Set(i, dualA[i % POOL_SIZE]);
+			return d;
+		}();
+		static const DualQuaternionStream streamB = [&]
+		{
+			DualQuaternionStream d(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) d.Set(i, dualB[i % POOL_SIZE]);
+			return d;
+		}();
+		static const Vec3Stream points = [&]
+		{
+			Vec3Stream p(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) p.Set(i, w[i % POOL_SIZE]);
+			return p;
+		}();
+		static const std::vector<Mat4> matricesA(BATCH, ma[0]);
+		static const std::vector<Mat4> matricesB(BATCH, mb[0]);
+		static DualQuaternionStream composed;
+		static Vec3Stream transformed;
+		static std::vector<Mat4> products(BATCH);
+
+		s.AddBatch("Multiply(stream)/10k", BATCH, [] { Multiply(streamA, streamB, composed); DoNotOptimize(composed.Data(0)[0]); });
+		s.AddBatch("Multiply(Mat4 loop)/10k", BATCH, []
+		{
+			for (size_t i = 0; i < BATCH; ++i) products[i] = matricesA[i] * matricesB[i];
+			DoNotOptimize(products[0](0, 0));
+		});
+		s.AddBatch("Normalize(stream)/10k", BATCH, [] { Normalize(streamA, composed); DoNotOptimize(composed.Data(0)[0]); });
+		s.AddBatch("TransformPoints(stream)/10k", BATCH, [] { TransformPoints(streamA, points, transformed); DoNotOptimize(transformed.Data(0)[0]); });
+	}
+
+	const Suite DUALQUATERNION("dualquaternion", Define);
+}
@@ -0,0 +1,69 @@
+#include "bench.hpp"
+
+#include <math/expression.hpp>
+
+using namespace math;
+using namespace math::bench;
+
+// Default operators against the opt-in Lazy() layer on the same expressions.
+
+namespace
+{
+	template<size_t N, typename T>
+	Vec<N, T> LazyRefract(const Vec<N, T>& I, const Vec<N, T>& n, T eta)
+	{
+		T cosi = -Dot(n, I);
+		T k = 1 - eta * eta * (1 - cosi * cosi);
+		if (k < 0) return Reflect(I, n);
+		return eta * Lazy(I) + (eta * cosi - Sqrt(k)) * Lazy(n);
+	}
+
+	template<size_t N, typename T>
+	Vec<N, T> LazyLerp(const Vec<N, T>& a, const Vec<N, T>& b, T t)
+	{
+		return Lazy(a) + (Lazy(b) - a) * t;
+	}
+
+	template<size_t N, typename T>
+	Vec<N, T> LazyProject(const Vec<N, T>& a, const Vec<N, T>& b)
+	{
+		T lengthSquared = b.LengthSquared();
+		if (lengthSquared == 0) return Vec<N, T>();
+		return Lazy(b) * (Dot(a, b) / lengthSquared);
+	}
+
+	template<size_t N, typename T>
+	void ExpressionCases(Suite& s, const std::string& type)
+	{
+		using V = Vec<N, T>;
+
+		const V* a = Pool<V>(0).data();
+		const V* b = Pool<V>(1).data();
+		const float32* f = Pool<float32>(0).data();
+
+		s.Add(type + "/Refract", [=](size_t i) { return Refract(a[i], b[i], T(1), T(1.33)); });
+		s.Add(type + "/Refract/Lazy", [=](size_t i) { return LazyRefract(a[i], b[i], T(1) / T(1.33)); });
+		s.Add(type + "/Lerp", [=](size_t i) { return Lerp(a[i], b[i], T(f[i])); });
+		s.Add(type + "/Lerp/Lazy", [=](size_t i) { return LazyLerp(a[i], b[i], T(f[i])); });
+		s.Add(type + "/Project", [=](size_t i) { return Project(a[i], b[i]); });
+		s.Add(type + "/Project/Lazy", [=](size_t i) { return LazyProject(a[i], b[i]); });
+	}
+
+	void Define(Suite& s)
+	{
+		ExpressionCases<3, float32>(s, "Vec3");
+		ExpressionCases<4, float32>(s, "Vec4");
+		ExpressionCases<3, float64>(s, "Vec3d");
+		ExpressionCases<16, float64>(s, "Vec16d");
+
+		const Mat4* m = Pool<Mat4>(0).data();
+		const Vec4* v = Pool<Vec4>(0).data();
+		static const Mat4 proj = Perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+		static const Mat4 view = LookAt(Vec3(0, 2, 10), Vec3(0, 0, 0), Vec3Up());
+
+		s.Add("ProjViewModel*v", [=](size_t i) { return proj * view * m[i] * v[i]; });
+		s.Add("ProjViewModel*v/Lazy", [=](size_t i) { return Lazy(proj) * view * m[i] * v[i]; });
+	}
+
+	const Suite EXPRESSION("expression", Define);
+}
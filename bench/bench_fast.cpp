@@ -0,0 +1,52 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	// The tier is a template argument so each case sees a constant precision, as a call site would.
+	template<TrigPrecision P>
+	void DefineTier(Suite& s, const std::string& tier, const float32* x, const float32* f, const float32* g, const Vec3* v)
+	{
+		s.Add("SinCos" + tier, [=](size_t i) { float32 sn, cs; fast::SinCos(x[i], sn, cs, P); DoNotOptimize(cs); return sn; });
+		s.Add("Tan" + tier, [=](size_t i) { return fast::Tan(f[i], P); });
+		s.Add("Acos" + tier, [=](size_t i) { return fast::Acos(f[i], P); });
+		s.Add("Atan2" + tier, [=](size_t i) { return fast::Atan2(f[i], g[i], P); });
+		s.Add("RotateX" + tier, [=](size_t i) { return RotateX(x[i], P); });
+		s.Add("FromEuler" + tier, [=](size_t i) { return Quaternion::FromEuler(v[i][0], v[i][1], v[i][2], P); });
+		s.Add("ToEuler" + tier, [=](size_t i) { return Quaternion::FromEuler(v[i][0], v[i][1], v[i][2]).ToEuler(P); });
+	}
+
+	void Define(Suite& s)
+	{
+		const float32* f = Pool<float32>(0).data();
+		const float32* g = Pool<float32>(1).data();
+		const Vec3* v = Pool<Vec3>(0).data();
+
+		static const std::vector<float32> angles = [&]
+		{
+			std::vector<float32> x(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) x[i] = f[i] * 4.0f * PI_f32;
+			return x;
+		}();
+		const float32* x = angles.data();
+
+		// SCALAR
+		DefineTier<TrigPrecision::Exact>(s, "(Exact)", x, f, g, v);
+		DefineTier<TrigPrecision::Accurate>(s, "(Accurate)", x, f, g, v);
+		DefineTier<TrigPrecision::Fast>(s, "(Fast)", x, f, g, v);
+
+		// BATCHED
+		static std::vector<float32> out0(POOL_SIZE), out1(POOL_SIZE);
+		std::span<const float32> in0(x, POOL_SIZE);
+		std::span<const float32> in1(f, POOL_SIZE);
+		std::span<const float32> in2(g, POOL_SIZE);
+		s.AddBatch("SinCos(span)", POOL_SIZE, [=] { fast::SinCos(in0, out0, out1); DoNotOptimize(out0[0]); });
+		s.AddBatch("Tan(span)", POOL_SIZE, [=] { fast::Tan(in1, out0); DoNotOptimize(out0[0]); });
+		s.AddBatch("Acos(span)", POOL_SIZE, [=] { fast::Acos(in1, out0); DoNotOptimize(out0[0]); });
+		s.AddBatch("Atan2(span)", POOL_SIZE, [=] { fast::Atan2(in1, in2, out0); DoNotOptimize(out0[0]); });
+	}
+
+	const Suite FAST("fast", Define);
+}
@@ -0,0 +1,119 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	constexpr size_t BATCH = 10000;
+
+	void Define(Suite& s)
+	{
+		const Vec3* a = Pool<Vec3>(0).data();
+		const Vec3* b = Pool<Vec3>(1).data();
+		const Vec3* c = Pool<Vec3>(2).data();
+		const float32* f = Pool<float32>(0).data();
+
+		static const std::vector<Sphere> spheres = [&]
+		{
+			std::vector<Sphere> v(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) v[i] = Sphere(a[i] * 4.0f, Absolute(f[i]));
+			return v;
+		}();
+		static const std::vector<AABB> boxes = [&]
+		{
+			std::vector<AABB> v(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) v[i] = AABB::FromCenterExtents(b[i] * 4.0f, Abs(c[i]));
+			return v;
+		}();
+		static const std::vector<Ray> rays = [&]
+		{
+			std::vector<Ray> v(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) v[i] = Ray(a[i] * 8.0f, (b[i] * 4.0f - a[i] * 8.0f).Normalize());
+			return v;
+		}();
+		static const std::vector<Triangle> triangles = [&]
+		{
+			std::vector<Triangle> v(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) v[i] = Triangle(b[i] * 4.0f, b[i] * 4.0f + a[i], b[i] * 4.0f + c[i]);
+			return v;
+		}();
+		const Sphere* sp = spheres.data();
+		const AABB* bx = boxes.data();
+		const Ray* ry = rays.data();
+		const Triangle* tr = triangles.data();
+
+		static const Mat4 viewProj = Perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f) * LookAt(Vec3(0, 2, 8), Vec3(0, 0, 0), Vec3Up());
+		static const Frustum frustum = Frustum::FromViewProj(viewProj);
+
+		// PRIMITIVES
+		s.Add("Plane::FromPoints", [=](size_t i) { return Plane::FromPoints(a[i], b[i], c[i]); });
+		s.Add("Plane::SignedDistance", [=](size_t i) { return Plane(Vec3Up(), f[i]).SignedDistance(a[i]); });
+		s.Add("AABB::Expand", [=](size_t i) { AABB box = bx[i]; box.Expand(a[i]); return box; });
+		s.Add("Overlaps(AABB,AABB)", [=](size_t i) { return Overlaps(bx[i], bx[(i + 1) & (POOL_SIZE - 1)]); });
+		s.Add("Overlaps(AABB,Sphere)", [=](size_t i) { return Overlaps(bx[i], sp[i]); });
+		s.Add("Overlaps(Sphere,Sphere)", [=](size_t i) { return Overlaps(sp[i], sp[(i + 1) & (POOL_SIZE - 1)]); });
+
+		// RAY TESTS
+		s.Add("RayPlane", [=](size_t i) { float32 t = 0.0f; return RayPlane(ry[i], Plane(Vec3Up(), f[i]), t) ? t : -1.0f; });
+		s.Add("RaySphere", [=](size_t i) { float32 t = 0.0f; return RaySphere(ry[i], sp[i], t) ? t : -1.0f; });
+		s.Add("RayAABB", [=](size_t i) { float32 t = 0.0f; return RayAABB(ry[i], bx[i], t) ? t : -1.0f; });
+		s.Add("RayTriangle", [=](size_t i) { float32 t = 0.0f; return RayTriangle(ry[i], tr[i], t) ? t : -1.0f; });
+
+		// FRUSTUM
+		s.Add("Frustum::FromViewProj", [=](size_t i) { return Frustum::FromViewProj(viewProj * Translate(a[i])); });
+		s.Add("Frustum::Contains", [=](size_t i) { return frustum.Contains(a[i] * 4.0f); });
+		s.Add("Frustum::Intersects(Sphere)", [=](size_t i) { return frustum.Intersects(sp[i]); });
+		s.Add("Frustum::Intersects(AABB)", [=](size_t i) { return frustum.Intersects(bx[i]); });
+
+		// BATCHED, many rays against one primitive and one ray against many primitives
+		static const RayStream rayStream = [&]
+		{
+			RayStream r(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) r.Set(i, ry[i % POOL_SIZE]);
+			return r;
+		}();
+		static const AABBStream boxStream = [&]
+		{
+			AABBStream r(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) r.Set(i, bx[i % POOL_SIZE]);
+			return r;
+		}();
+		static const TriangleStream triangleStream = [&]
+		{
+			TriangleStream r(BATCH);
+			for (size_t i = 0; i < BATCH; ++i) r.Set(i, tr[i % POOL_SIZE]);
+			return r;
+		}();
+		static std::vector<uint64> hits((BATCH + 63) / 64);
+		static std::vector<float32> distances(BATCH);
+
+		s.AddBatch("RayAABB(rays)/10k", BATCH, [] { RayAABB(rayStream, boxes[0], hits, distances); DoNotOptimize(hits[0]); });
+		s.AddBatch("RayAABB(rays loop)/10k", BATCH, []
+		{
+			for (size_t i = 0; i < BATCH; ++i)
+			{
+				float32 t = std::numeric_limits<float32>::infinity();
+				RayAABB(rays[i % POOL_SIZE], boxes[0], t);
+				distances[i] = t;
+			}
+			DoNotOptimize(distances[0]);
+		});
+		s.AddBatch("RaySphere(rays)/10k", BATCH, [] { RaySphere(rayStream, spheres[0], hits, distances); DoNotOptimize(hits[0]); });
+		s.AddBatch("RayTriangle(rays)/10k", BATCH, [] { RayTriangle(rayStream, triangles[0], hits, distances); DoNotOptimize(hits[0]); });
+		s.AddBatch("RayAABB(boxes)/10k", BATCH, [] { RayAABB(rays[0], boxStream, hits, distances); DoNotOptimize(hits[0]); });
+		s.AddBatch("RayTriangle(triangles)/10k", BATCH, [] { RayTriangle(rays[0], triangleStream, hits, distances); DoNotOptimize(hits[0]); });
+		s.AddBatch("RayTriangle(triangles loop)/10k", BATCH, []
+		{
+			for (size_t i = 0; i < BATCH; ++i)
+			{
+				float32 t = std::numeric_limits<float32>::infinity();
+				RayTriangle(rays[0], triangles[i % POOL_SIZE], t);
+				distances[i] = t;
+			}
+			DoNotOptimize(distances[0]);
+		});
+	}
+
+	const Suite GEOMETRY("geometry", Define);
+}
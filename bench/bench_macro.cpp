@@ -0,0 +1,427 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	constexpr size_t NODES = 10000;
+	constexpr size_t POINTS = 1000000;
+	constexpr size_t POSES = 10000;
+	constexpr size_t SKIN_VERTICES = 50000;
+	constexpr size_t SKIN_BONES = 64;
+	constexpr size_t SKIN_INFLUENCES = 4;
+	constexpr size_t GRAPH_NODES = 100000;
+	constexpr size_t GRAPH_MOVED = GRAPH_NODES / 100;
+	constexpr size_t CULL_OBJECTS = 100000;
+	constexpr size_t LEVEL_CELLS = 256;
+	constexpr size_t LEVEL_TRIANGLES = LEVEL_CELLS * LEVEL_CELLS * 2;
+	constexpr size_t LEVEL_RAYS = 100000;
+	constexpr size_t CROWD = 100000;
+	constexpr size_t CROWD_BRUTE_FORCE = 1000;
+	constexpr float32 CROWD_RADIUS = 2.0f;
+	constexpr size_t CLOUD = 1000000;
+	constexpr size_t CLOUD_QUERIES = 100000;
+	constexpr size_t CLOUD_K = 8;
+	constexpr size_t CLOUD_BRUTE_FORCE = 100;
+
+	// Rolling terrain over a 512 m square, two triangles per cell, as static level geometry.
+	std::vector<Triangle> MakeLevel()
+	{
+		auto height = [](size_t x, size_t z) { return 4.0f * std::sin(0.07f * x) * std::cos(0.05f * z) + 0.02f * ((x * 7 + z * 13) % 17); };
+		auto vertex = [&](size_t x, size_t z) { return Vec3(2.0f * x - 256.0f, height(x, z), 2.0f * z - 256.0f); };
+
+		std::vector<Triangle> triangles;
+		triangles.reserve(LEVEL_TRIANGLES);
+		for (size_t z = 0; z < LEVEL_CELLS; ++z)
+		{
+			for (size_t x = 0; x < LEVEL_CELLS; ++x)
+			{
+				triangles.emplace_back(vertex(x, z), vertex(x + 1, z), vertex(x + 1, z + 1));
+				triangles.emplace_back(vertex(x, z), vertex(x + 1, z + 1), vertex(x, z + 1));
+			}
+		}
+		return triangles;
+	}
+
+	// Random recursive tree: shallow and wide, as a scene with many objects per parent.
+	TransformHierarchy MakeHierarchy()
+	{
+		std::mt19937 rng(43);
+		std::vector<Vec3> positions = RandomVector<Vec3>(GRAPH_NODES, 8);
+		std::vector<Quaternion> rotations = RandomVector<Quaternion>(GRAPH_NODES, 9);
+
+		TransformHierarchy hierarchy;
+		for (size_t i = 0; i < GRAPH_NODES; ++i)
+		{
+			uint32 parent = i == 0 ? TransformHierarchy::NO_PARENT : static_cast<uint32>(rng() % i);
+			hierarchy.AddNode(parent, positions[i], rotations[i]);
+		}
+		hierarchy.Update();
+		return hierarchy;
+	}
+
+	// Scene graph with parents stored before children, as a flattened hierarchy would be.
+	struct Scene
+	{
+		std::vector<uint32_t> parents;
+		std::vector<Vec3> positions;
+		std::vector<Quaternion> rotations;
+		std::vector<Vec3> scales;
+		std::vector<Mat4> locals;
+		std::vector<Mat4> worlds;
+
+		Scene()
+		{
+			std::mt19937 rng(42);
+			parents.resize(NODES);
+			for (size_t i = 1; i < NODES; ++i)
+			{
+				parents[i] = static_cast<uint32_t>(i - 1 - rng() % Min<size_t>(i, 8));
+			}
+			positions = RandomVector<Vec3>(NODES, 1);
+			rotations = RandomVector<Quaternion>(NODES, 2);
+			scales = RandomVector<Vec3>(NODES, 3);
+			locals.resize(NODES);
+			worlds.resize(NODES);
+		}
+
+		void UpdateLocals()
+		{
+			for (size_t i = 0; i < NODES; ++i)
+			{
+				locals[i] = Translate(positions[i]) * rotations[i].ToMatrix4() * Scale(scales[i] * 0.1f + Vec3(1, 1, 1));
+			}
+		}
+
+		void UpdateWorlds()
+		{
+			worlds[0] = locals[0];
+			for (size_t i = 1; i < NODES; ++i)
+			{
+				worlds[i] = worlds[parents[i]] * locals[i];
+			}
+		}
+	};
+
+	void Define(Suite& s)
+	{
+		static Scene scene;
+		scene.UpdateLocals();
+
+		s.AddBatch("HierarchyWorld/10k", NODES, [] { scene.UpdateWorlds(); DoNotOptimize(scene.worlds.back()); });
+		s.AddBatch("HierarchyTRS/10k", NODES, [] { scene.UpdateLocals(); scene.UpdateWorlds(); DoNotOptimize(scene.worlds.back()); });
+
+		static TransformHierarchy hierarchy = MakeHierarchy();
+		static const std::vector<Vec3> moves = RandomVector<Vec3>(GRAPH_NODES, 10);
+
+		s.AddBatch("TransformHierarchy/100k/Full", GRAPH_NODES, []
+		{
+			for (uint32 i = 0; i < GRAPH_NODES; ++i)
+			{
+				hierarchy.SetPosition(i, moves[i]);
+			}
+			DoNotOptimize(hierarchy.Update());
+		});
+		// 1% of the nodes move, taken from the later half whose subtrees are small, as
+		// animated objects under a mostly static scene.
+		s.AddBatch("TransformHierarchy/100k/Moved1%", GRAPH_NODES, []
+		{
+			for (uint32 i = 0; i < GRAPH_MOVED; ++i)
+			{
+				uint32 node = GRAPH_NODES / 2 + (i * 7919u) % (GRAPH_NODES / 2);
+				hierarchy.SetPosition(node, moves[node]);
+			}
+			DoNotOptimize(hierarchy.Update());
+		});
+		// 1% of the nodes picked uniformly: the moved subtrees cover about ten times more nodes.
+		static const std::vector<uint32> uniformMoves = []
+		{
+			std::vector<uint32> nodes(GRAPH_NODES);
+			std::iota(nodes.begin(), nodes.end(), 0u);
+			std::shuffle(nodes.begin(), nodes.end(), std::mt19937(44));
+			nodes.resize(GRAPH_MOVED);
+			return nodes;
+		}();
+		s.AddBatch("TransformHierarchy/100k/Moved1%/Uniform", GRAPH_NODES, []
+		{
+			for (uint32 node : uniformMoves)
+			{
+				hierarchy.SetPosition(node, moves[node]);
+			}
+			DoNotOptimize(hierarchy.Update());
+		});
+
+		static const std::vector<Mat4> bones = []
+		{
+			std::vector<Vec3> translations = RandomVector<Vec3>(SKIN_BONES, 11);
+			std::vector<Quaternion> rotations = RandomVector<Quaternion>(SKIN_BONES, 12);
+			std::vector<Mat4> m(SKIN_BONES);
+			for (size_t i = 0; i < SKIN_BONES; ++i) m[i] = Translate(translations[i]) * rotations[i].ToMatrix4();
+			return m;
+		}();
+		static const std::vector<Vec3> skinPositions = RandomVector<Vec3>(SKIN_VERTICES, 13);
+		static const std::vector<Vec3> skinNormals = [] { std::vector<Vec3> n = RandomVector<Vec3>(SKIN_VERTICES, 14); for (Vec3& v : n) v = v.Normalize(); return n; }();
+		static const std::vector<uint32> boneIndices = [] { std::mt19937 rng(15); std::vector<uint32> b(SKIN_VERTICES * SKIN_INFLUENCES); for (uint32& i : b) i = rng() % SKIN_BONES; return b; }();
+		static const std::vector<float32> boneWeights = []
+		{
+			std::vector<float32> w(SKIN_VERTICES * SKIN_INFLUENCES);
+			for (size_t v = 0; v < SKIN_VERTICES; ++v)
+			{
+				w[v * 4 + 0] = 0.5f; w[v * 4 + 1] = 0.25f; w[v * 4 + 2] = 0.15f; w[v * 4 + 3] = 0.1f;
+			}
+			return w;
+		}();
+		static const Vec3Stream positionStream(skinPositions);
+		static const Vec3Stream normalStream(skinNormals);
+		static Vec3Stream skinnedPositions(SKIN_VERTICES);
+		static Vec3Stream skinnedNormals(SKIN_VERTICES);
+		static const SkinInfluences influences{ boneIndices, boneWeights, SKIN_INFLUENCES };
+
+		s.AddBatch("SkinLinear/50k", SKIN_VERTICES, [] { SkinLinear(bones, influences, positionStream, normalStream, skinnedPositions, skinnedNormals); DoNotOptimize(skinnedPositions.Data(0)[0]); });
+		s.AddBatch("SkinLinear/50k/Loop", SKIN_VERTICES, []
+		{
+			for (size_t v = 0; v < SKIN_VERTICES; ++v)
+			{
+				Vec4 p, n;
+				for (size_t k = 0; k < SKIN_INFLUENCES; ++k)
+				{
+					const Mat4& bone = bones[boneIndices[v * 4 + k]];
+					float32 w = boneWeights[v * 4 + k];
+					p = p + bone * Vec4(skinPositions[v][0], skinPositions[v][1], skinPositions[v][2], 1.0f) * w;
+					n = n + bone * Vec4(skinNormals[v][0], skinNormals[v][1], skinNormals[v][2], 0.0f) * w;
+				}
+				skinnedPositions.Set(v, Vec3(p[0], p[1], p[2]));
+				skinnedNormals.Set(v, Vec3(n[0], n[1], n[2]).Normalize());
+			}
+			DoNotOptimize(skinnedPositions.Data(0)[0]);
+		});
+		s.AddBatch("SkinDualQuaternion/50k", SKIN_VERTICES, [] { SkinDualQuaternion(bones, influences, positionStream, normalStream, skinnedPositions, skinnedNormals); DoNotOptimize(skinnedPositions.Data(0)[0]); });
+
+		// Objects spread over a 200 m square around a camera that sees about a tenth of them.
+		static const Frustum frustum = Frustum::FromViewProj(Perspective(1.2f, 16.0f / 9.0f, 0.1f, 150.0f) * LookAt(Vec3(0, 2, 0), Vec3(1, 2, 1), Vec3Up()));
+		static const std::vector<Vec3> centers = [] { std::vector<Vec3> c = RandomVector<Vec3>(CULL_OBJECTS, 16); for (Vec3& v : c) v = v * 100.0f; return c; }();
+		static const SphereStream cullSpheres = [] { SphereStream s(CULL_OBJECTS); for (size_t i = 0; i < CULL_OBJECTS; ++i) s.Set(i, Sphere(centers[i], 1.0f)); return s; }();
+		static const AABBStream cullBoxes = [] { AABBStream b(CULL_OBJECTS); for (size_t i = 0; i < CULL_OBJECTS; ++i) b.Set(i, AABB::FromCenterExtents(centers[i], Vec3(1, 1, 1))); return b; }();
+		static std::vector<uint64> visibleBits((CULL_OBJECTS + 63) / 64);
+		static std::vector<uint32> visibleIndices(CULL_OBJECTS);
+		static std::vector<uint8> lastPlane(CULL_OBJECTS, 0);
+		// Same objects ordered by direction around the camera, so that neighbours share a rejecting plane.
+		static const SphereStream sortedSpheres = []
+		{
+			std::vector<Sphere> sorted(CULL_OBJECTS);
+			for (size_t i = 0; i < CULL_OBJECTS; ++i) sorted[i] = Sphere(centers[i], 1.0f);
+			std::sort(sorted.begin(), sorted.end(), [](const Sphere& a, const Sphere& b) { return std::atan2(a.center[2], a.center[0]) < std::atan2(b.center[2], b.center[0]); });
+			return SphereStream(sorted);
+		}();
+		static std::vector<uint8> sortedLastPlane(CULL_OBJECTS, 0);
+
+		s.AddBatch("CullSpheres/100k", CULL_OBJECTS, [] { CullSpheres(frustum, cullSpheres, visibleBits); DoNotOptimize(visibleBits[0]); });
+		s.AddBatch("CullSpheres/100k/Indices", CULL_OBJECTS, [] { DoNotOptimize(CullSpheres(frustum, cullSpheres, visibleIndices)); });
+		s.AddBatch("CullSpheres/100k/Cached", CULL_OBJECTS, [] { DoNotOptimize(CullSpheres(frustum, cullSpheres, visibleIndices, lastPlane)); });
+		s.AddBatch("CullSpheres/100k/Sorted", CULL_OBJECTS, [] { DoNotOptimize(CullSpheres(frustum, sortedSpheres, visibleIndices)); });
+		s.AddBatch("CullSpheres/100k/Sorted/Cached", CULL_OBJECTS, [] { DoNotOptimize(CullSpheres(frustum, sortedSpheres, visibleIndices, sortedLastPlane)); });
+		s.AddBatch("CullSpheres/100k/Loop", CULL_OBJECTS, []
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < CULL_OBJECTS; ++i)
+			{
+				if (frustum.Intersects(cullSpheres.Get(i)))
+				{
+					visibleIndices[count++] = static_cast<uint32>(i);
+				}
+			}
+			DoNotOptimize(count);
+		});
+		s.AddBatch("CullBoxes/100k", CULL_OBJECTS, [] { CullBoxes(frustum, cullBoxes, visibleBits); DoNotOptimize(visibleBits[0]); });
+		s.AddBatch("CullBoxes/100k/Loop", CULL_OBJECTS, []
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < CULL_OBJECTS; ++i)
+			{
+				if (frustum.Intersects(cullBoxes.Get(i)))
+				{
+					visibleIndices[count++] = static_cast<uint32>(i);
+				}
+			}
+			DoNotOptimize(count);
+		});
+
+		static const std::vector<Triangle> level = MakeLevel();
+		static const Bvh levelBvh = [] { Bvh b; b.Build(std::span<const Triangle>(level)); return b; }();
+		static Bvh rebuiltBvh = levelBvh;
+		// Visibility rays between points 2 m above the terrain, and downward rays from above it.
+		static const std::vector<Ray> visibilityRays = []
+		{
+			std::vector<Vec3> ends = RandomVector<Vec3>(LEVEL_RAYS * 2, 17);
+			std::vector<Ray> rays(LEVEL_RAYS);
+			for (size_t i = 0; i < LEVEL_RAYS; ++i)
+			{
+				Vec3 from(ends[2 * i][0] * 250.0f, 6.0f, ends[2 * i][2] * 250.0f);
+				Vec3 to(ends[2 * i + 1][0] * 250.0f, 6.0f + ends[2 * i + 1][1] * 4.0f, ends[2 * i + 1][2] * 250.0f);
+				rays[i] = Ray(from, to - from);
+			}
+			return rays;
+		}();
+		static const std::vector<Ray> downRays = []
+		{
+			std::vector<Vec3> origins = RandomVector<Vec3>(LEVEL_RAYS, 18);
+			std::vector<Ray> rays(LEVEL_RAYS);
+			for (size_t i = 0; i < LEVEL_RAYS; ++i)
+			{
+				rays[i] = Ray(Vec3(origins[i][0] * 250.0f, 20.0f, origins[i][2] * 250.0f), Vec3(origins[i][1] * 0.3f, -1.0f, 0.2f).Normalize());
+			}
+			return rays;
+		}();
+		static std::vector<uint64> occluded((LEVEL_RAYS + 63) / 64);
+		static std::vector<BvhHit> levelHits(LEVEL_RAYS);
+
+		s.AddBatch("BvhBuild/131k", LEVEL_TRIANGLES, [] { rebuiltBvh.Build(std::span<const Triangle>(level)); DoNotOptimize(rebuiltBvh.Nodes()[0]); });
+		s.AddBatch("BvhRefit/131k", LEVEL_TRIANGLES, [] { rebuiltBvh.Refit(std::span<const Triangle>(level)); DoNotOptimize(rebuiltBvh.Nodes()[0]); });
+		s.AddBatch("BvhAnyHit/100k", LEVEL_RAYS, [] { levelBvh.AnyHit(visibilityRays, occluded, 1.0f); DoNotOptimize(occluded[0]); });
+		s.AddBatch("BvhClosestHit/100k", LEVEL_RAYS, [] { levelBvh.ClosestHit(downRays, levelHits); DoNotOptimize(levelHits[0]); });
+		s.AddBatch("BvhOverlap/10k", POSES, []
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < POSES; ++i)
+			{
+				levelBvh.Overlap(Sphere(downRays[i].At(18.0f), 1.0f), [&](uint32) { ++count; });
+			}
+			DoNotOptimize(count);
+		});
+
+		// Crowd on a 400 m square, 2 m deep: about 7 neighbours within CROWD_RADIUS per agent.
+		static const std::vector<Vec3> crowd = [] { std::vector<Vec3> c = RandomVector<Vec3>(CROWD, 19); for (Vec3& v : c) v = Vec3(v[0] * 200.0f, v[1], v[2] * 200.0f); return c; }();
+		static SpatialHashGrid grid = [] { SpatialHashGrid g; g.Build(crowd, CROWD_RADIUS); return g; }();
+		static SpatialHashGrid rebuiltGrid;
+		static std::vector<uint32> neighborOffsets;
+		static std::vector<uint32> neighbors;
+
+		s.AddBatch("SpatialHashBuild/100k", CROWD, [] { rebuiltGrid.Build(crowd, CROWD_RADIUS); DoNotOptimize(rebuiltGrid.Indices()[0]); });
+		s.AddBatch("SpatialHashQuery/100k", CROWD, [] { grid.Query(crowd, CROWD_RADIUS, neighborOffsets, neighbors); DoNotOptimize(neighbors[0]); });
+		s.AddBatch("SpatialHashQuery/100k/Sorted", CROWD, [] { grid.Query(grid.Points(), CROWD_RADIUS, neighborOffsets, neighbors); DoNotOptimize(neighbors[0]); });
+		s.AddBatch("SpatialHashQuery/1k/BruteForce", CROWD_BRUTE_FORCE, []
+		{
+			neighbors.clear();
+			for (size_t i = 0; i < CROWD_BRUTE_FORCE; ++i)
+			{
+				for (size_t j = 0; j < CROWD; ++j)
+				{
+					if (DistanceSquared(crowd[i], crowd[j]) <= CROWD_RADIUS * CROWD_RADIUS)
+					{
+						neighbors.push_back(static_cast<uint32>(j));
+					}
+				}
+			}
+			DoNotOptimize(neighbors[0]);
+		});
+
+		// 1M points in the unit cube scaled to 100 m, queries drawn from the same distribution.
+		static const std::vector<Vec3> cloud = [] { std::vector<Vec3> c = RandomVector<Vec3>(CLOUD, 20); for (Vec3& v : c) v = v * 100.0f; return c; }();
+		static const std::vector<Vec3> cloudQueries = [] { std::vector<Vec3> c = RandomVector<Vec3>(CLOUD_QUERIES, 21); for (Vec3& v : c) v = v * 100.0f; return c; }();
+		static const KdTree<3> cloudTree = [] { KdTree<3> t; t.Build(cloud); return t; }();
+		static KdTree<3> rebuiltTree;
+		static std::vector<KdTree<3>::Neighbor> cloudNearest(CLOUD_QUERIES * CLOUD_K);
+		static std::vector<uint32> cloudOffsets;
+		static std::vector<KdTree<3>::Neighbor> cloudNeighbors;
+
+		s.AddBatch("KdTreeBuild/1M", CLOUD, [] { rebuiltTree.Build(cloud); DoNotOptimize(rebuiltTree.Size()); });
+		s.AddBatch("KdTreeNearest8/1M", CLOUD_QUERIES, [] { cloudTree.Nearest(cloudQueries, CLOUD_K, cloudNearest); DoNotOptimize(cloudNearest[0]); });
+		s.AddBatch("KdTreeNearest8/1M/Approximate", CLOUD_QUERIES, [] { cloudTree.Nearest(cloudQueries, CLOUD_K, cloudNearest, 0.5f); DoNotOptimize(cloudNearest[0]); });
+		s.AddBatch("KdTreeRadius/1M", CLOUD_QUERIES, [] { cloudTree.Radius(cloudQueries, 2.0f, cloudOffsets, cloudNeighbors); DoNotOptimize(cloudOffsets.back()); });
+		s.AddBatch("KdTreeNearest8/1M/BruteForce", CLOUD_BRUTE_FORCE, []
+		{
+			for (size_t q = 0; q < CLOUD_BRUTE_FORCE; ++q)
+			{
+				std::array<KdTree<3>::Neighbor, CLOUD_K> nearest;
+				for (uint32 i = 0; i < CLOUD; ++i)
+				{
+					const float32 distanceSquared = DistanceSquared(cloudQueries[q], cloud[i]);
+					if (distanceSquared < nearest.back().distanceSquared)
+					{
+						nearest.back() = { i, distanceSquared };
+						std::sort(nearest.begin(), nearest.end());
+					}
+				}
+				DoNotOptimize(nearest[0]);
+			}
+		});
+
+		static const std::vector<Vec3> points = RandomVector<Vec3>(POINTS, 4);
+		static std::vector<Vec3> out(POINTS);
+		static const Mat4 model = Translate(Vec3(1, 2, 3)) * RotateAxis(Vec3(0, 0.6f, 0.8f), 0.7f) * Scale(Vec3(2, 2, 2));
+		static const Quaternion rotation = Quaternion::FromAxisAngle(Vec3(0, 0.6f, 0.8f), 0.7f);
+
+		s.AddBatch("TransformPoints/1M", POINTS, [] { TransformPoints(model, points, out); DoNotOptimize(out[0]); });
+		s.AddBatch("TransformPoints/1M/Loop", POINTS, []
+		{
+			for (size_t i = 0; i < POINTS; ++i)
+			{
+				Vec4 p = model * Vec4(points[i][0], points[i][1], points[i][2], 1.0f);
+				out[i] = Vec3(p[0], p[1], p[2]);
+			}
+			DoNotOptimize(out[0]);
+		});
+		s.AddBatch("RotatePoints/1M", POINTS, [] { Rotate(rotation, points, out); DoNotOptimize(out[0]); });
+		s.AddBatch("RotatePoints/1M/Loop", POINTS, []
+		{
+			for (size_t i = 0; i < POINTS; ++i)
+			{
+				out[i] = rotation * points[i];
+			}
+			DoNotOptimize(out[0]);
+		});
+
+		static const std::vector<Quaternion> from = RandomVector<Quaternion>(POSES, 5);
+		static const std::vector<Quaternion> to = RandomVector<Quaternion>(POSES, 6);
+		static std::vector<Quaternion> blended(POSES);
+
+		s.AddBatch("BlendPoses/10k", POSES, [] { BlendPoses(from, to, 0.3f, blended); DoNotOptimize(blended[0]); });
+		s.AddBatch("BlendPoses/10k/Exact", POSES, [] { BlendPoses(from, to, 0.3f, blended, SlerpPrecision::Exact); DoNotOptimize(blended[0]); });
+		s.AddBatch("NlerpPoses/10k", POSES, [] { NlerpPoses(from, to, 0.3f, blended); DoNotOptimize(blended[0]); });
+
+		static const QuaternionStream rotations(from);
+		static const Vec3Stream angles(RandomVector<Vec3>(POSES, 7));
+		static const Mat3Stream matrices = [] { Mat3Stream m; ToMatrix3(rotations, m); return m; }();
+		static QuaternionStream rotationsOut(POSES);
+		static Vec3Stream anglesOut(POSES);
+		static Mat3Stream matricesOut(POSES);
+		static Mat4Stream matrices4Out(POSES);
+
+		s.AddBatch("FromEuler/10k", POSES, [] { FromEuler(angles, rotationsOut); DoNotOptimize(rotationsOut.Data(0)[0]); });
+		s.AddBatch("FromEuler/10k/Loop", POSES, []
+		{
+			for (size_t i = 0; i < POSES; ++i)
+			{
+				Vec3 e = angles.Get(i);
+				rotationsOut.Set(i, Quaternion::FromEuler(e[0], e[1], e[2]));
+			}
+			DoNotOptimize(rotationsOut.Data(0)[0]);
+		});
+		s.AddBatch("ToEuler/10k", POSES, [] { ToEuler(rotations, anglesOut); DoNotOptimize(anglesOut.Data(0)[0]); });
+		s.AddBatch("ToEuler/10k/Loop", POSES, []
+		{
+			for (size_t i = 0; i < POSES; ++i)
+			{
+				anglesOut.Set(i, rotations.Get(i).ToEuler());
+			}
+			DoNotOptimize(anglesOut.Data(0)[0]);
+		});
+		s.AddBatch("FromRotationMatrix/10k", POSES, [] { FromRotationMatrix(matrices, rotationsOut); DoNotOptimize(rotationsOut.Data(0)[0]); });
+		s.AddBatch("FromRotationMatrix/10k/Loop", POSES, []
+		{
+			for (size_t i = 0; i < POSES; ++i)
+			{
+				rotationsOut.Set(i, Quaternion::FromRotationMatrix(matrices.Get(i)));
+			}
+			DoNotOptimize(rotationsOut.Data(0)[0]);
+		});
+		s.AddBatch("ToMatrix3/10k", POSES, [] { ToMatrix3(rotations, matricesOut); DoNotOptimize(matricesOut.Data(0)[0]); });
+		s.AddBatch("ToMatrix4/10k", POSES, [] { ToMatrix4(rotations, matrices4Out); DoNotOptimize(matrices4Out.Data(0)[0]); });
+	}
+
+	const Suite MACRO("macro", Define);
+}
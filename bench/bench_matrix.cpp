@@ -0,0 +1,105 @@
+#include "bench.hpp"
+
+#include <memory>
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	template<size_t N>
+	void MatrixCases(Suite& s, const std::string& type)
+	{
+		using M = Matrix<N, N, float32>;
+		using V = Vec<N, float32>;
+
+		const M* a = Pool<M>(0).data();
+		const M* b = Pool<M>(1).data();
+		const V* v = Pool<V>(0).data();
+		const float32* f = Pool<float32>(0).data();
+
+		// OPERATORS
+		s.Add(type + "/operator*", [=](size_t i) { return a[i] * b[i]; });
+		s.Add(type + "/operator*(vec)", [=](size_t i) { return a[i] * v[i]; });
+		s.Add(type + "/operator*(scalar)", [=](size_t i) { return a[i] * f[i]; });
+		s.Add(type + "/operator+(scalar)", [=](size_t i) { return a[i] + f[i]; });
+		s.Add(type + "/operator-(scalar)", [=](size_t i) { return a[i] - f[i]; });
+		s.Add(type + "/operator*(scalar,mat)", [=](size_t i) { return f[i] * a[i]; });
+		s.Add(type + "/operator+(scalar,mat)", [=](size_t i) { return f[i] + a[i]; });
+		s.Add(type + "/operator-(scalar,mat)", [=](size_t i) { return f[i] - a[i]; });
+
+		// ACCESS
+		s.Add(type + "/GetColumn", [=](size_t i) { return a[i].GetColumn(i % N); });
+		s.Add(type + "/GetRow", [=](size_t i) { return a[i].GetRow(i % N); });
+		s.Add(type + "/SetColumn", [=](size_t i) { M m = a[i]; m.SetColumn(i % N, v[i]); return m; });
+		s.Add(type + "/SetRow", [=](size_t i) { M m = a[i]; m.SetRow(i % N, v[i]); return m; });
+
+		// FREE FUNCTIONS
+		s.Add(type + "/Zero", [=](size_t) { return Zero<M>(); });
+		s.Add(type + "/Identity", [=](size_t) { return Identity<M>(); });
+		s.Add(type + "/Transpose", [=](size_t i) { return Transpose(a[i]); });
+		s.Add(type + "/Determinant", [=](size_t i) { return Determinant(a[i]); });
+		s.Add(type + "/Minor", [=](size_t i) { return Minor(a[i], i % N, (i / N) % N); });
+		s.Add(type + "/Inverse", [=](size_t i) { return Inverse(a[i]); });
+		s.Add(type + "/InverseDeterminant", [=](size_t i) { M r; float32 det = InverseDeterminant(a[i], r); DoNotOptimize(r); return det; });
+		s.Add(type + "/TryInverse", [=](size_t i) { M r; bool ok = TryInverse(a[i], r); DoNotOptimize(r); return ok; });
+		s.Add(type + "/DecomposeLU", [=](size_t i) { return DecomposeLU(a[i]); });
+		s.Add(type + "/LU::Solve", [=](size_t i) { return DecomposeLU(a[i]).Solve(v[i]); });
+	}
+
+	DynMatrix<float32> RandomDynMatrix(size_t rows, size_t cols, uint32_t seed)
+	{
+		std::vector<float32> values = RandomVector<float32>(rows * cols, seed);
+		DynMatrix<float32> m(rows, cols);
+		std::copy(values.begin(), values.end(), m.Data());
+		return m;
+	}
+
+	// Items are multiply-adds, n^3 per product.
+	void GemmCases(Suite& s, size_t n)
+	{
+		const std::string size = std::to_string(n);
+		auto a = std::make_shared<DynMatrix<float32>>(RandomDynMatrix(n, n, 30));
+		auto b = std::make_shared<DynMatrix<float32>>(RandomDynMatrix(n, n, 31));
+		auto c = std::make_shared<DynMatrix<float32>>(n, n);
+
+		s.AddBatch("DynMatrix/Gemm/" + size, n * n * n, [=] { Gemm<float32>(*a, *b, *c); DoNotOptimize((*c)(0, 0)); });
+		if (n <= 512)
+		{
+			s.AddBatch("DynMatrix/Gemm/" + size + "/Loop", n * n * n, [=]
+			{
+				for (size_t j = 0; j < n; ++j)
+				{
+					for (size_t i = 0; i < n; ++i)
+					{
+						float32 sum = 0.0f;
+						for (size_t k = 0; k < n; ++k)
+						{
+							sum += (*a)(i, k) * (*b)(k, j);
+						}
+						(*c)(i, j) = sum;
+					}
+				}
+				DoNotOptimize((*c)(0, 0));
+			});
+		}
+	}
+
+	void Define(Suite& s)
+	{
+		MatrixCases<2>(s, "Mat2");
+		MatrixCases<3>(s, "Mat3");
+		MatrixCases<4>(s, "Mat4");
+
+		GemmCases(s, 128);
+		GemmCases(s, 512);
+		GemmCases(s, 2000);
+
+		static const DynMatrix<float32> system = RandomDynMatrix(2000, 2000, 32);
+		static const std::vector<float32> x = RandomVector<float32>(2000, 33);
+		static std::vector<float32> y(2000);
+		s.AddBatch("DynMatrix/Gemv/2000", 2000 * 2000, [] { Gemv<float32>(system, x, y); DoNotOptimize(y[0]); });
+	}
+
+	const Suite MATRIX("matrix", Define);
+}
@@ -0,0 +1,64 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	void Define(Suite& s)
+	{
+		const Quaternion* a = Pool<Quaternion>(0).data();
+		const Quaternion* b = Pool<Quaternion>(1).data();
+		const Vec3* v = Pool<Vec3>(0).data();
+		const Vec3* w = Pool<Vec3>(1).data();
+		const float32* f = Pool<float32>(0).data();
+		const float32* t = Pool<float32>(1).data();
+
+		static const std::vector<Mat4> rotations = [&]
+		{
+			std::vector<Mat4> m(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) m[i] = a[i].ToMatrix4();
+			return m;
+		}();
+		const Mat4* r = rotations.data();
+
+		// CONSTRUCTION
+		s.Add("FromAxisAngle", [=](size_t i) { return Quaternion::FromAxisAngle(v[i].Normalize(), f[i]); });
+		s.Add("FromEuler", [=](size_t i) { return Quaternion::FromEuler(v[i][0], v[i][1], v[i][2]); });
+		s.Add("FromRotationMatrix(Mat3)", [=](size_t i) { return Quaternion::FromRotationMatrix(a[i].ToMatrix3()); });
+		s.Add("FromRotationMatrix(Mat4)", [=](size_t i) { return Quaternion::FromRotationMatrix(r[i]); });
+		s.Add("RotationBetween", [=](size_t i) { return RotationBetween(v[i].Normalize(), w[i].Normalize()); });
+		s.Add("LookRotation", [=](size_t i) { return LookRotation(v[i].Normalize()); });
+
+		// OPERATORS
+		s.Add("operator*", [=](size_t i) { return a[i] * b[i]; });
+		s.Add("operator*(Vec3)", [=](size_t i) { return a[i] * v[i]; });
+		s.Add("operator+", [=](size_t i) { return a[i] + b[i]; });
+		s.Add("operator*(scalar)", [=](size_t i) { return a[i] * f[i]; });
+		s.Add("operator*(scalar,quat)", [=](size_t i) { return f[i] * a[i]; });
+
+		// MEMBERS
+		s.Add("Conjugate", [=](size_t i) { return a[i].Conjugate(); });
+		s.Add("Inverse", [=](size_t i) { return a[i].Inverse(); });
+		s.Add("Length", [=](size_t i) { return a[i].Length(); });
+		s.Add("LengthSquared", [=](size_t i) { return a[i].LengthSquared(); });
+		s.Add("Normalize", [=](size_t i) { return a[i].Normalize(); });
+		s.Add("InvLength", [=](size_t i) { return a[i].InvLength(); });
+		s.Add("NormalizeFast", [=](size_t i) { return a[i].NormalizeFast(); });
+		s.Add("NormalizeSafe", [=](size_t i) { return a[i].NormalizeSafe(); });
+		s.Add("ToMatrix3", [=](size_t i) { return a[i].ToMatrix3(); });
+		s.Add("ToMatrix4", [=](size_t i) { return a[i].ToMatrix4(); });
+		s.Add("ToEuler", [=](size_t i) { return a[i].ToEuler(); });
+		s.Add("NearlyEquals", [=](size_t i) { return a[i].NearlyEquals(b[i]); });
+
+		// FREE FUNCTIONS
+		s.Add("Dot", [=](size_t i) { return Dot(a[i], b[i]); });
+		s.Add("Nlerp", [=](size_t i) { return Nlerp(a[i], b[i], t[i] * 0.5f + 0.5f); });
+		s.Add("Slerp", [=](size_t i) { return Slerp(a[i], b[i], t[i] * 0.5f + 0.5f); });
+		s.Add("Slerp(Accurate)", [=](size_t i) { return Slerp(a[i], b[i], t[i] * 0.5f + 0.5f, SlerpPrecision::Accurate); });
+		s.Add("Slerp(Fast)", [=](size_t i) { return Slerp(a[i], b[i], t[i] * 0.5f + 0.5f, SlerpPrecision::Fast); });
+		s.Add("AngleBetween", [=](size_t i) { return AngleBetween(a[i], b[i]); });
+	}
+
+	const Suite QUATERNION("quaternion", Define);
+}
@@ -0,0 +1,79 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	void Define(Suite& s)
+	{
+		const Vec3* a = Pool<Vec3>(0).data();
+		const Vec3* b = Pool<Vec3>(1).data();
+		const Vec3* c = Pool<Vec3>(2).data();
+		const float32* f = Pool<float32>(0).data();
+		const Quaternion* q = Pool<Quaternion>(0).data();
+
+		static const std::vector<Mat4> models = [&]
+		{
+			std::vector<Mat4> m(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) m[i] = Translate(a[i]) * q[i].ToMatrix4() * Scale(b[i] * 0.5f + Vec3(1, 1, 1));
+			return m;
+		}();
+		const Mat4* m = models.data();
+
+		static const std::vector<Transform> transforms = [&]
+		{
+			std::vector<Transform> t(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i) t[i] = Transform(a[i], q[i], Vec3(1, 1, 1) + b[i] * 0.5f);
+			return t;
+		}();
+		const Transform* t = transforms.data();
+
+		// CONSTRUCTION
+		s.Add("Translate", [=](size_t i) { return Translate(a[i]); });
+		s.Add("Scale", [=](size_t i) { return Scale(a[i]); });
+		s.Add("RotateX", [=](size_t i) { return RotateX(f[i]); });
+		s.Add("RotateY", [=](size_t i) { return RotateY(f[i]); });
+		s.Add("RotateZ", [=](size_t i) { return RotateZ(f[i]); });
+		s.Add("Rotate", [=](size_t i) { return Rotate(a[i][0], a[i][1], a[i][2]); });
+		s.Add("RotateAxis", [=](size_t i) { return RotateAxis(a[i].Normalize(), f[i]); });
+		s.Add("TransformMatrix", [=](size_t i) { return TransformMatrix(a[i], b[i], c[i]); });
+		s.Add("FromBasis", [=](size_t i) { return FromBasis(a[i], b[i], c[i], a[i]); });
+
+		// CAMERA
+		s.Add("LookAt", [=](size_t i) { return LookAt(a[i] * 10.0f, b[i], Vec3Up()); });
+		s.Add("InverseLookAt", [=](size_t i) { return InverseLookAt(a[i] * 10.0f, b[i], Vec3Up()); });
+		s.Add("Perspective", [=](size_t i) { return Perspective(1.0f + f[i] * 0.5f, 16.0f / 9.0f, 0.1f, 100.0f); });
+		s.Add("Ortho", [=](size_t i) { return Ortho(-1.0f - f[i], 1.0f, -1.0f, 1.0f, 0.1f, 100.0f); });
+
+		// DECOMPOSITION
+		s.Add("DecomposeTransform", [=](size_t i) { Vec3 p, r, sc; DecomposeTransform(m[i], p, r, sc); DoNotOptimize(r); DoNotOptimize(sc); return p; });
+		s.Add("ExtractRight", [=](size_t i) { return ExtractRight(m[i]); });
+		s.Add("ExtractUp", [=](size_t i) { return ExtractUp(m[i]); });
+		s.Add("ExtractForward", [=](size_t i) { return ExtractForward(m[i]); });
+		s.Add("ExtractPosition", [=](size_t i) { return ExtractPosition(m[i]); });
+		s.Add("ExtractScale", [=](size_t i) { return ExtractScale(m[i]); });
+		s.Add("InverseAffine", [=](size_t i) { return InverseAffine(m[i]); });
+		s.Add("InverseRigid", [=](size_t i) { return InverseRigid(m[i]); });
+
+		// TRS TRANSFORM, against the Mat4 equivalents
+		s.Add("Transform::ToMatrix4", [=](size_t i) { return t[i].ToMatrix4(); });
+		s.Add("Transform::ToMatrix4(Mat4 products)", [=](size_t i) { return Translate(t[i].position) * t[i].rotation.ToMatrix4() * Scale(t[i].scale); });
+		s.Add("Transform::FromMatrix", [=](size_t i) { return Transform::FromMatrix(m[i]); });
+		s.Add("Compose", [=](size_t i) { return Compose(t[i], t[(i + 1) & (POOL_SIZE - 1)]); });
+		s.Add("Compose(Mat4)", [=](size_t i) { return m[i] * m[(i + 1) & (POOL_SIZE - 1)]; });
+		s.Add("Transform::Inverse", [=](size_t i) { return t[i].Inverse(); });
+		s.Add("Transform::TransformPoint", [=](size_t i) { return t[i].TransformPoint(c[i]); });
+		s.Add("Transform::InverseTransformPoint", [=](size_t i) { return t[i].InverseTransformPoint(c[i]); });
+		s.Add("Lerp(Transform)", [=](size_t i) { return Lerp(t[i], t[(i + 1) & (POOL_SIZE - 1)], f[i] * 0.5f + 0.5f); });
+
+		// BATCHED
+		static std::vector<Vec3> out(POOL_SIZE);
+		std::span<const Vec3> points(a, POOL_SIZE);
+		s.AddBatch("TransformPoints", POOL_SIZE, [=] { TransformPoints(m[0], points, out); DoNotOptimize(out[0]); });
+		s.AddBatch("TransformDirections", POOL_SIZE, [=] { TransformDirections(m[0], points, out); DoNotOptimize(out[0]); });
+		s.AddBatch("TransformPointsProjective", POOL_SIZE, [=] { TransformPointsProjective(Perspective(1.0f, 1.5f, 0.1f, 100.0f) * m[0], points, out); DoNotOptimize(out[0]); });
+	}
+
+	const Suite TRANSFORM("transform", Define);
+}
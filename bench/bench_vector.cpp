@@ -0,0 +1,82 @@
+#include "bench.hpp"
+
+using namespace math;
+using namespace math::bench;
+
+namespace
+{
+	template<size_t N>
+	void VectorCases(Suite& s, const std::string& type)
+	{
+		using V = Vec<N, float32>;
+
+		const V* a = Pool<V>(0).data();
+		const V* b = Pool<V>(1).data();
+		const V* c = Pool<V>(2).data();
+		const float32* f = Pool<float32>(0).data();
+
+		// Divisors kept away from zero.
+		static const std::vector<V> divisors = [&]
+		{
+			std::vector<V> d(POOL_SIZE);
+			for (size_t i = 0; i < POOL_SIZE; ++i)
+			{
+				for (size_t k = 0; k < N; ++k) d[i][k] = 1.5f + b[i][k] * 0.5f;
+			}
+			return d;
+		}();
+		const V* d = divisors.data();
+
+		// OPERATORS
+		s.Add(type + "/operator+", [=](size_t i) { return a[i] + b[i]; });
+		s.Add(type + "/operator-", [=](size_t i) { return a[i] - b[i]; });
+		s.Add(type + "/operator-(unary)", [=](size_t i) { return -a[i]; });
+		s.Add(type + "/operator*", [=](size_t i) { return a[i] * b[i]; });
+		s.Add(type + "/operator*(scalar)", [=](size_t i) { return a[i] * f[i]; });
+		s.Add(type + "/operator*(scalar,vec)", [=](size_t i) { return f[i] * a[i]; });
+		s.Add(type + "/operator/", [=](size_t i) { return a[i] / d[i]; });
+		s.Add(type + "/operator+=", [=](size_t i) { V v = a[i]; v += b[i]; return v; });
+		s.Add(type + "/operator-=", [=](size_t i) { V v = a[i]; v -= b[i]; return v; });
+		s.Add(type + "/operator*=", [=](size_t i) { V v = a[i]; v *= b[i]; return v; });
+		s.Add(type + "/operator/=", [=](size_t i) { V v = a[i]; v /= d[i]; return v; });
+		s.Add(type + "/operator==", [=](size_t i) { return a[i] == b[i]; });
+		s.Add(type + "/NearlyEquals", [=](size_t i) { return a[i].NearlyEquals(b[i]); });
+
+		// MEMBERS
+		s.Add(type + "/Length", [=](size_t i) { return a[i].Length(); });
+		s.Add(type + "/LengthSquared", [=](size_t i) { return a[i].LengthSquared(); });
+		s.Add(type + "/Normalize", [=](size_t i) { return a[i].Normalize(); });
+		s.Add(type + "/InvLength", [=](size_t i) { return a[i].InvLength(); });
+		s.Add(type + "/NormalizeFast", [=](size_t i) { return a[i].NormalizeFast(); });
+		s.Add(type + "/NormalizeFast(Fast)", [=](size_t i) { return a[i].NormalizeFast(SqrtPrecision::Fast); });
+		s.Add(type + "/NormalizeSafe", [=](size_t i) { return a[i].NormalizeSafe(); });
+
+		// FREE FUNCTIONS
+		s.Add(type + "/Dot", [=](size_t i) { return Dot(a[i], b[i]); });
+		s.Add(type + "/Distance", [=](size_t i) { return Distance(a[i], b[i]); });
+		s.Add(type + "/DistanceSquared", [=](size_t i) { return DistanceSquared(a[i], b[i]); });
+		s.Add(type + "/Reflect", [=](size_t i) { return Reflect(a[i], b[i]); });
+		s.Add(type + "/Refract", [=](size_t i) { return Refract(a[i], b[i], 1.0f, 1.33f); });
+		s.Add(type + "/Lerp", [=](size_t i) { return Lerp(a[i], b[i], f[i]); });
+		s.Add(type + "/Project", [=](size_t i) { return Project(a[i], b[i]); });
+		s.Add(type + "/Angle", [=](size_t i) { return Angle(a[i], b[i]); });
+		s.Add(type + "/Min", [=](size_t i) { return Min(a[i], b[i]); });
+		s.Add(type + "/Max", [=](size_t i) { return Max(a[i], b[i]); });
+		s.Add(type + "/Clamp", [=](size_t i) { return Clamp(a[i], Min(b[i], c[i]), Max(b[i], c[i])); });
+		s.Add(type + "/Abs", [=](size_t i) { return Abs(a[i]); });
+
+		if constexpr (N == 3)
+		{
+			s.Add(type + "/Cross", [=](size_t i) { return Cross(a[i], b[i]); });
+		}
+	}
+
+	void Define(Suite& s)
+	{
+		VectorCases<2>(s, "Vec2");
+		VectorCases<3>(s, "Vec3");
+		VectorCases<4>(s, "Vec4");
+	}
+
+	const Suite VECTOR("vector", Define);
+}
@@ -0,0 +1,313 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace math;
+using namespace math::bench;
+
+// Usage: mathlib_bench [--filter TEXT] [--list] [--min-time SECONDS] [--repetitions N]
+//                      [--json FILE] [--baseline FILE] [--threshold PERCENT]
+//                      [--isa scalar|sse2|avx2|avx512]
+// Exits with 1 when --baseline is given and a benchmark is slower than baseline by more than the threshold.
+// --isa overrides MATHLIB_ISA, the batched kernels run at that level or the best one below it.
+
+namespace math::bench
+{
+	void UseCharPointer(const volatile char*) {}
+
+	std::vector<Case>& Registry()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+}
+
+namespace
+{
+	struct Options
+	{
+		std::string filter;
+		std::string jsonPath;
+		std::string baselinePath;
+		std::string isa;
+		float64 threshold = 10.0;
+		float64 minTime = 0.25;
+		size_t repetitions = 5;
+		bool list = false;
+	};
+
+	struct Result
+	{
+		std::string name;
+		size_t items = 1;
+		size_t iterations = 0;
+		float64 nsPerOp = 0.0;
+		float64 minNsPerOp = 0.0;
+
+		float64 ItemsPerSecond() const { return items * 1e9 / nsPerOp; }
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	float64 Seconds(const Case& c, size_t iterations)
+	{
+		auto start = Clock::now();
+		c.run(iterations);
+		return std::chrono::duration<float64>(Clock::now() - start).count();
+	}
+
+	Result Measure(const Case& c, const Options& options)
+	{
+		const float64 target = options.minTime / options.repetitions;
+
+		// Grow the batch until it is long enough to time, then scale it to the target.
+		size_t iterations = 1;
+		float64 elapsed = Seconds(c, iterations);
+		while (elapsed < target * 0.1 && iterations < (size_t(1) << 40))
+		{
+			iterations *= 10;
+			elapsed = Seconds(c, iterations);
+		}
+		iterations = Max<size_t>(1, static_cast<size_t>(iterations * target / Max(elapsed, 1e-9)));
+
+		std::vector<float64> samples(options.repetitions);
+		for (float64& sample : samples)
+		{
+			sample = Seconds(c, iterations) * 1e9 / iterations;
+		}
+		std::sort(samples.begin(), samples.end());
+
+		Result result;
+		result.name = c.name;
+		result.items = c.items;
+		result.iterations = iterations;
+		result.nsPerOp = samples[samples.size() / 2];
+		result.minNsPerOp = samples.front();
+		return result;
+	}
+
+	// CONTEXT
+
+	const char* SimdName()
+	{
+#if MATHLIB_AVX2 && MATHLIB_FMA
+		return "AVX2+FMA";
+#elif MATHLIB_AVX2
+		return "AVX2";
+#elif MATHLIB_SSE41
+		return "SSE4.1";
+#elif MATHLIB_SSE2
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+
+	std::string CompilerName()
+	{
+		std::ostringstream out;
+#if defined(__clang__)
+		out << "clang " << __clang_major__ << "." << __clang_minor__;
+#elif defined(__GNUC__)
+		out << "gcc " << __GNUC__ << "." << __GNUC_MINOR__;
+#elif defined(_MSC_VER)
+		out << "msvc " << _MSC_VER;
+#else
+		out << "unknown";
+#endif
+		return out.str();
+	}
+
+	// JSON
+
+	std::string Escape(const std::string& text)
+	{
+		std::string out;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\') out += '\\';
+			out += c;
+		}
+		return out;
+	}
+
+	void WriteJson(const std::string& path, const std::vector<Result>& results)
+	{
+		std::ofstream out(path);
+		out.precision(6);
+		out << "{\n";
+		out << "  \"context\": { \"compiler\": \"" << Escape(CompilerName()) << "\", \"simd\": \"" << SimdName()
+			<< "\", \"dispatch\": \"" << simd::IsaName(simd::ActiveIsa()) << "\" },\n";
+		out << "  \"benchmarks\": [\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& r = results[i];
+			out << "    { \"name\": \"" << Escape(r.name) << "\", \"items\": " << r.items << ", \"iterations\": " << r.iterations
+				<< ", \"ns_per_op\": " << r.nsPerOp << ", \"min_ns_per_op\": " << r.minNsPerOp
+				<< ", \"items_per_second\": " << r.ItemsPerSecond() << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		out << "  ]\n}\n";
+	}
+
+	// Reads back the name / ns_per_op pairs of a file produced by WriteJson.
+	std::vector<std::pair<std::string, float64>> ReadBaseline(const std::string& path)
+	{
+		std::ifstream in(path);
+		std::stringstream buffer;
+		buffer << in.rdbuf();
+		const std::string text = buffer.str();
+
+		std::vector<std::pair<std::string, float64>> entries;
+		size_t pos = 0;
+		while ((pos = text.find("\"name\": \"", pos)) != std::string::npos)
+		{
+			pos += 9;
+			std::string name;
+			for (; pos < text.size() && text[pos] != '"'; ++pos)
+			{
+				if (text[pos] == '\\') ++pos;
+				name += text[pos];
+			}
+
+			size_t value = text.find("\"ns_per_op\": ", pos);
+			if (value == std::string::npos) break;
+			entries.emplace_back(name, std::strtod(text.c_str() + value + 13, nullptr));
+			pos = value;
+		}
+		return entries;
+	}
+
+	constexpr int EXIT_REGRESSION = 1;
+	constexpr int EXIT_USAGE = 2;
+	constexpr int EXIT_NO_BASELINE = 3;
+
+	// Exit code of the comparison: EXIT_NO_BASELINE when the file cannot be read or has no
+	// entries, EXIT_REGRESSION when a benchmark is slower by more than threshold percent.
+	int Compare(const std::vector<Result>& results, const Options& options)
+	{
+		const std::string& path = options.baselinePath;
+		if (!std::ifstream(path))
+		{
+			std::fprintf(stderr, "\ncannot read baseline %s\n", path.c_str());
+			return EXIT_NO_BASELINE;
+		}
+
+		auto baseline = ReadBaseline(path);
+		if (baseline.empty())
+		{
+			std::fprintf(stderr, "\nbaseline %s: no entries\n", path.c_str());
+			return EXIT_NO_BASELINE;
+		}
+
+		size_t regressions = 0;
+		std::printf("\n%-56s %12s %12s %9s\n", "compared to baseline", "baseline ns", "current ns", "change");
+		for (const Result& r : results)
+		{
+			auto it = std::find_if(baseline.begin(), baseline.end(), [&](const auto& entry) { return entry.first == r.name; });
+			if (it == baseline.end() || it->second <= 0.0) continue;
+
+			float64 change = (r.nsPerOp / it->second - 1.0) * 100.0;
+			bool regressed = change > options.threshold;
+			regressions += regressed;
+			std::printf("%-56s %12.2f %12.2f %+8.1f%%%s\n", r.name.c_str(), it->second, r.nsPerOp, change, regressed ? "  REGRESSION" : "");
+		}
+
+		// Baseline entries the filter selects but this run did not measure: renamed or removed cases.
+		for (const auto& [name, nsPerOp] : baseline)
+		{
+			bool selected = options.filter.empty() || name.find(options.filter) != std::string::npos;
+			if (selected && std::none_of(results.begin(), results.end(), [&](const Result& r) { return r.name == name; }))
+			{
+				std::printf("%-56s %12.2f %12s\n", name.c_str(), nsPerOp, "missing");
+			}
+		}
+
+		std::printf("\n%zu regression(s) above %.1f%%\n", regressions, options.threshold);
+		return regressions > 0 ? EXIT_REGRESSION : 0;
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (arg == "--list") options.list = true;
+			else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+			else if (arg == "--json" && hasValue) options.jsonPath = argv[++i];
+			else if (arg == "--baseline" && hasValue) options.baselinePath = argv[++i];
+			else if (arg == "--threshold" && hasValue) options.threshold = std::atof(argv[++i]);
+			else if (arg == "--min-time" && hasValue) options.minTime = std::atof(argv[++i]);
+			else if (arg == "--repetitions" && hasValue) options.repetitions = Max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+			else if (arg == "--isa" && hasValue) options.isa = argv[++i];
+			else
+			{
+				std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ApplyIsa(const std::string& name)
+	{
+		for (simd::Isa isa : { simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512 })
+		{
+			if (name == simd::IsaName(isa))
+			{
+				simd::SetIsa(isa);
+				return true;
+			}
+		}
+		std::fprintf(stderr, "unknown isa %s\n", name.c_str());
+		return false;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options) || (!options.isa.empty() && !ApplyIsa(options.isa)))
+	{
+		return EXIT_USAGE;
+	}
+
+	std::vector<Result> results;
+	std::printf("mathlib_bench | %s | %s | dispatch %s\n\n", CompilerName().c_str(), SimdName(), simd::IsaName(simd::ActiveIsa()));
+	std::printf("%-56s %12s %16s\n", "benchmark", "ns/op", "items/s");
+
+	for (const Case& c : Registry())
+	{
+		if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos) continue;
+
+		if (options.list)
+		{
+			std::printf("%s\n", c.name.c_str());
+			continue;
+		}
+
+		Result r = Measure(c, options);
+		std::printf("%-56s %12.2f %16.4g\n", r.name.c_str(), r.nsPerOp, r.ItemsPerSecond());
+		std::fflush(stdout);
+		results.push_back(r);
+	}
+
+	if (!options.jsonPath.empty())
+	{
+		WriteJson(options.jsonPath, results);
+	}
+
+	if (!options.baselinePath.empty())
+	{
+		return Compare(results, options);
+	}
+
+	return 0;
+}
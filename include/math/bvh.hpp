@@ -0,0 +1,679 @@
+#ifndef MATHLIB_BVH_HPP
+#define MATHLIB_BVH_HPP
+#pragma once
+
+#include <math/intersection.hpp>
+#include <math/parallel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+namespace math
+{
+	// BVH NODE
+	// 32 bytes. Siblings are adjacent and stored after their parent.
+
+	struct alignas(32) BvhNode
+	{
+		Vec3 min;
+		uint32 first;	// Leaf: first primitive slot. Interior: left child, the right one follows.
+		Vec3 max;
+		uint32 count;	// Primitives of a leaf, 0 for an interior node.
+
+		constexpr bool IsLeaf() const { return count != 0; }
+		constexpr AABB Bounds() const { return AABB(min, max); }
+	};
+
+	static_assert(sizeof(BvhNode) == 32);
+
+	struct BvhHit
+	{
+		static constexpr uint32 NONE = ~0u;
+
+		uint32 primitive = NONE;
+		float32 distance = std::numeric_limits<float32>::infinity();
+	};
+
+	// BVH
+	// Binary hierarchy over AABBs or triangles, built with a binned surface area heuristic.
+	// Nodes with more than PARALLEL_GRAIN primitives are binned on ParallelFor, the smaller
+	// subtrees are then built concurrently. Queries walk a fixed-size stack and do not
+	// allocate; they report the index of the primitive in the span given to Build().
+	// Ray queries test the triangles of a triangle hierarchy and the boxes otherwise, the
+	// overlap queries test primitive bounds. Refit() keeps the tree and recomputes the
+	// bounds, for animated geometry that stays close to its build pose.
+
+	class Bvh
+	{
+	public:
+		static constexpr size_t MAX_LEAF_SIZE = 4;
+		static constexpr size_t BIN_COUNT = 16;
+		static constexpr size_t MAX_DEPTH = 64;
+		static constexpr size_t PARALLEL_GRAIN = 4096;
+
+		// Cost of visiting a node, relative to one primitive test, in the SAH.
+		static constexpr float32 TRAVERSAL_COST = 2.0f;
+
+		// Rays per ParallelFor chunk in the batched queries, a multiple of 64.
+		static constexpr size_t RAY_GRAIN = 256;
+
+		void Build(std::span<const AABB> boxes)
+		{
+			triangles.clear();
+			Build(boxes.size(), [&](size_t i) { return boxes[i]; });
+		}
+
+		void Build(std::span<const Triangle> source)
+		{
+			Build(source.size(), [&](size_t i) { return Bounds(source[i]); });
+			triangles.resize(source.size());
+			for (size_t k = 0; k < source.size(); ++k)
+			{
+				triangles[k] = source[indices[k]];
+			}
+		}
+
+		// Same primitives, in the same order, as the last Build().
+		void Refit(std::span<const AABB> boxes)
+		{
+			assert(triangles.empty() && boxes.size() == indices.size());
+			ParallelFor(indices.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t k = begin; k < end; ++k)
+				{
+					primitiveBounds[k] = boxes[indices[k]];
+				}
+			});
+			RefitNodes();
+		}
+
+		void Refit(std::span<const Triangle> source)
+		{
+			assert(source.size() == indices.size() && triangles.size() == indices.size());
+			ParallelFor(indices.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t k = begin; k < end; ++k)
+				{
+					triangles[k] = source[indices[k]];
+					primitiveBounds[k] = Bounds(triangles[k]);
+				}
+			});
+			RefitNodes();
+		}
+
+		bool Empty() const { return nodes.empty(); }
+		size_t PrimitiveCount() const { return indices.size(); }
+		AABB GetBounds() const { return nodes.empty() ? AABB() : nodes[0].Bounds(); }
+
+		std::span<const BvhNode> Nodes() const { return nodes; }
+
+		// Build() index of the primitive in each leaf slot.
+		std::span<const uint32> PrimitiveIndices() const { return indices; }
+
+		// Nearest hit closer than maxDistance.
+		bool ClosestHit(const Ray& ray, BvhHit& hit, float32 maxDistance = std::numeric_limits<float32>::infinity()) const
+		{
+			float32 closest = maxDistance;
+			uint32 found = BvhHit::NONE;
+			Traverse(ray, closest, [&](uint32 slot, float32 t)
+			{
+				closest = t;
+				found = slot;
+				return false;
+			});
+
+			if (found == BvhHit::NONE)
+			{
+				return false;
+			}
+			hit.primitive = indices[found];
+			hit.distance = closest;
+			return true;
+		}
+
+		// Whether anything is hit closer than maxDistance, for visibility rays.
+		bool AnyHit(const Ray& ray, float32 maxDistance = std::numeric_limits<float32>::infinity()) const
+		{
+			bool occluded = false;
+			Traverse(ray, maxDistance, [&](uint32, float32)
+			{
+				occluded = true;
+				return true;
+			});
+			return occluded;
+		}
+
+		// Batched queries on ParallelFor. Misses keep the default BvhHit.
+		void ClosestHit(std::span<const Ray> rays, std::span<BvhHit> hits, float32 maxDistance = std::numeric_limits<float32>::infinity()) const
+		{
+			assert(hits.size() >= rays.size());
+			ParallelFor(rays.size(), RAY_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					hits[i] = BvhHit();
+					ClosestHit(rays[i], hits[i], maxDistance);
+				}
+			});
+		}
+
+		// Bit i of occluded[i / 64] is set when ray i hits something closer than maxDistance.
+		void AnyHit(std::span<const Ray> rays, std::span<uint64> occluded, float32 maxDistance = std::numeric_limits<float32>::infinity()) const
+		{
+			assert(occluded.size() >= (rays.size() + 63) / 64);
+			ParallelFor(rays.size(), RAY_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t word = begin; word < end; word += 64)
+				{
+					uint64 bits = 0;
+					for (size_t i = word; i < Min(word + 64, end); ++i)
+					{
+						bits |= uint64(AnyHit(rays[i], maxDistance)) << (i - word);
+					}
+					occluded[word / 64] = bits;
+				}
+			});
+		}
+
+		// f(primitive) for every primitive whose bounds overlap box.
+		template<typename F>
+		void Overlap(const AABB& box, F&& f) const
+		{
+			Query([&](const AABB& bounds) { return Overlaps(bounds, box); }, f);
+		}
+
+		// f(primitive) for every primitive whose bounds overlap sphere.
+		template<typename F>
+		void Overlap(const Sphere& sphere, F&& f) const
+		{
+			Query([&](const AABB& bounds) { return Overlaps(bounds, sphere); }, f);
+		}
+
+	private:
+		using PackType = simd::Pack<float32, 4>;
+
+		// Build-time box, x, y, z and an unused lane per register.
+		struct Box
+		{
+			PackType min = PackType::Broadcast(std::numeric_limits<float32>::max());
+			PackType max = PackType::Broadcast(-std::numeric_limits<float32>::max());
+
+			void Expand(const Box& other)
+			{
+				min = Min(min, other.min);
+				max = Max(max, other.max);
+			}
+
+			void Expand(const PackType& p)
+			{
+				min = Min(min, p);
+				max = Max(max, p);
+			}
+
+			float32 SurfaceArea() const
+			{
+				PackType s = max - min;
+				return 2.0f * (s[0] * s[1] + s[1] * s[2] + s[2] * s[0]);
+			}
+		};
+
+		struct Bin
+		{
+			Box bounds;
+			uint32 count = 0;
+		};
+
+		using Bins = std::array<std::array<Bin, BIN_COUNT>, 3>;
+
+		struct Range
+		{
+			Box bounds;
+			Box centroids;
+		};
+
+		struct Split
+		{
+			size_t axis = 0;
+			size_t bin = 0;
+			float32 cost = std::numeric_limits<float32>::infinity();
+		};
+
+		struct Subtree
+		{
+			uint32 node;
+			uint32 begin;
+			uint32 end;
+			uint32 depth;
+		};
+
+		template<typename GetBounds>
+		void Build(size_t count, GetBounds&& getBounds)
+		{
+			assert(count < BvhHit::NONE);
+
+			nodes.clear();
+			indices.resize(count);
+			primitiveBounds.resize(count);
+			boxes.resize(count);
+			if (count == 0)
+			{
+				return;
+			}
+
+			ParallelFor(count, PARALLEL_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					AABB bounds = getBounds(i);
+					indices[i] = static_cast<uint32>(i);
+					boxes[i].min = PackType::LoadPartial(bounds.min.Data(), 3);
+					boxes[i].max = PackType::LoadPartial(bounds.max.Data(), 3);
+					primitiveBounds[i] = bounds;
+				}
+			});
+
+			// Large nodes are split here with parallel binning, the subtrees below
+			// PARALLEL_GRAIN are built one per task into their own arrays, then appended.
+			nodes.reserve(2 * count / MAX_LEAF_SIZE + 1);
+			nodes.emplace_back();
+			std::vector<Subtree> subtrees;
+			SplitNode(nodes, 0, 0, static_cast<uint32>(count), 0, &subtrees);
+
+			std::vector<std::vector<BvhNode>> built(subtrees.size());
+			ParallelFor(subtrees.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t t = begin; t < end; ++t)
+				{
+					const Subtree& subtree = subtrees[t];
+					built[t].emplace_back();
+					SplitNode(built[t], 0, subtree.begin, subtree.end, subtree.depth, nullptr);
+				}
+			});
+
+			for (size_t t = 0; t < subtrees.size(); ++t)
+			{
+				const uint32 base = static_cast<uint32>(nodes.size()) - 1;
+				auto relocate = [&](const BvhNode& local)
+				{
+					BvhNode node = local;
+					if (!node.IsLeaf())
+					{
+						node.first += base;
+					}
+					return node;
+				};
+
+				nodes[subtrees[t].node] = relocate(built[t][0]);
+				for (size_t k = 1; k < built[t].size(); ++k)
+				{
+					nodes.push_back(relocate(built[t][k]));
+				}
+			}
+
+			// Leaf order from here on.
+			std::vector<AABB> sorted(count);
+			for (size_t k = 0; k < count; ++k)
+			{
+				sorted[k] = primitiveBounds[indices[k]];
+			}
+			primitiveBounds.swap(sorted);
+			boxes.clear();
+			boxes.shrink_to_fit();
+		}
+
+		// Accumulates f(partial, i) over [begin, end), on ParallelFor for large ranges.
+		template<typename T, typename F, typename Merge>
+		static T Reduce(uint32 begin, uint32 end, bool parallel, F&& f, Merge&& merge)
+		{
+			const size_t count = end - begin;
+			if (!parallel || count <= PARALLEL_GRAIN)
+			{
+				T result;
+				for (uint32 i = begin; i < end; ++i)
+				{
+					f(result, i);
+				}
+				return result;
+			}
+
+			std::vector<T> partial((count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+			ParallelFor(count, PARALLEL_GRAIN, [&](size_t chunkBegin, size_t chunkEnd)
+			{
+				T& result = partial[chunkBegin / PARALLEL_GRAIN];
+				for (size_t i = chunkBegin; i < chunkEnd; ++i)
+				{
+					f(result, static_cast<uint32>(begin + i));
+				}
+			});
+
+			T result;
+			for (const T& p : partial)
+			{
+				merge(result, p);
+			}
+			return result;
+		}
+
+		// Twice the centroid, the binning only needs it up to scale.
+		PackType Centroid(uint32 primitive) const
+		{
+			return boxes[primitive].min + boxes[primitive].max;
+		}
+
+		void SplitNode(std::vector<BvhNode>& out, uint32 node, uint32 begin, uint32 end, uint32 depth, std::vector<Subtree>* subtrees)
+		{
+			const uint32 count = end - begin;
+			const bool parallel = subtrees != nullptr;
+
+			if (parallel && count <= PARALLEL_GRAIN)
+			{
+				subtrees->push_back({ node, begin, end, depth });
+				return;
+			}
+
+			Range range = Reduce<Range>(begin, end, parallel,
+				[&](Range& r, uint32 i)
+				{
+					r.bounds.Expand(boxes[indices[i]]);
+					r.centroids.Expand(Centroid(indices[i]));
+				},
+				[](Range& r, const Range& p)
+				{
+					r.bounds.Expand(p.bounds);
+					r.centroids.Expand(p.centroids);
+				});
+
+			range.bounds.min.StorePartial(out[node].min.Data(), 3);
+			range.bounds.max.StorePartial(out[node].max.Data(), 3);
+
+			auto makeLeaf = [&]
+			{
+				out[node].first = begin;
+				out[node].count = count;
+			};
+
+			if (count == 1 || depth + 1 >= MAX_DEPTH)
+			{
+				makeLeaf();
+				return;
+			}
+
+			// Bin centroids along each axis with a non-degenerate extent.
+			alignas(16) std::array<float32, 4> extent, scale;
+			(range.centroids.max - range.centroids.min).StoreAligned(extent.data());
+			for (size_t axis = 0; axis < 4; ++axis)
+			{
+				scale[axis] = axis < 3 && extent[axis] > 0.0f ? float32(BIN_COUNT) / extent[axis] : 0.0f;
+			}
+			const PackType origin = range.centroids.min;
+			const PackType scalePack = PackType::LoadAligned(scale.data());
+
+			auto binOf = [](float32 offset)
+			{
+				return Min(static_cast<size_t>(offset), BIN_COUNT - 1);
+			};
+
+			Bins bins = Reduce<Bins>(begin, end, parallel,
+				[&](Bins& b, uint32 i)
+				{
+					const uint32 primitive = indices[i];
+					alignas(16) std::array<float32, 4> offset;
+					((Centroid(primitive) - origin) * scalePack).StoreAligned(offset.data());
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						Bin& bin = b[axis][binOf(offset[axis])];
+						bin.bounds.Expand(boxes[primitive]);
+						++bin.count;
+					}
+				},
+				[](Bins& b, const Bins& p)
+				{
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						for (size_t k = 0; k < BIN_COUNT; ++k)
+						{
+							b[axis][k].bounds.Expand(p[axis][k].bounds);
+							b[axis][k].count += p[axis][k].count;
+						}
+					}
+				});
+
+			// Sweep: split after bin k puts bins [0, k] on the left.
+			Split best;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				if (scale[axis] == 0.0f)
+				{
+					continue;
+				}
+
+				std::array<float32, BIN_COUNT> leftCost;
+				Box leftBounds;
+				uint32 leftCount = 0;
+				for (size_t k = 0; k + 1 < BIN_COUNT; ++k)
+				{
+					leftBounds.Expand(bins[axis][k].bounds);
+					leftCount += bins[axis][k].count;
+					leftCost[k] = leftCount ? leftBounds.SurfaceArea() * float32(leftCount) : 0.0f;
+				}
+
+				Box rightBounds;
+				uint32 rightCount = 0;
+				for (size_t k = BIN_COUNT - 1; k > 0; --k)
+				{
+					rightBounds.Expand(bins[axis][k].bounds);
+					rightCount += bins[axis][k].count;
+					if (rightCount == 0 || rightCount == count)
+					{
+						continue;
+					}
+
+					float32 cost = leftCost[k - 1] + rightBounds.SurfaceArea() * float32(rightCount);
+					if (cost < best.cost)
+					{
+						best = { axis, k - 1, cost };
+					}
+				}
+			}
+
+			// Costs relative to one primitive test.
+			const float32 leafCost = float32(count);
+			const float32 splitCost = TRAVERSAL_COST + best.cost / range.bounds.SurfaceArea();
+			if (count <= MAX_LEAF_SIZE && (best.cost == std::numeric_limits<float32>::infinity() || splitCost >= leafCost))
+			{
+				makeLeaf();
+				return;
+			}
+
+			uint32* first = indices.data() + begin;
+			uint32* last = indices.data() + end;
+			uint32* middle;
+			if (best.cost == std::numeric_limits<float32>::infinity())
+			{
+				// All centroids in one bin or at one point: halve the range.
+				middle = first + count / 2;
+				size_t axis = extent[1] > extent[0] ? (extent[2] > extent[1] ? 2 : 1) : (extent[2] > extent[0] ? 2 : 0);
+				std::nth_element(first, middle, last, [&](uint32 a, uint32 b) { return Centroid(a)[axis] < Centroid(b)[axis]; });
+			}
+			else
+			{
+				const float32 axisOrigin = origin[best.axis];
+				const float32 axisScale = scale[best.axis];
+				middle = std::partition(first, last, [&](uint32 primitive)
+				{
+					return binOf((Centroid(primitive)[best.axis] - axisOrigin) * axisScale) <= best.bin;
+				});
+			}
+
+			const uint32 split = static_cast<uint32>(middle - indices.data());
+			const uint32 left = static_cast<uint32>(out.size());
+			out[node].first = left;
+			out[node].count = 0;
+			out.emplace_back();
+			out.emplace_back();
+
+			SplitNode(out, left, begin, split, depth + 1, subtrees);
+			SplitNode(out, left + 1, split, end, depth + 1, subtrees);
+		}
+
+		void RefitNodes()
+		{
+			for (size_t i = nodes.size(); i-- > 0;)
+			{
+				BvhNode& node = nodes[i];
+				AABB bounds;
+				if (node.IsLeaf())
+				{
+					for (uint32 k = node.first; k < node.first + node.count; ++k)
+					{
+						bounds.Expand(primitiveBounds[k]);
+					}
+				}
+				else
+				{
+					bounds = Merge(nodes[node.first].Bounds(), nodes[node.first + 1].Bounds());
+				}
+				node.min = bounds.min;
+				node.max = bounds.max;
+			}
+		}
+
+		// Slab test against [0, tMax], entry distance in tNear.
+		static bool IntersectNode(const BvhNode& node, const Vec3& origin, const Vec3& inverse, float32 tMax, float32& tNear)
+		{
+			float32 t0 = 0.0f;
+			float32 t1 = tMax;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				float32 a = (node.min[axis] - origin[axis]) * inverse[axis];
+				float32 b = (node.max[axis] - origin[axis]) * inverse[axis];
+				t0 = Max(t0, Min(a, b));
+				t1 = Min(t1, Max(a, b));
+			}
+			tNear = t0;
+			return t0 <= t1;
+		}
+
+		bool IntersectPrimitive(const Ray& ray, uint32 slot, float32& t) const
+		{
+			return triangles.empty() ? RayAABB(ray, primitiveBounds[slot], t) : RayTriangle(ray, triangles[slot], t);
+		}
+
+		// Nearest child first. onHit(slot, t) is called for hits closer than tMax, which it
+		// may lower; returning true stops the walk.
+		template<typename OnHit>
+		void Traverse(const Ray& ray, float32& tMax, OnHit&& onHit) const
+		{
+			if (nodes.empty())
+			{
+				return;
+			}
+
+			Vec3 inverse(1.0f / ray.direction[0], 1.0f / ray.direction[1], 1.0f / ray.direction[2]);
+			float32 tNear;
+			if (!IntersectNode(nodes[0], ray.origin, inverse, tMax, tNear))
+			{
+				return;
+			}
+
+			std::array<uint32, MAX_DEPTH> stack;
+			std::array<float32, MAX_DEPTH> stackNear;
+			size_t size = 0;
+			uint32 index = 0;
+
+			for (;;)
+			{
+				const BvhNode& node = nodes[index];
+				if (node.IsLeaf())
+				{
+					for (uint32 k = node.first; k < node.first + node.count; ++k)
+					{
+						float32 t;
+						if (IntersectPrimitive(ray, k, t) && t < tMax && onHit(k, t))
+						{
+							return;
+						}
+					}
+				}
+				else
+				{
+					float32 nearLeft, nearRight;
+					bool left = IntersectNode(nodes[node.first], ray.origin, inverse, tMax, nearLeft);
+					bool right = IntersectNode(nodes[node.first + 1], ray.origin, inverse, tMax, nearRight);
+					if (left && right)
+					{
+						bool rightFirst = nearRight < nearLeft;
+						stack[size] = node.first + (rightFirst ? 0 : 1);
+						stackNear[size++] = rightFirst ? nearLeft : nearRight;
+						index = node.first + (rightFirst ? 1 : 0);
+						continue;
+					}
+					if (left || right)
+					{
+						index = node.first + (left ? 0 : 1);
+						continue;
+					}
+				}
+
+				// Pop, skipping nodes entered beyond the closest hit found since the push.
+				do
+				{
+					if (size == 0)
+					{
+						return;
+					}
+					--size;
+				} while (stackNear[size] > tMax);
+				index = stack[size];
+			}
+		}
+
+		template<typename Test, typename F>
+		void Query(Test&& test, F&& f) const
+		{
+			if (nodes.empty() || !test(nodes[0].Bounds()))
+			{
+				return;
+			}
+
+			std::array<uint32, MAX_DEPTH> stack;
+			size_t size = 0;
+			stack[size++] = 0;
+			while (size > 0)
+			{
+				const BvhNode& node = nodes[stack[--size]];
+				if (node.IsLeaf())
+				{
+					for (uint32 k = node.first; k < node.first + node.count; ++k)
+					{
+						if (test(primitiveBounds[k]))
+						{
+							f(indices[k]);
+						}
+					}
+					continue;
+				}
+
+				for (uint32 child = node.first; child < node.first + 2; ++child)
+				{
+					if (test(nodes[child].Bounds()))
+					{
+						stack[size++] = child;
+					}
+				}
+			}
+		}
+
+		std::vector<BvhNode> nodes;
+		std::vector<uint32> indices;
+		std::vector<AABB> primitiveBounds;
+		std::vector<Triangle> triangles;
+		std::vector<Box> boxes;
+	};
+}
+
+#endif // MATHLIB_BVH_HPP
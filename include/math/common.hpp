@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cmath>
+#include <concepts>
 #include <cstdint>
 #include <cstddef>
 #include <limits>
@@ -13,6 +14,7 @@ namespace math
 	// TYPES
 
 	using uint		= unsigned int;
+	using uint8		= uint8_t;
 	using uint32	= uint32_t;
 	using uint64	= uint64_t;
 
@@ -31,6 +33,24 @@ namespace math
 	constexpr float32 TAU_f32		= 2.0f * PI_f32;
 	constexpr float64 TAU_f64		= 2.0 * PI_f64;
 
+	// Reciprocal square root tiers: Fast is the hardware estimate (~12 bits),
+	// Accurate adds one Newton-Raphson step (~23 bits), Exact is 1 / std::sqrt.
+	enum class SqrtPrecision
+	{
+		Exact,
+		Accurate,
+		Fast
+	};
+
+	// Trigonometry tiers of math::fast (errors listed in fast.hpp): Exact is the std::
+	// function, Accurate and Fast are float32 polynomials.
+	enum class TrigPrecision
+	{
+		Exact,
+		Accurate,
+		Fast
+	};
+
 	// UTIL FUNCTIONS
 
 	template<std::floating_point T>
@@ -100,6 +120,196 @@ namespace math
 		return Clamp(x, T(0), T(1));
 	}
 
+	template<std::floating_point T>
+	constexpr bool IsFinite(T value)
+	{
+		return value - value == T(0);
+	}
+
+	// CONSTEXPR MATH
+	// std:: functions at runtime. In constant expressions they are evaluated by the
+	// series below in float64, then rounded to T.
+
+	namespace detail
+	{
+		constexpr float64 SQRT3_f64		= 1.7320508075688772;
+		constexpr float64 PIO2_HI_f64	= 1.57079632673412561417e+00;
+		constexpr float64 PIO2_MID_f64	= 6.07710050630396597660e-11;
+		constexpr float64 PIO2_LO_f64	= 2.02226624879595063154e-21;
+
+		constexpr float64 SqrtNewton(float64 x)
+		{
+			if (!(x >= 0.0)) return std::numeric_limits<float64>::quiet_NaN();
+			if (x == 0.0 || x == std::numeric_limits<float64>::infinity()) return x;
+
+			// Decreases monotonically from any start above sqrt(x).
+			float64 guess = (x > 1.0) ? x : 1.0;
+			for (;;)
+			{
+				float64 next = (guess + x / guess) * 0.5;
+				if (next >= guess) break;
+				guess = next;
+			}
+
+			// Final step on the exact residual guess^2 - x (Veltkamp split).
+			float64 c = 134217729.0 * guess;
+			float64 hi = c - (c - guess);
+			float64 lo = guess - hi;
+			float64 square = guess * guess;
+			float64 error = ((hi * hi - square) + 2.0 * hi * lo) + lo * lo;
+			return guess - ((square - x) + error) / (2.0 * guess);
+		}
+
+		// sin (cosine = false) or cos of x: x = k * pi/2 + r with |r| <= pi/4, then Taylor.
+		constexpr float64 SinCos(float64 x, bool cosine)
+		{
+			if (!IsFinite(x)) return std::numeric_limits<float64>::quiet_NaN();
+
+			int64 k = static_cast<int64>(x * (2.0 / PI_f64) + ((x >= 0.0) ? 0.5 : -0.5));
+			float64 fk = static_cast<float64>(k);
+			float64 r = ((x - fk * PIO2_HI_f64) - fk * PIO2_MID_f64) - fk * PIO2_LO_f64;
+			float64 r2 = r * r;
+
+			uint64 quadrant = static_cast<uint64>(k + (cosine ? 1 : 0)) & 3u;
+			bool useCos = (quadrant & 1u) != 0;
+
+			float64 term = useCos ? 1.0 : r;
+			float64 sum = term;
+			for (int32 n = 1; n < 12; ++n)
+			{
+				float64 a = useCos ? 2.0 * n - 1.0 : 2.0 * n;
+				term *= -r2 / (a * (a + 1.0));
+				sum += term;
+			}
+
+			return (quadrant & 2u) ? -sum : sum;
+		}
+
+		constexpr float64 Atan(float64 x)
+		{
+			if (x != x) return x;
+			if (x < 0.0) return -Atan(-x);
+			if (x > 1.0) return PI_f64 / 2.0 - Atan(1.0 / x);
+
+			// atan(x) = pi/6 + atan((sqrt(3) x - 1) / (x + sqrt(3))) brings x under tan(pi/12).
+			float64 offset = 0.0;
+			if (x > 0.2679491924311227)
+			{
+				x = (x * SQRT3_f64 - 1.0) / (x + SQRT3_f64);
+				offset = PI_f64 / 6.0;
+			}
+
+			float64 x2 = x * x;
+			float64 power = x;
+			float64 sum = x;
+			for (int32 n = 3; n < 64; n += 2)
+			{
+				power *= -x2;
+				sum += power / static_cast<float64>(n);
+			}
+			return offset + sum;
+		}
+
+		constexpr float64 Atan2(float64 y, float64 x)
+		{
+			if (x != x || y != y) return x + y;
+			if (x > 0.0) return Atan(y / x);
+			if (x < 0.0) return (y >= 0.0) ? Atan(y / x) + PI_f64 : Atan(y / x) - PI_f64;
+			if (y > 0.0) return PI_f64 / 2.0;
+			if (y < 0.0) return -PI_f64 / 2.0;
+			return 0.0;
+		}
+	}
+
+	template<std::floating_point T>
+	constexpr T Sqrt(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<T>(detail::SqrtNewton(static_cast<float64>(x)));
+		}
+		return std::sqrt(x);
+	}
+
+	template<std::integral T>
+	constexpr float64 Sqrt(T x)
+	{
+		return Sqrt(static_cast<float64>(x));
+	}
+
+	template<std::floating_point T>
+	constexpr T Sin(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<T>(detail::SinCos(static_cast<float64>(x), false));
+		}
+		return std::sin(x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Cos(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<T>(detail::SinCos(static_cast<float64>(x), true));
+		}
+		return std::cos(x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Tan(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			float64 v = static_cast<float64>(x);
+			return static_cast<T>(detail::SinCos(v, false) / detail::SinCos(v, true));
+		}
+		return std::tan(x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Atan(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<T>(detail::Atan(static_cast<float64>(x)));
+		}
+		return std::atan(x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Atan2(T y, T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<T>(detail::Atan2(static_cast<float64>(y), static_cast<float64>(x)));
+		}
+		return std::atan2(y, x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Asin(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			float64 v = static_cast<float64>(x);
+			return static_cast<T>(detail::Atan2(v, detail::SqrtNewton((1.0 - v) * (1.0 + v))));
+		}
+		return std::asin(x);
+	}
+
+	template<std::floating_point T>
+	constexpr T Acos(T x)
+	{
+		if (std::is_constant_evaluated())
+		{
+			float64 v = static_cast<float64>(x);
+			return static_cast<T>(detail::Atan2(detail::SqrtNewton((1.0 - v) * (1.0 + v)), v));
+		}
+		return std::acos(x);
+	}
+
 	template<typename T>
 	constexpr T Pow(T base, int32 exponent)
 	{
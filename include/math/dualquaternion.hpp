@@ -0,0 +1,381 @@
+#ifndef MATHLIB_DUALQUATERNION_HPP
+#define MATHLIB_DUALQUATERNION_HPP
+#pragma once
+
+#include <math/quaternion.hpp>
+#include <math/stream.hpp>
+
+namespace math
+{
+	// DUAL QUATERNION
+	// real + dual * e, e^2 = 0. A unit dual quaternion is a rigid transform: real is the
+	// rotation, dual = 0.5 * t * real for the translation t. Products compose like matrices,
+	// (a * b) applies b first, for 16 quaternion multiply-adds less than a Mat4 product.
+
+	struct DualQuaternion
+	{
+		Quaternion real;
+		Quaternion dual;
+
+		constexpr DualQuaternion() : real(), dual(0, 0, 0, 0) {}
+		constexpr DualQuaternion(const Quaternion& real, const Quaternion& dual) : real(real), dual(dual) {}
+
+		// Rotation first, then translation.
+		static constexpr DualQuaternion FromRotationTranslation(const Quaternion& rotation, const Vec3& translation)
+		{
+			return DualQuaternion(rotation, Quaternion(translation[0], translation[1], translation[2], 0.0f) * rotation * 0.5f);
+		}
+
+		static constexpr DualQuaternion FromTranslation(const Vec3& translation)
+		{
+			return DualQuaternion(Quaternion(), Quaternion(translation[0] * 0.5f, translation[1] * 0.5f, translation[2] * 0.5f, 0.0f));
+		}
+
+		// Rigid matrix: the upper 3x3 must be a rotation.
+		static constexpr DualQuaternion FromMatrix(const Mat4& m)
+		{
+			return FromRotationTranslation(Quaternion::FromRotationMatrix(m).Normalize(), Vec3(m(0, 3), m(1, 3), m(2, 3)));
+		}
+
+		constexpr DualQuaternion operator*(const DualQuaternion& other) const
+		{
+#if defined(MATHLIB_SSE2)
+			if (!std::is_constant_evaluated())
+			{
+				DualQuaternion result;
+				simd::DualQuaternionMul(&real.x, &other.real.x, &result.real.x);
+				return result;
+			}
+#endif
+			return DualQuaternion(real * other.real, real * other.dual + dual * other.real);
+		}
+
+		constexpr DualQuaternion operator+(const DualQuaternion& other) const
+		{
+			return DualQuaternion(real + other.real, dual + other.dual);
+		}
+
+		constexpr DualQuaternion operator*(float32 scalar) const
+		{
+			return DualQuaternion(real * scalar, dual * scalar);
+		}
+
+		friend constexpr DualQuaternion operator*(float32 scalar, const DualQuaternion& dq)
+		{
+			return dq * scalar;
+		}
+
+		// Quaternion conjugate of both parts: the inverse of a unit dual quaternion.
+		constexpr DualQuaternion Conjugate() const
+		{
+			return DualQuaternion(real.Conjugate(), dual.Conjugate());
+		}
+
+		constexpr DualQuaternion Inverse() const
+		{
+			Quaternion inv = real.Inverse();
+			return DualQuaternion(inv, inv * dual * inv * -1.0f);
+		}
+
+		// Unit real part and dual part orthogonal to it, so the result is a rigid transform.
+		constexpr DualQuaternion Normalize() const
+		{
+			float32 len = real.Length();
+			assert(len > 0);
+			float32 inv = 1.0f / len;
+
+			Quaternion r = real * inv;
+			Quaternion d = dual * inv;
+			return DualQuaternion(r, d + r * -Dot(r, d));
+		}
+
+		constexpr Quaternion GetRotation() const
+		{
+			return real;
+		}
+
+		// Vector part of 2 * dual * conjugate(real).
+		constexpr Vec3 GetTranslation() const
+		{
+			const Quaternion& r = real;
+			const Quaternion& d = dual;
+			return Vec3(
+				2.0f * (r.w * d.x - d.w * r.x + r.y * d.z - r.z * d.y),
+				2.0f * (r.w * d.y - d.w * r.y + r.z * d.x - r.x * d.z),
+				2.0f * (r.w * d.z - d.w * r.z + r.x * d.y - r.y * d.x)
+			);
+		}
+
+		constexpr Vec3 TransformPoint(const Vec3& p) const
+		{
+#if defined(MATHLIB_SSE2)
+			if (!std::is_constant_evaluated())
+			{
+				Vec3 result;
+				simd::DualQuaternionTransformPoint(&real.x, p.Data(), result.Data());
+				return result;
+			}
+#endif
+			return real * p + GetTranslation();
+		}
+
+		constexpr Vec3 TransformVector(const Vec3& v) const
+		{
+			return real * v;
+		}
+
+		constexpr Mat4 ToMatrix4() const
+		{
+			Mat4 m = real.ToMatrix4();
+			Vec3 t = GetTranslation();
+			m(0, 3) = t[0];
+			m(1, 3) = t[1];
+			m(2, 3) = t[2];
+			return m;
+		}
+
+		constexpr bool operator==(const DualQuaternion& other) const
+		{
+			return real == other.real && dual == other.dual;
+		}
+
+		constexpr bool NearlyEquals(const DualQuaternion& other, float32 epsilon = EPSILON_f32) const
+		{
+			return real.NearlyEquals(other.real, epsilon) && dual.NearlyEquals(other.dual, epsilon);
+		}
+	};
+
+	static_assert(sizeof(DualQuaternion) == 8 * sizeof(float32), "DualQuaternion must be tightly packed real, dual");
+
+	// BLENDING
+
+	// Screw linear interpolation: constant speed along the screw motion from a to b,
+	// the rigid-transform counterpart of Slerp. Inputs must be unit dual quaternions.
+	constexpr DualQuaternion Sclerp(const DualQuaternion& a, const DualQuaternion& b, float32 t, TrigPrecision precision = TrigPrecision::Exact)
+	{
+		DualQuaternion diff = a.Conjugate() * b;
+		if (diff.real.w < 0.0f)
+		{
+			diff = diff * -1.0f;
+		}
+
+		const Quaternion& r = diff.real;
+		const Quaternion& d = diff.dual;
+		Vec3 axis(r.x, r.y, r.z);
+		float32 sinHalf = axis.Length();
+
+		// Pure translation: the screw degenerates to a straight line.
+		if (sinHalf < 1e-6f)
+		{
+			return a * DualQuaternion(Quaternion(), d * t);
+		}
+
+		// Screw parameters: angle, pitch (translation along the axis), axis and moment.
+		float32 angle = 2.0f * fast::Acos(Min(r.w, 1.0f), precision);
+		float32 invSinHalf = 1.0f / sinHalf;
+		float32 pitch = -2.0f * d.w * invSinHalf;
+		axis = axis * invSinHalf;
+		Vec3 moment = (Vec3(d.x, d.y, d.z) - axis * (pitch * 0.5f * r.w)) * invSinHalf;
+
+		float32 s, c;
+		fast::SinCos(angle * t * 0.5f, s, c, precision);
+		float32 halfPitch = pitch * t * 0.5f;
+
+		Vec3 realPart = axis * s;
+		Vec3 dualPart = moment * s + axis * (halfPitch * c);
+		DualQuaternion power(Quaternion(realPart[0], realPart[1], realPart[2], c), Quaternion(dualPart[0], dualPart[1], dualPart[2], -halfPitch * s));
+		return a * power;
+	}
+
+	// Dual quaternion linear blending (Kavan et al.): weighted sum in a's hemisphere,
+	// normalized. Cheaper than Sclerp, same path for t in {0, 1}, close in between.
+	constexpr DualQuaternion Dlb(const DualQuaternion& a, const DualQuaternion& b, float32 t)
+	{
+		float32 wb = Dot(a.real, b.real) < 0.0f ? -t : t;
+		return (a * (1.0f - t) + b * wb).Normalize();
+	}
+
+	// N-way blend, as used for skinning. Each term is aligned with the first one.
+	constexpr DualQuaternion Dlb(std::span<const DualQuaternion> transforms, std::span<const float32> weights)
+	{
+		assert(!transforms.empty() && transforms.size() == weights.size());
+
+		DualQuaternion sum = transforms[0] * weights[0];
+		for (size_t i = 1; i < transforms.size(); ++i)
+		{
+			float32 w = Dot(transforms[0].real, transforms[i].real) < 0.0f ? -weights[i] : weights[i];
+			sum = sum + transforms[i] * w;
+		}
+		return sum.Normalize();
+	}
+
+	// SOA STREAMS
+
+	// Real x, y, z, w then dual x, y, z, w component arrays.
+	struct DualQuaternionStream : VecStream<8, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit DualQuaternionStream(std::span<const DualQuaternion> transforms)
+		{
+			Assign(transforms);
+		}
+
+		DualQuaternion Get(size_t index) const
+		{
+			return DualQuaternion(
+				Quaternion(components[0][index], components[1][index], components[2][index], components[3][index]),
+				Quaternion(components[4][index], components[5][index], components[6][index], components[7][index])
+			);
+		}
+
+		void Set(size_t index, const DualQuaternion& dq)
+		{
+			components[0][index] = dq.real.x;
+			components[1][index] = dq.real.y;
+			components[2][index] = dq.real.z;
+			components[3][index] = dq.real.w;
+			components[4][index] = dq.dual.x;
+			components[5][index] = dq.dual.y;
+			components[6][index] = dq.dual.z;
+			components[7][index] = dq.dual.w;
+		}
+
+		void Assign(std::span<const DualQuaternion> transforms)
+		{
+			Resize(transforms.size());
+			for (size_t index = 0; index < transforms.size(); ++index)
+			{
+				Set(index, transforms[index]);
+			}
+		}
+
+		void CopyTo(std::span<DualQuaternion> transforms) const
+		{
+			assert(transforms.size() >= Size());
+			for (size_t index = 0; index < Size(); ++index)
+			{
+				transforms[index] = Get(index);
+			}
+		}
+	};
+
+	template<size_t W = simd::NativeWidth<float32>>
+	using DualQuatPack = VecPack<8, float32, W>;
+
+	// Hamilton product of W quaternion pairs, a[0..3] * b[0..3] as x, y, z, w packs.
+	template<size_t W>
+	void QuaternionProduct(const simd::Pack<float32, W>* a, const simd::Pack<float32, W>* b, simd::Pack<float32, W>* out)
+	{
+		out[0] = MulAdd(a[3], b[0], MulAdd(a[0], b[3], a[1] * b[2] - a[2] * b[1]));
+		out[1] = MulAdd(a[3], b[1], MulAdd(a[1], b[3], a[2] * b[0] - a[0] * b[2]));
+		out[2] = MulAdd(a[3], b[2], MulAdd(a[2], b[3], a[0] * b[1] - a[1] * b[0]));
+		out[3] = a[3] * b[3] - (MulAdd(a[0], b[0], MulAdd(a[1], b[1], a[2] * b[2])));
+	}
+
+	template<size_t W>
+	DualQuatPack<W> Multiply(const DualQuatPack<W>& a, const DualQuatPack<W>& b)
+	{
+		DualQuatPack<W> result;
+		std::array<simd::Pack<float32, W>, 4> rd, dr;
+		QuaternionProduct<W>(&a.c[0], &b.c[0], &result.c[0]);
+		QuaternionProduct<W>(&a.c[0], &b.c[4], rd.data());
+		QuaternionProduct<W>(&a.c[4], &b.c[0], dr.data());
+		for (size_t c = 0; c < 4; ++c)
+		{
+			result.c[4 + c] = rd[c] + dr[c];
+		}
+		return result;
+	}
+
+	// SOA KERNELS
+
+	// out[i] = a[i] * b[i].
+	inline void Multiply(const DualQuaternionStream& a, const DualQuaternionStream& b, DualQuaternionStream& out)
+	{
+		assert(a.Size() == b.Size());
+		out.Resize(a.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::ForEachPack<float32, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				out.StorePack(i, lanes, Multiply<W>(a.LoadPack<W>(i, lanes), b.LoadPack<W>(i, lanes)));
+			});
+		});
+	}
+
+	// DualQuaternion::Normalize() of each transform.
+	inline void Normalize(const DualQuaternionStream& transforms, DualQuaternionStream& out)
+	{
+		out.Resize(transforms.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType one = PackType::Broadcast(1.0f);
+
+			simd::ForEachPack<float32, W>(transforms.Size(), [&](size_t i, size_t lanes)
+			{
+				DualQuatPack<W> dq = transforms.LoadPack<W>(i, lanes);
+
+				PackType realDot = MulAdd(dq.c[0], dq.c[0], MulAdd(dq.c[1], dq.c[1], MulAdd(dq.c[2], dq.c[2], dq.c[3] * dq.c[3])));
+				PackType inv = one / Sqrt(realDot);
+				for (size_t c = 0; c < 8; ++c)
+				{
+					dq.c[c] = dq.c[c] * inv;
+				}
+
+				PackType mixed = MulAdd(dq.c[0], dq.c[4], MulAdd(dq.c[1], dq.c[5], MulAdd(dq.c[2], dq.c[6], dq.c[3] * dq.c[7])));
+				for (size_t c = 0; c < 4; ++c)
+				{
+					dq.c[4 + c] = dq.c[4 + c] - dq.c[c] * mixed;
+				}
+
+				out.StorePack(i, lanes, dq);
+			});
+		});
+	}
+
+	// out[i] = transforms[i].TransformPoint(points[i]) for unit transforms.
+	inline void TransformPoints(const DualQuaternionStream& transforms, const Vec3Stream& points, Vec3Stream& out)
+	{
+		assert(transforms.Size() == points.Size());
+		out.Resize(points.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType two = PackType::Broadcast(2.0f);
+
+			simd::ForEachPack<float32, W>(points.Size(), [&](size_t i, size_t lanes)
+			{
+				DualQuatPack<W> dq = transforms.LoadPack<W>(i, lanes);
+				VecPack<3, float32, W> v = points.LoadPack<W>(i, lanes);
+				const PackType* r = &dq.c[0];
+				const PackType* d = &dq.c[4];
+
+				// v + 2 w (r x v) + 2 r x (r x v) + 2 (w d - dw r + r x d)
+				VecPack<3, float32, W> t;
+				t.c[0] = (r[1] * v.c[2] - r[2] * v.c[1]) * two;
+				t.c[1] = (r[2] * v.c[0] - r[0] * v.c[2]) * two;
+				t.c[2] = (r[0] * v.c[1] - r[1] * v.c[0]) * two;
+
+				VecPack<3, float32, W> p;
+				p.c[0] = MulAdd(r[3], d[0], r[1] * d[2] - r[2] * d[1]) - d[3] * r[0];
+				p.c[1] = MulAdd(r[3], d[1], r[2] * d[0] - r[0] * d[2]) - d[3] * r[1];
+				p.c[2] = MulAdd(r[3], d[2], r[0] * d[1] - r[1] * d[0]) - d[3] * r[2];
+
+				v.c[0] = MulAdd(p.c[0], two, MulAdd(t.c[0], r[3], v.c[0] + (r[1] * t.c[2] - r[2] * t.c[1])));
+				v.c[1] = MulAdd(p.c[1], two, MulAdd(t.c[1], r[3], v.c[1] + (r[2] * t.c[0] - r[0] * t.c[2])));
+				v.c[2] = MulAdd(p.c[2], two, MulAdd(t.c[2], r[3], v.c[2] + (r[0] * t.c[1] - r[1] * t.c[0])));
+
+				out.StorePack(i, lanes, v);
+			});
+		});
+	}
+}
+
+#endif // MATHLIB_DUALQUATERNION_HPP
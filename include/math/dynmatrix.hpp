@@ -0,0 +1,407 @@
+#ifndef MATHLIB_DYNMATRIX_HPP
+#define MATHLIB_DYNMATRIX_HPP
+#pragma once
+
+#include <math/matrix.hpp>
+#include <math/parallel.hpp>
+
+#include <span>
+#include <type_traits>
+
+namespace math
+{
+	// MATRIX VIEW
+	// Non-owning column-major block, element (row, col) at data[col * stride + row] as in
+	// Matrix::operator(). A view of a Matrix<R, C, T> or of a block of a DynMatrix feeds
+	// Gemm and Gemv without copying. MatrixView<const T> is read-only.
+
+	template<typename T>
+	class MatrixView
+	{
+	public:
+		using value_type = std::remove_const_t<T>;
+
+		constexpr MatrixView() = default;
+		constexpr MatrixView(T* data, size_t rows, size_t cols, size_t stride) : data(data), rowCount(rows), colCount(cols), stride(stride) { assert(stride >= rows); }
+		constexpr MatrixView(T* data, size_t rows, size_t cols) : MatrixView(data, rows, cols, rows) {}
+
+		template<size_t R, size_t C>
+		constexpr MatrixView(Matrix<R, C, value_type>& m) : MatrixView(m.Data(), R, C) {}
+
+		template<size_t R, size_t C> requires std::is_const_v<T>
+		constexpr MatrixView(const Matrix<R, C, value_type>& m) : MatrixView(m.Data(), R, C) {}
+
+		template<typename U> requires (std::is_const_v<T> && std::is_same_v<U, value_type>)
+		constexpr MatrixView(const MatrixView<U>& other) : MatrixView(other.Data(), other.Rows(), other.Cols(), other.Stride()) {}
+
+		constexpr size_t Rows() const { return rowCount; }
+		constexpr size_t Cols() const { return colCount; }
+		constexpr size_t Stride() const { return stride; }
+		constexpr T* Data() const { return data; }
+		constexpr T* Column(size_t col) const { return data + col * stride; }
+
+		constexpr T& operator()(size_t row, size_t col) const
+		{
+			assert(row < rowCount && col < colCount);
+			return data[col * stride + row];
+		}
+
+		constexpr MatrixView Block(size_t row, size_t col, size_t rows, size_t cols) const
+		{
+			assert(row + rows <= rowCount && col + cols <= colCount);
+			return MatrixView(data + col * stride + row, rows, cols, stride);
+		}
+
+	private:
+		T* data = nullptr;
+		size_t rowCount = 0;
+		size_t colCount = 0;
+		size_t stride = 0;
+	};
+
+	template<size_t R, size_t C, typename T>
+	MatrixView(Matrix<R, C, T>&) -> MatrixView<T>;
+
+	template<size_t R, size_t C, typename T>
+	MatrixView(const Matrix<R, C, T>&) -> MatrixView<const T>;
+
+	// DYNAMIC MATRIX
+	// Run-time sized, column-major like Matrix, in one simd::ALIGNMENT-aligned allocation.
+	// New elements are zero.
+
+	template<typename T>
+	class DynMatrix
+	{
+	public:
+		using value_type = T;
+
+		DynMatrix() = default;
+		DynMatrix(size_t rows, size_t cols) : values(rows * cols), rowCount(rows), colCount(cols) {}
+		DynMatrix(size_t rows, size_t cols, T value) : values(rows * cols, value), rowCount(rows), colCount(cols) {}
+
+		template<size_t R, size_t C>
+		explicit DynMatrix(const Matrix<R, C, T>& m) : values(m.Data(), m.Data() + R * C), rowCount(R), colCount(C) {}
+
+		static DynMatrix Identity(size_t n)
+		{
+			DynMatrix result(n, n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				result(i, i) = T(1);
+			}
+			return result;
+		}
+
+		size_t Rows() const { return rowCount; }
+		size_t Cols() const { return colCount; }
+
+		T operator()(size_t row, size_t col) const
+		{
+			assert(row < rowCount && col < colCount);
+			return values[col * rowCount + row];
+		}
+
+		T& operator()(size_t row, size_t col)
+		{
+			assert(row < rowCount && col < colCount);
+			return values[col * rowCount + row];
+		}
+
+		const T* Data() const { return values.data(); }
+		T* Data() { return values.data(); }
+
+		// Contents are not kept.
+		void Resize(size_t rows, size_t cols)
+		{
+			values.assign(rows * cols, T(0));
+			rowCount = rows;
+			colCount = cols;
+		}
+
+		MatrixView<T> View() { return MatrixView<T>(values.data(), rowCount, colCount); }
+		MatrixView<const T> View() const { return MatrixView<const T>(values.data(), rowCount, colCount); }
+
+		MatrixView<T> Block(size_t row, size_t col, size_t rows, size_t cols) { return View().Block(row, col, rows, cols); }
+		MatrixView<const T> Block(size_t row, size_t col, size_t rows, size_t cols) const { return View().Block(row, col, rows, cols); }
+
+		operator MatrixView<T>() { return View(); }
+		operator MatrixView<const T>() const { return View(); }
+
+	private:
+		simd::AlignedVector<T> values;
+		size_t rowCount = 0;
+		size_t colCount = 0;
+	};
+
+	// GEMM
+	// Blocked as in Goto and van de Geijn: for each GEMM_KC slice of the depth, A is packed
+	// into panels of 2 * W rows and B into panels of GEMM_NR columns, W the simd::Dispatch
+	// width. GEMM_MC x GEMM_NC tiles of C are the ParallelFor tasks; within a tile a
+	// 2W x GEMM_NR block of C stays in registers for the whole slice. float64 runs the
+	// same blocking at width 1.
+
+	namespace detail
+	{
+		// An MC x KC block of packed A fits in L2, a KC x NR panel of packed B in L1.
+		constexpr size_t GEMM_KC = 256;
+		constexpr size_t GEMM_MC = 128;
+		constexpr size_t GEMM_NR = 6;
+		constexpr size_t GEMM_NC = 84 * GEMM_NR;
+
+		// Tiles start on panel boundaries, for panels of up to 2 x 16 rows.
+		static_assert(GEMM_MC % 32 == 0 && GEMM_NC % GEMM_NR == 0);
+
+		// Panels per ParallelFor chunk when packing.
+		constexpr size_t GEMM_PACK_GRAIN = 16;
+
+		// Elements per ParallelFor chunk in the element-wise passes.
+		constexpr size_t GEMM_SCALE_GRAIN = 16384;
+
+		template<typename T>
+		size_t GemmPanelRows()
+		{
+			size_t rows = 0;
+			simd::Dispatch<T>([&]<size_t W>() { rows = 2 * W; });
+			return rows;
+		}
+
+		// Panel p holds a(p * mr + i, depth + k) at p * mr * kc + k * mr + i, zero-padded.
+		template<typename T>
+		void PackA(MatrixView<const T> a, size_t depth, size_t kc, size_t mr, T* packed)
+		{
+			const size_t panels = (a.Rows() + mr - 1) / mr;
+			ParallelFor(panels, GEMM_PACK_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t p = begin; p < end; ++p)
+				{
+					const size_t rows = Min(mr, a.Rows() - p * mr);
+					T* panel = packed + p * mr * kc;
+					for (size_t k = 0; k < kc; ++k)
+					{
+						const T* column = a.Column(depth + k) + p * mr;
+						std::copy(column, column + rows, panel + k * mr);
+						std::fill(panel + k * mr + rows, panel + (k + 1) * mr, T(0));
+					}
+				}
+			});
+		}
+
+		// Panel q holds b(depth + k, q * NR + j) at q * NR * kc + k * NR + j, zero-padded.
+		template<typename T>
+		void PackB(MatrixView<const T> b, size_t depth, size_t kc, T* packed)
+		{
+			const size_t panels = (b.Cols() + GEMM_NR - 1) / GEMM_NR;
+			ParallelFor(panels, GEMM_PACK_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t q = begin; q < end; ++q)
+				{
+					const size_t cols = Min(GEMM_NR, b.Cols() - q * GEMM_NR);
+					T* panel = packed + q * GEMM_NR * kc;
+					for (size_t j = 0; j < GEMM_NR; ++j)
+					{
+						const T* column = j < cols ? b.Column(q * GEMM_NR + j) + depth : nullptr;
+						for (size_t k = 0; k < kc; ++k)
+						{
+							panel[k * GEMM_NR + j] = column ? column[k] : T(0);
+						}
+					}
+				}
+			});
+		}
+
+		// c[0, rows) x [0, cols) += alpha * (packed A panel * packed B panel).
+		template<size_t W, typename T>
+		void GemmMicroKernel(const T* a, const T* b, size_t kc, T* c, size_t stride, size_t rows, size_t cols, T alpha)
+		{
+			using PackType = simd::Pack<T, W>;
+
+			PackType sum[GEMM_NR][2];
+			for (size_t j = 0; j < GEMM_NR; ++j)
+			{
+				sum[j][0] = PackType::Zero();
+				sum[j][1] = PackType::Zero();
+			}
+
+			for (size_t k = 0; k < kc; ++k)
+			{
+				const PackType a0 = PackType::Load(a + k * 2 * W);
+				const PackType a1 = PackType::Load(a + k * 2 * W + W);
+				for (size_t j = 0; j < GEMM_NR; ++j)
+				{
+					const PackType bj = PackType::Broadcast(b[k * GEMM_NR + j]);
+					sum[j][0] = MulAdd(a0, bj, sum[j][0]);
+					sum[j][1] = MulAdd(a1, bj, sum[j][1]);
+				}
+			}
+
+			const PackType scale = PackType::Broadcast(alpha);
+			for (size_t j = 0; j < cols; ++j)
+			{
+				T* column = c + j * stride;
+				if (rows == 2 * W)
+				{
+					MulAdd(sum[j][0], scale, PackType::Load(column)).Store(column);
+					MulAdd(sum[j][1], scale, PackType::Load(column + W)).Store(column + W);
+				}
+				else
+				{
+					const size_t low = Min(rows, W);
+					MulAdd(sum[j][0], scale, PackType::LoadPartial(column, low)).StorePartial(column, low);
+					if (rows > W)
+					{
+						MulAdd(sum[j][1], scale, PackType::LoadPartial(column + W, rows - W)).StorePartial(column + W, rows - W);
+					}
+				}
+			}
+		}
+
+		// c = beta * c; zero beta clears c, NaNs included.
+		template<typename T>
+		void ScaleColumns(MatrixView<T> c, T beta)
+		{
+			if (beta == T(1))
+			{
+				return;
+			}
+			ParallelFor(c.Cols(), Max<size_t>(1, GEMM_SCALE_GRAIN / Max<size_t>(c.Rows(), 1)), [&](size_t begin, size_t end)
+			{
+				for (size_t j = begin; j < end; ++j)
+				{
+					T* column = c.Column(j);
+					for (size_t i = 0; i < c.Rows(); ++i)
+					{
+						column[i] = beta == T(0) ? T(0) : column[i] * beta;
+					}
+				}
+			});
+		}
+	}
+
+	// c = alpha * a * b + beta * c. T is deduced from c; Gemm<T>(a, b, c) also takes
+	// DynMatrix and Matrix arguments directly. c must not overlap a or b.
+	template<typename T>
+	void Gemm(std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<MatrixView<const T>> b, MatrixView<T> c, std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0))
+	{
+		assert(a.Rows() == c.Rows() && b.Cols() == c.Cols() && a.Cols() == b.Rows());
+
+		detail::ScaleColumns(c, beta);
+		const size_t m = c.Rows(), n = c.Cols(), depth = a.Cols();
+		if (m == 0 || n == 0 || depth == 0 || alpha == T(0))
+		{
+			return;
+		}
+
+		const size_t mr = detail::GemmPanelRows<T>();
+		const size_t kcMax = Min(depth, detail::GEMM_KC);
+		simd::AlignedVector<T> packedA(((m + mr - 1) / mr) * mr * kcMax);
+		simd::AlignedVector<T> packedB(((n + detail::GEMM_NR - 1) / detail::GEMM_NR) * detail::GEMM_NR * kcMax);
+
+		const size_t rowTiles = (m + detail::GEMM_MC - 1) / detail::GEMM_MC;
+		const size_t colTiles = (n + detail::GEMM_NC - 1) / detail::GEMM_NC;
+		for (size_t p = 0; p < depth; p += detail::GEMM_KC)
+		{
+			const size_t kc = Min(detail::GEMM_KC, depth - p);
+			detail::PackA(a, p, kc, mr, packedA.data());
+			detail::PackB(b, p, kc, packedB.data());
+
+			// Tiles of one column block are adjacent and share their panels of B.
+			ParallelFor(rowTiles * colTiles, 1, [&](size_t begin, size_t end)
+			{
+				simd::Dispatch<T>([&]<size_t W>()
+				{
+					assert(2 * W == mr);
+					for (size_t tile = begin; tile < end; ++tile)
+					{
+						const size_t rowBegin = (tile % rowTiles) * detail::GEMM_MC;
+						const size_t colBegin = (tile / rowTiles) * detail::GEMM_NC;
+						for (size_t j = colBegin; j < Min(n, colBegin + detail::GEMM_NC); j += detail::GEMM_NR)
+						{
+							const T* panelB = packedB.data() + (j / detail::GEMM_NR) * detail::GEMM_NR * kc;
+							for (size_t i = rowBegin; i < Min(m, rowBegin + detail::GEMM_MC); i += 2 * W)
+							{
+								detail::GemmMicroKernel<W>(packedA.data() + (i / mr) * mr * kc, panelB, kc, &c(i, j), c.Stride(),
+									Min(2 * W, m - i), Min(detail::GEMM_NR, n - j), T(alpha));
+							}
+						}
+					}
+				});
+			});
+		}
+	}
+
+	// GEMV
+	// y = alpha * a * x + beta * y, on ParallelFor over blocks of rows. Each block streams
+	// the columns of a four at a time into an accumulator that stays in L1.
+
+	namespace detail
+	{
+		constexpr size_t GEMV_ROWS = 256;
+	}
+
+	template<typename T>
+	void Gemv(std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<std::span<const T>> x, std::span<T> y, std::type_identity_t<T> alpha = T(1), std::type_identity_t<T> beta = T(0))
+	{
+		assert(x.size() == a.Cols() && y.size() == a.Rows());
+
+		const size_t n = a.Cols();
+		ParallelFor(a.Rows(), detail::GEMV_ROWS, [&](size_t begin, size_t end)
+		{
+			simd::Dispatch<T>([&]<size_t W>()
+			{
+				using PackType = simd::Pack<T, W>;
+				auto load = [](const T* src, size_t lanes) { return lanes == W ? PackType::Load(src) : PackType::LoadPartial(src, lanes); };
+
+				for (size_t block = begin; block < end; block += detail::GEMV_ROWS)
+				{
+					const size_t rows = Min(detail::GEMV_ROWS, end - block);
+					alignas(simd::ALIGNMENT) T sum[detail::GEMV_ROWS];
+					std::fill(sum, sum + rows, T(0));
+
+					size_t j = 0;
+					for (; j + 4 <= n; j += 4)
+					{
+						const PackType x0 = PackType::Broadcast(x[j]), x1 = PackType::Broadcast(x[j + 1]);
+						const PackType x2 = PackType::Broadcast(x[j + 2]), x3 = PackType::Broadcast(x[j + 3]);
+						const T* a0 = a.Column(j) + block;
+						const T* a1 = a.Column(j + 1) + block;
+						const T* a2 = a.Column(j + 2) + block;
+						const T* a3 = a.Column(j + 3) + block;
+						simd::ForEachPack<T, W>(rows, [&](size_t i, size_t lanes)
+						{
+							PackType s = load(sum + i, lanes);
+							s = MulAdd(load(a0 + i, lanes), x0, s);
+							s = MulAdd(load(a1 + i, lanes), x1, s);
+							s = MulAdd(load(a2 + i, lanes), x2, s);
+							s = MulAdd(load(a3 + i, lanes), x3, s);
+							s.StorePartial(sum + i, lanes);
+						});
+					}
+					for (; j < n; ++j)
+					{
+						const PackType xj = PackType::Broadcast(x[j]);
+						const T* aj = a.Column(j) + block;
+						simd::ForEachPack<T, W>(rows, [&](size_t i, size_t lanes)
+						{
+							MulAdd(load(aj + i, lanes), xj, load(sum + i, lanes)).StorePartial(sum + i, lanes);
+						});
+					}
+
+					for (size_t i = 0; i < rows; ++i)
+					{
+						y[block + i] = alpha * sum[i] + (beta == T(0) ? T(0) : beta * y[block + i]);
+					}
+				}
+			});
+		});
+	}
+
+	template<typename T>
+	DynMatrix<T> operator*(const DynMatrix<T>& a, const DynMatrix<T>& b)
+	{
+		DynMatrix<T> result(a.Rows(), b.Cols());
+		Gemm<T>(a, b, result);
+		return result;
+	}
+}
+
+#endif // MATHLIB_DYNMATRIX_HPP
@@ -0,0 +1,423 @@
+#ifndef MATHLIB_EXPRESSION_HPP
+#define MATHLIB_EXPRESSION_HPP
+#pragma once
+
+#include <math/matrix.hpp>
+
+#include <utility>
+
+// EXPRESSION TEMPLATES
+// Opt-in: wrap one operand in Lazy() and the whole chain is kept as a tree, then
+// evaluated in one pass (one loop, or one register per pack) when it is assigned to a
+// Vec / Matrix or Eval() is called. Matrix products stay lazy until they meet a vector,
+// so Lazy(proj) * view * model * v runs as proj * (view * (model * v)).
+// Nodes reference their Vec / Matrix operands: evaluate within the full expression.
+
+namespace math::expr
+{
+	// RESULT TRAITS
+
+	template<typename V>
+	struct Traits
+	{
+		static constexpr bool operand = false;
+	};
+
+	template<size_t N, typename T>
+	struct Traits<Vec<N, T>>
+	{
+		static constexpr bool operand = true;
+		static constexpr bool matrix = false;
+		static constexpr size_t size = N;
+		using value_type = T;
+	};
+
+	template<size_t R, size_t C, typename T>
+	struct Traits<Matrix<R, C, T>>
+	{
+		static constexpr bool operand = true;
+		static constexpr bool matrix = true;
+		static constexpr size_t size = R * C;
+		using value_type = T;
+	};
+
+	template<typename E>
+	concept Expression = requires { typename E::result_type; E::is_expression; };
+
+	template<typename X>
+	concept Value = Traits<X>::operand;
+
+	template<typename X>
+	struct ResultOf
+	{
+		using type = X;
+	};
+
+	template<Expression E>
+	struct ResultOf<E>
+	{
+		using type = typename E::result_type;
+	};
+
+	template<typename X>
+	using Result = typename ResultOf<std::remove_cvref_t<X>>::type;
+
+	template<typename X>
+	concept VecOperand = (Expression<std::remove_cvref_t<X>> || Value<std::remove_cvref_t<X>>) && !Traits<Result<X>>::matrix;
+
+	template<typename X>
+	concept MatrixOperand = (Expression<std::remove_cvref_t<X>> || Value<std::remove_cvref_t<X>>) && Traits<Result<X>>::matrix;
+
+	template<typename A, typename B>
+	concept AnyExpression = Expression<std::remove_cvref_t<A>> || Expression<std::remove_cvref_t<B>>;
+
+	// Packs used to evaluate a result of Size elements, scalar when there is no SIMD for T.
+	template<typename T, size_t Size>
+	using EvalPack = simd::Pack<T, (Size <= 4 ? 4 : simd::NativeWidth<T>)>;
+
+	template<typename T>
+	constexpr bool Vectorized = simd::NativeWidth<T> > 1;
+
+	// LEAVES
+
+	template<typename V>
+	struct Ref
+	{
+		static constexpr bool is_expression = true;
+		using result_type = V;
+		using value_type = typename Traits<V>::value_type;
+
+		const V& operand;
+
+		constexpr value_type Get(size_t i) const { return operand.Data()[i]; }
+
+		template<typename P>
+		P Load(size_t i, size_t lanes) const { return P::LoadPartial(operand.Data() + i, lanes); }
+	};
+
+	// Owns an evaluated result, e.g. a matrix product used elementwise.
+	template<typename V>
+	struct Held
+	{
+		static constexpr bool is_expression = true;
+		using result_type = V;
+		using value_type = typename Traits<V>::value_type;
+
+		V operand;
+
+		constexpr value_type Get(size_t i) const { return operand.Data()[i]; }
+
+		template<typename P>
+		P Load(size_t i, size_t lanes) const { return P::LoadPartial(operand.Data() + i, lanes); }
+	};
+
+	template<typename T>
+	struct Scalar
+	{
+		T value;
+
+		constexpr T Get(size_t) const { return value; }
+
+		template<typename P>
+		P Load(size_t, size_t) const { return P::Broadcast(value); }
+	};
+
+	// EVALUATION
+
+	template<typename E>
+	constexpr typename E::result_type Evaluate(const E& e)
+	{
+		using V = typename E::result_type;
+		using T = typename Traits<V>::value_type;
+		constexpr size_t size = Traits<V>::size;
+
+		V result;
+
+		if constexpr (Vectorized<T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				using P = EvalPack<T, size>;
+				for (size_t i = 0; i < size; i += P::width)
+				{
+					size_t lanes = Min(P::width, size - i);
+					e.template Load<P>(i, lanes).StorePartial(result.Data() + i, lanes);
+				}
+				return result;
+			}
+		}
+
+		if constexpr (size <= 4)
+		{
+			[&]<size_t... I>(std::index_sequence<I...>)
+			{
+				((result.Data()[I] = e.Get(I)), ...);
+			}(std::make_index_sequence<size>());
+		}
+		else
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				result.Data()[i] = e.Get(i);
+			}
+		}
+		return result;
+	}
+
+	template<typename V>
+	constexpr const V& Evaluate(const Ref<V>& e)
+	{
+		return e.operand;
+	}
+
+	template<typename V>
+	constexpr const V& Evaluate(const Held<V>& e)
+	{
+		return e.operand;
+	}
+
+	// ELEMENTWISE NODES
+
+	struct Add { template<typename A> static constexpr A Apply(const A& a, const A& b) { return a + b; } };
+	struct Sub { template<typename A> static constexpr A Apply(const A& a, const A& b) { return a - b; } };
+	struct Mul { template<typename A> static constexpr A Apply(const A& a, const A& b) { return a * b; } };
+	struct Div { template<typename A> static constexpr A Apply(const A& a, const A& b) { return a / b; } };
+
+	template<typename L, typename R>
+	struct ResultOfPair
+	{
+		using type = typename L::result_type;
+	};
+
+	template<typename T, typename R>
+	struct ResultOfPair<Scalar<T>, R>
+	{
+		using type = typename R::result_type;
+	};
+
+	template<typename Op, typename L, typename R>
+	struct Binary
+	{
+		static constexpr bool is_expression = true;
+		using result_type = typename ResultOfPair<L, R>::type;
+		using value_type = typename Traits<result_type>::value_type;
+
+		L left;
+		R right;
+
+		constexpr value_type Get(size_t i) const { return Op::Apply(left.Get(i), right.Get(i)); }
+
+		template<typename P>
+		P Load(size_t i, size_t lanes) const { return Op::Apply(left.template Load<P>(i, lanes), right.template Load<P>(i, lanes)); }
+
+		constexpr result_type Eval() const { return Evaluate(*this); }
+		constexpr operator result_type() const { return Evaluate(*this); }
+	};
+
+	template<typename E>
+	struct Negate
+	{
+		static constexpr bool is_expression = true;
+		using result_type = typename E::result_type;
+		using value_type = typename Traits<result_type>::value_type;
+
+		E operand;
+
+		constexpr value_type Get(size_t i) const { return -operand.Get(i); }
+
+		template<typename P>
+		P Load(size_t i, size_t lanes) const { return -operand.template Load<P>(i, lanes); }
+
+		constexpr result_type Eval() const { return Evaluate(*this); }
+		constexpr operator result_type() const { return Evaluate(*this); }
+	};
+
+	// MATRIX PRODUCT
+
+	template<typename L, typename R>
+	struct Product;
+
+	template<typename E>
+	constexpr bool IsProduct = false;
+
+	template<typename L, typename R>
+	constexpr bool IsProduct<Product<L, R>> = true;
+
+	// node * v, innermost product first.
+	template<typename E, size_t N, typename T>
+	constexpr auto ApplyTo(const E& node, const Vec<N, T>& v)
+	{
+		if constexpr (IsProduct<E>)
+		{
+			return ApplyTo(node.left, ApplyTo(node.right, v));
+		}
+		else
+		{
+			return Evaluate(node) * v;
+		}
+	}
+
+	template<typename L, typename R>
+	struct Product
+	{
+		static constexpr bool is_expression = true;
+		using value_type = typename L::result_type::value_type;
+		using result_type = Matrix<L::result_type::rows, R::result_type::cols, value_type>;
+
+		L left;
+		R right;
+
+		constexpr result_type Eval() const { return Evaluate(left) * Evaluate(right); }
+		constexpr operator result_type() const { return Eval(); }
+	};
+
+	template<typename L, typename R>
+	constexpr typename Product<L, R>::result_type Evaluate(const Product<L, R>& e)
+	{
+		return e.Eval();
+	}
+
+	// OPERAND WRAPPING
+
+	template<typename X>
+	constexpr auto Wrap(const X& x)
+	{
+		if constexpr (IsProduct<X>)
+		{
+			return Held<typename X::result_type>{ x.Eval() };
+		}
+		else if constexpr (Expression<X>)
+		{
+			return x;
+		}
+		else
+		{
+			return Ref<X>{ x };
+		}
+	}
+
+	template<typename X>
+	constexpr auto WrapMatrix(const X& x)
+	{
+		if constexpr (Expression<X>)
+		{
+			return x;
+		}
+		else
+		{
+			return Ref<X>{ x };
+		}
+	}
+
+	template<typename Op, typename A, typename B>
+	constexpr auto MakeBinary(const A& a, const B& b)
+	{
+		using WA = decltype(Wrap(a));
+		using WB = decltype(Wrap(b));
+		static_assert(std::is_same_v<typename WA::result_type, typename WB::result_type>, "Operand shapes differ");
+		return Binary<Op, WA, WB>{ Wrap(a), Wrap(b) };
+	}
+
+	template<typename Op, typename A, typename T>
+	constexpr auto MakeScalarRight(const A& a, T s)
+	{
+		using WA = decltype(Wrap(a));
+		return Binary<Op, WA, Scalar<typename WA::value_type>>{ Wrap(a), { static_cast<typename WA::value_type>(s) } };
+	}
+
+	template<typename Op, typename T, typename B>
+	constexpr auto MakeScalarLeft(T s, const B& b)
+	{
+		using WB = decltype(Wrap(b));
+		return Binary<Op, Scalar<typename WB::value_type>, WB>{ { static_cast<typename WB::value_type>(s) }, Wrap(b) };
+	}
+
+	// OPERATORS
+
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && ((VecOperand<A> && VecOperand<B>) || (MatrixOperand<A> && MatrixOperand<B>))
+	constexpr auto operator+(const A& a, const B& b) { return MakeBinary<Add>(a, b); }
+
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && ((VecOperand<A> && VecOperand<B>) || (MatrixOperand<A> && MatrixOperand<B>))
+	constexpr auto operator-(const A& a, const B& b) { return MakeBinary<Sub>(a, b); }
+
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && VecOperand<A> && VecOperand<B>
+	constexpr auto operator*(const A& a, const B& b) { return MakeBinary<Mul>(a, b); }
+
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && VecOperand<A> && VecOperand<B>
+	constexpr auto operator/(const A& a, const B& b) { return MakeBinary<Div>(a, b); }
+
+	template<Expression A, typename T>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator+(const A& a, T s) { return MakeScalarRight<Add>(a, s); }
+
+	template<Expression A, typename T>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator-(const A& a, T s) { return MakeScalarRight<Sub>(a, s); }
+
+	template<Expression A, typename T>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator*(const A& a, T s) { return MakeScalarRight<Mul>(a, s); }
+
+	template<Expression A, typename T>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator/(const A& a, T s) { return MakeScalarRight<Div>(a, s); }
+
+	template<typename T, Expression B>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator+(T s, const B& b) { return MakeScalarLeft<Add>(s, b); }
+
+	template<typename T, Expression B>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator-(T s, const B& b) { return MakeScalarLeft<Sub>(s, b); }
+
+	template<typename T, Expression B>
+		requires std::is_arithmetic_v<T>
+	constexpr auto operator*(T s, const B& b) { return MakeScalarLeft<Mul>(s, b); }
+
+	template<Expression A>
+	constexpr auto operator-(const A& a)
+	{
+		using WA = decltype(Wrap(a));
+		return Negate<WA>{ Wrap(a) };
+	}
+
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && MatrixOperand<A> && MatrixOperand<B>
+	constexpr auto operator*(const A& a, const B& b)
+	{
+		using WA = decltype(WrapMatrix(a));
+		using WB = decltype(WrapMatrix(b));
+		static_assert(WA::result_type::cols == WB::result_type::rows, "Inner dimensions differ");
+		return Product<WA, WB>{ WrapMatrix(a), WrapMatrix(b) };
+	}
+
+	// Matrix chain times vector: evaluated right to left, one matrix-vector product per factor.
+	template<typename A, typename B>
+		requires AnyExpression<A, B> && MatrixOperand<A> && VecOperand<B>
+	constexpr auto operator*(const A& a, const B& b)
+	{
+		const auto& v = Evaluate(Wrap(b));
+		return ApplyTo(WrapMatrix(a), v);
+	}
+}
+
+namespace math
+{
+	template<size_t N, typename T>
+	constexpr expr::Ref<Vec<N, T>> Lazy(const Vec<N, T>& v)
+	{
+		return { v };
+	}
+
+	template<size_t R, size_t C, typename T>
+	constexpr expr::Ref<Matrix<R, C, T>> Lazy(const Matrix<R, C, T>& m)
+	{
+		return { m };
+	}
+}
+
+#endif // MATHLIB_EXPRESSION_HPP
@@ -0,0 +1,389 @@
+#ifndef MATHLIB_FAST_HPP
+#define MATHLIB_FAST_HPP
+#pragma once
+
+#include <math/vector.hpp>
+
+#include <bit>
+#include <span>
+
+namespace math::fast
+{
+	// FAST TRIGONOMETRY
+	// float32 Sin, Cos, SinCos, Tan, Asin, Acos and Atan2 for scalars, simd::Pack lanes,
+	// Vec<N, float32> and spans. Periodic functions reduce x by pi/2 in four parts and
+	// expect |x| < 8192; Exact forwards to the std:: functions.
+	//
+	// Max error measured against float64 std:: functions, over |x| < 8192 for the periodic
+	// functions and the whole domain for the others:
+	//               Accurate     Fast
+	//   Sin, Cos    2.5 ulp      2e-6 relative (27 ulp)
+	//   Tan         4 ulp        2.5e-6 relative
+	//   Asin        2.5 ulp      same as Accurate
+	//   Acos        1.5 ulp      4e-5 absolute
+	//   Atan2       3.5 ulp      3.1e-5 relative
+	// Scalars are constexpr at every tier.
+
+	template<typename V>
+	concept Lane = std::is_same_v<V, float32> || (requires { V::width; } && std::is_same_v<typename V::value_type, float32>);
+
+	namespace detail
+	{
+		// LANE HELPERS
+		// Same spelling for float32 and simd::Pack<float32, W>.
+
+		template<Lane V>
+		constexpr V Splat(float32 value)
+		{
+			if constexpr (std::is_same_v<V, float32>) return value;
+			else return V::Broadcast(value);
+		}
+
+		constexpr float32 Select(bool m, float32 a, float32 b) { return m ? a : b; }
+		constexpr float32 MulAdd(float32 a, float32 b, float32 c) { return a * b + c; }
+		constexpr float32 Abs(float32 x) { return Absolute(x); }
+		constexpr float32 Min(float32 a, float32 b) { return math::Min(a, b); }
+		constexpr float32 Max(float32 a, float32 b) { return math::Max(a, b); }
+		constexpr float32 Sqrt(float32 x) { return math::Sqrt(x); }
+
+		// Round to nearest for |x| < 2^22, pure float arithmetic so it also runs in packs
+		// and constant expressions.
+		template<Lane V>
+		constexpr V Round(const V& x)
+		{
+			const V magic = Splat<V>(12582912.0f);
+			return (x + magic) - magic;
+		}
+
+		// x = k * pi/2 + r with |r| <= pi/4; quadrant is k mod 4 as a float in [0, 3].
+		// pi/2 is split in four parts, the first three with 11 bits or less so k * part is
+		// exact for |k| < 2^13.
+		template<Lane V>
+		constexpr V Reduce(const V& x, V& quadrant)
+		{
+			const V k = Round(x * Splat<V>(0.636619772f));
+			V r = x - k * Splat<V>(1.5703125f);
+			r = r - k * Splat<V>(4.837512969970703e-4f);
+			r = r - k * Splat<V>(7.549533620476723e-8f);
+			r = r - k * Splat<V>(2.5633440682570896e-12f);
+
+			quadrant = k - Round(k * Splat<V>(0.25f) - Splat<V>(0.375f)) * Splat<V>(4.0f);
+			return r;
+		}
+
+		// sin(r) and cos(r) for |r| <= pi/4.
+		template<Lane V>
+		constexpr void SinCosPoly(const V& r, V& s, V& c, TrigPrecision precision)
+		{
+			const V z = r * r;
+			if (precision == TrigPrecision::Fast)
+			{
+				s = MulAdd(MulAdd(Splat<V>(8.16337119e-3f), z, Splat<V>(-1.66633939e-1f)) * z, r, r);
+				c = MulAdd(MulAdd(Splat<V>(-1.36525761e-3f), z, Splat<V>(4.16612845e-2f)) * z, z, MulAdd(Splat<V>(-0.5f), z, Splat<V>(1.0f)));
+				return;
+			}
+
+			V ps = MulAdd(MulAdd(Splat<V>(-1.9515295891e-4f), z, Splat<V>(8.3321608736e-3f)), z, Splat<V>(-1.6666654611e-1f));
+			s = MulAdd(ps * z, r, r);
+
+			V pc = MulAdd(MulAdd(Splat<V>(2.443315711809948e-5f), z, Splat<V>(-1.388731625493765e-3f)), z, Splat<V>(4.166664568298827e-2f));
+			c = MulAdd(pc * z, z, MulAdd(Splat<V>(-0.5f), z, Splat<V>(1.0f)));
+		}
+
+		// asin(s) for s in [0, 0.5], z = s * s.
+		template<Lane V>
+		constexpr V AsinPoly(const V& s, const V& z)
+		{
+			V p = MulAdd(MulAdd(MulAdd(MulAdd(Splat<V>(4.2163199048e-2f), z, Splat<V>(2.4181311049e-2f)), z, Splat<V>(4.5470025998e-2f)), z, Splat<V>(7.4953002686e-2f)), z, Splat<V>(1.6666752422e-1f));
+			return MulAdd(s * z, p, s);
+		}
+
+		// atan(t) for t in [0, 1].
+		template<Lane V>
+		constexpr V AtanUnit(const V& t, TrigPrecision precision)
+		{
+			if (precision == TrigPrecision::Fast)
+			{
+				const V z = t * t;
+				V p = MulAdd(MulAdd(MulAdd(MulAdd(Splat<V>(2.38767093e-2f), z, Splat<V>(-9.19497722e-2f)), z, Splat<V>(1.85228039e-1f)), z, Splat<V>(-3.31702886e-1f)), z, Splat<V>(9.99970084e-1f));
+				return t * p;
+			}
+
+			// t > tan(pi/8): atan(t) = pi/4 + atan((t - 1) / (t + 1)).
+			const auto upper = t > Splat<V>(0.414213562f);
+			const V x = Select(upper, (t - Splat<V>(1.0f)) / (t + Splat<V>(1.0f)), t);
+			const V z = x * x;
+			V p = MulAdd(MulAdd(MulAdd(Splat<V>(8.05374449538e-2f), z, Splat<V>(-1.38776856032e-1f)), z, Splat<V>(1.99777106478e-1f)), z, Splat<V>(-3.33329491539e-1f));
+			return MulAdd(p * z, x, x) + Select(upper, Splat<V>(0.785398163f), Splat<V>(0.0f));
+		}
+
+		// sin, cos and tan of x from the shared reduction.
+		template<Lane V>
+		constexpr void SinCosLanes(const V& x, V& s, V& c, TrigPrecision precision)
+		{
+			V quadrant;
+			V ps, pc;
+			SinCosPoly(Reduce(x, quadrant), ps, pc, precision);
+
+			// Quadrants 1 and 3 swap sin and cos; sin is negated in 2, 3 and cos in 1, 2.
+			const auto odd = (quadrant == Splat<V>(1.0f)) | (quadrant == Splat<V>(3.0f));
+			const V sinBase = Select(odd, pc, ps);
+			const V cosBase = Select(odd, ps, pc);
+			s = Select(quadrant >= Splat<V>(2.0f), -sinBase, sinBase);
+			c = Select((quadrant == Splat<V>(1.0f)) | (quadrant == Splat<V>(2.0f)), -cosBase, cosBase);
+		}
+
+		template<Lane V>
+		constexpr V TanLanes(const V& x, TrigPrecision precision)
+		{
+			V quadrant;
+			V ps, pc;
+			SinCosPoly(Reduce(x, quadrant), ps, pc, precision);
+
+			// Odd quadrants: tan(r + pi/2) = -cos(r) / sin(r).
+			const auto odd = (quadrant == Splat<V>(1.0f)) | (quadrant == Splat<V>(3.0f));
+			return Select(odd, -pc, ps) / Select(odd, ps, pc);
+		}
+
+		// Both tiers: pi/2 - acos loses the relative accuracy near 0.
+		template<Lane V>
+		constexpr V AsinLanes(const V& x)
+		{
+			// |x| > 0.5: asin(|x|) = pi/2 - 2 asin(sqrt((1 - |x|) / 2)).
+			const V a = Abs(x);
+			const auto large = a > Splat<V>(0.5f);
+			const V z = Select(large, Splat<V>(0.5f) * (Splat<V>(1.0f) - a), a * a);
+			const V p = AsinPoly(Select(large, Sqrt(z), a), z);
+			const V result = Select(large, Splat<V>(1.57079633f) - (p + p), p);
+			return Select(x < Splat<V>(0.0f), -result, result);
+		}
+
+		template<Lane V>
+		constexpr V AcosLanes(const V& x, TrigPrecision precision)
+		{
+			const V a = Abs(x);
+			const auto negative = x < Splat<V>(0.0f);
+			const V pi = Splat<V>(3.14159265f);
+
+			if (precision == TrigPrecision::Fast)
+			{
+				// acos(|x|) = sqrt(1 - |x|) * P(|x|)
+				V p = MulAdd(MulAdd(MulAdd(Splat<V>(-2.08862861e-2f), a, Splat<V>(7.68889436e-2f)), a, Splat<V>(-2.12871774e-1f)), a, Splat<V>(1.57075802f));
+				const V result = Sqrt(Max(Splat<V>(1.0f) - a, Splat<V>(0.0f))) * p;
+				return Select(negative, pi - result, result);
+			}
+
+			// |x| > 0.5: acos(|x|) = 2 asin(sqrt((1 - |x|) / 2)), else pi/2 - asin(x).
+			const auto large = a > Splat<V>(0.5f);
+			const V z = Select(large, Splat<V>(0.5f) * (Splat<V>(1.0f) - a), a * a);
+			const V p = AsinPoly(Select(large, Sqrt(z), a), z);
+
+			const V twice = p + p;
+			const V largeResult = Select(negative, pi - twice, twice);
+			const V smallResult = Splat<V>(1.57079633f) - Select(negative, -p, p);
+			return Select(large, largeResult, smallResult);
+		}
+
+		template<Lane V>
+		constexpr V Atan2Lanes(const V& y, const V& x, TrigPrecision precision)
+		{
+			const V ax = Abs(x);
+			const V ay = Abs(y);
+			const V hi = Max(ax, ay);
+			const V t = Select(hi == Splat<V>(0.0f), Splat<V>(0.0f), Min(ax, ay) / hi);
+
+			V angle = AtanUnit(t, precision);
+			angle = Select(ay > ax, Splat<V>(1.57079633f) - angle, angle);
+			angle = Select(x < Splat<V>(0.0f), Splat<V>(3.14159265f) - angle, angle);
+			return Select(y < Splat<V>(0.0f), -angle, angle);
+		}
+
+		// Applies f lane by lane, for the Exact tier of packs.
+		template<Lane V, typename F>
+		V PerLane(const V& x, F&& f)
+		{
+			alignas(64) float32 lanes[V::width];
+			x.Store(lanes);
+			for (float32& lane : lanes)
+			{
+				lane = f(lane);
+			}
+			return V::Load(lanes);
+		}
+
+		template<Lane V, typename F>
+		V PerLane(const V& a, const V& b, F&& f)
+		{
+			alignas(64) float32 la[V::width], lb[V::width];
+			a.Store(la);
+			b.Store(lb);
+			for (size_t i = 0; i < V::width; ++i)
+			{
+				la[i] = f(la[i], lb[i]);
+			}
+			return V::Load(la);
+		}
+	}
+
+	// SCALAR AND PACK ENTRY POINTS
+
+	template<Lane V>
+	constexpr void SinCos(const V& x, V& s, V& c, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if (precision != TrigPrecision::Exact)
+		{
+			detail::SinCosLanes(x, s, c, precision);
+		}
+		else if constexpr (std::is_same_v<V, float32>)
+		{
+			s = math::Sin(x);
+			c = math::Cos(x);
+		}
+		else
+		{
+			s = detail::PerLane(x, [](float32 v) { return std::sin(v); });
+			c = detail::PerLane(x, [](float32 v) { return std::cos(v); });
+		}
+	}
+
+	template<Lane V>
+	constexpr V Sin(const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		V s, c;
+		SinCos(x, s, c, precision);
+		return s;
+	}
+
+	template<Lane V>
+	constexpr V Cos(const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		V s, c;
+		SinCos(x, s, c, precision);
+		return c;
+	}
+
+	template<Lane V>
+	constexpr V Tan(const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if (precision != TrigPrecision::Exact) return detail::TanLanes(x, precision);
+		if constexpr (std::is_same_v<V, float32>) return math::Tan(x);
+		else return detail::PerLane(x, [](float32 v) { return std::tan(v); });
+	}
+
+	template<Lane V>
+	constexpr V Asin(const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if (precision != TrigPrecision::Exact) return detail::AsinLanes(x);
+		if constexpr (std::is_same_v<V, float32>) return math::Asin(x);
+		else return detail::PerLane(x, [](float32 v) { return std::asin(v); });
+	}
+
+	template<Lane V>
+	constexpr V Acos(const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if (precision != TrigPrecision::Exact) return detail::AcosLanes(x, precision);
+		if constexpr (std::is_same_v<V, float32>) return math::Acos(x);
+		else return detail::PerLane(x, [](float32 v) { return std::acos(v); });
+	}
+
+	// Angle of (x, y) in [-pi, pi], 0 for (0, 0). Finite inputs.
+	template<Lane V>
+	constexpr V Atan2(const V& y, const V& x, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if (precision != TrigPrecision::Exact) return detail::Atan2Lanes(y, x, precision);
+		if constexpr (std::is_same_v<V, float32>) return math::Atan2(y, x);
+		else return detail::PerLane(y, x, [](float32 a, float32 b) { return std::atan2(a, b); });
+	}
+
+	// VECTOR ENTRY POINTS
+	// One pack for all components when Vec<N, float32> fits a register.
+
+	template<size_t N>
+	constexpr void SinCos(const Vec<N, float32>& x, Vec<N, float32>& s, Vec<N, float32>& c, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		if constexpr (simd::IsPackable<N, float32>)
+		{
+			if (!std::is_constant_evaluated() && precision != TrigPrecision::Exact)
+			{
+				simd::Pack<float32, 4> ps, pc;
+				SinCos(x.ToPack(), ps, pc, precision);
+				s = Vec<N, float32>::FromPack(ps);
+				c = Vec<N, float32>::FromPack(pc);
+				return;
+			}
+		}
+
+		for (size_t i = 0; i < N; ++i)
+		{
+			SinCos(x[i], s[i], c[i], precision);
+		}
+	}
+
+	// BATCHED ENTRY POINTS
+	// One simd::Dispatch pack per iteration. Outputs may alias the inputs.
+
+	inline void SinCos(std::span<const float32> x, std::span<float32> s, std::span<float32> c, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		assert(s.size() >= x.size() && c.size() >= x.size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using P = simd::Pack<float32, W>;
+
+			simd::ForEachPack<float32, W>(x.size(), [&](size_t i, size_t lanes)
+			{
+				P ps, pc;
+				SinCos(P::LoadPartial(x.data() + i, lanes), ps, pc, precision);
+				ps.StorePartial(s.data() + i, lanes);
+				pc.StorePartial(c.data() + i, lanes);
+			});
+		});
+	}
+
+	inline void Tan(std::span<const float32> x, std::span<float32> out, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		assert(out.size() >= x.size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using P = simd::Pack<float32, W>;
+
+			simd::ForEachPack<float32, W>(x.size(), [&](size_t i, size_t lanes)
+			{
+				Tan(P::LoadPartial(x.data() + i, lanes), precision).StorePartial(out.data() + i, lanes);
+			});
+		});
+	}
+
+	inline void Acos(std::span<const float32> x, std::span<float32> out, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		assert(out.size() >= x.size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using P = simd::Pack<float32, W>;
+
+			simd::ForEachPack<float32, W>(x.size(), [&](size_t i, size_t lanes)
+			{
+				Acos(P::LoadPartial(x.data() + i, lanes), precision).StorePartial(out.data() + i, lanes);
+			});
+		});
+	}
+
+	inline void Atan2(std::span<const float32> y, std::span<const float32> x, std::span<float32> out, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		assert(x.size() == y.size() && out.size() >= y.size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using P = simd::Pack<float32, W>;
+
+			simd::ForEachPack<float32, W>(y.size(), [&](size_t i, size_t lanes)
+			{
+				Atan2(P::LoadPartial(y.data() + i, lanes), P::LoadPartial(x.data() + i, lanes), precision).StorePartial(out.data() + i, lanes);
+			});
+		});
+	}
+}
+
+#endif // MATHLIB_FAST_HPP
@@ -0,0 +1,270 @@
+#ifndef MATHLIB_FRUSTUM_HPP
+#define MATHLIB_FRUSTUM_HPP
+#pragma once
+
+#include <math/geometry.hpp>
+#include <math/matrix.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+
+namespace math
+{
+	// FRUSTUM
+	// Six inward-facing unit planes: left, right, bottom, top, near, far. The sphere and
+	// box tests are conservative: an object is culled only when it is fully behind one
+	// plane, so a few objects near the corners are kept.
+
+	struct Frustum
+	{
+		static constexpr size_t PLANE_COUNT = 6;
+
+		std::array<Plane, PLANE_COUNT> planes;
+
+		// Planes of proj * view (Gribb and Hartmann), OpenGL clip space -w <= x, y, z <= w
+		// as built by Perspective and Ortho. World-space planes for a view-projection
+		// matrix, object-space ones for a model-view-projection matrix.
+		static constexpr Frustum FromViewProj(const Mat4& m)
+		{
+			auto row = [&](size_t r) { return Vec4(m(r, 0), m(r, 1), m(r, 2), m(r, 3)); };
+			Vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+			std::array<Vec4, PLANE_COUNT> rows = { w + x, w - x, w + y, w - y, w + z, w - z };
+
+			Frustum frustum;
+			for (size_t i = 0; i < PLANE_COUNT; ++i)
+			{
+				frustum.planes[i] = Plane(Vec3(rows[i][0], rows[i][1], rows[i][2]), rows[i][3]).Normalize();
+			}
+			return frustum;
+		}
+
+		constexpr bool Contains(const Vec3& p) const
+		{
+			for (const Plane& plane : planes)
+			{
+				if (plane.SignedDistance(p) < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool Intersects(const Sphere& sphere) const
+		{
+			for (const Plane& plane : planes)
+			{
+				if (plane.SignedDistance(sphere.center) < -sphere.radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		constexpr bool Intersects(const AABB& box) const
+		{
+			Vec3 center = box.Center();
+			Vec3 extents = box.Extents();
+			for (const Plane& plane : planes)
+			{
+				if (plane.SignedDistance(center) + Dot(Abs(plane.normal), extents) < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	// BATCH CULLING
+	// One simd::Dispatch pack of objects per iteration (8 with AVX2) against the six planes.
+	// Results are either a bitmask, bit i of visible[i / 64] set when object i may be
+	// visible, or the indices of those objects in increasing order.
+	// lastPlane is an optional coherency cache, one byte per object. When a pack is entirely
+	// behind one plane, that plane is written for each of its objects; on the next call a
+	// pack whose bytes all agree tests that plane first and skips the others if it still
+	// rejects every object. It pays off when neighbouring objects are spatially close
+	// (sorted by direction from the camera, or along a space-filling curve). Start it zeroed.
+
+	namespace detail
+	{
+		// Plane normal, distance and absolute normal broadcast to every lane.
+		template<size_t W>
+		struct PlanePack
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			PackType nx, ny, nz, d, ax, ay, az;
+
+			static PlanePack Broadcast(const Plane& plane)
+			{
+				return {
+					PackType::Broadcast(plane.normal[0]), PackType::Broadcast(plane.normal[1]), PackType::Broadcast(plane.normal[2]), PackType::Broadcast(plane.distance),
+					PackType::Broadcast(Absolute(plane.normal[0])), PackType::Broadcast(Absolute(plane.normal[1])), PackType::Broadcast(Absolute(plane.normal[2]))
+				};
+			}
+		};
+
+		inline bool SamePlane(const uint8* planes, size_t lanes)
+		{
+			uint8 same = 0;
+			for (size_t k = 1; k < lanes; ++k)
+			{
+				same |= planes[k] ^ planes[0];
+			}
+			return same == 0;
+		}
+
+		// Runs visible(bits, i, lanes) per pack; outside(plane) is the mask of the lanes
+		// fully behind a PlanePack, for the pack that load(i, lanes) prepared.
+		template<typename Load, typename Outside, typename Visible>
+		void CullPacks(const Frustum& frustum, size_t count, std::span<uint8> lastPlane, Load&& load, Outside&& outside, Visible&& visible)
+		{
+			assert(lastPlane.empty() || lastPlane.size() >= count);
+
+			simd::Dispatch<float32>([&]<size_t W>()
+			{
+				std::array<PlanePack<W>, Frustum::PLANE_COUNT> planes;
+				for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+				{
+					planes[p] = PlanePack<W>::Broadcast(frustum.planes[p]);
+				}
+
+				simd::ForEachPack<float32, W>(count, [&](size_t i, size_t lanes)
+				{
+					const uint32 active = (1u << lanes) - 1u;
+					auto object = load.template operator()<W>(i, lanes);
+
+					if (!lastPlane.empty() && SamePlane(lastPlane.data() + i, lanes))
+					{
+						assert(lastPlane[i] < Frustum::PLANE_COUNT);
+						if ((outside(object, planes[lastPlane[i]]).Bits() & active) == active)
+						{
+							visible(0u, i, lanes);
+							return;
+						}
+					}
+
+					// First plane that rejects every lane, if any, is cached for the next call.
+					uint32 culledBits = 0;
+					size_t rejecting = Frustum::PLANE_COUNT;
+					for (size_t p = 0; p < Frustum::PLANE_COUNT; ++p)
+					{
+						const uint32 behind = outside(object, planes[p]).Bits() & active;
+						culledBits |= behind;
+						if (behind == active && rejecting == Frustum::PLANE_COUNT)
+						{
+							rejecting = p;
+						}
+					}
+
+					if (!lastPlane.empty() && rejecting < Frustum::PLANE_COUNT)
+					{
+						std::fill_n(lastPlane.data() + i, lanes, static_cast<uint8>(rejecting));
+					}
+					visible(~culledBits & active, i, lanes);
+				});
+			});
+		}
+
+		template<typename Load, typename Outside>
+		void CullToMask(const Frustum& frustum, size_t count, std::span<uint64> visible, std::span<uint8> lastPlane, Load&& load, Outside&& outside)
+		{
+			assert(visible.size() >= (count + 63) / 64);
+			std::fill(visible.begin(), visible.begin() + (count + 63) / 64, uint64(0));
+
+			// W divides 64, so a pack never straddles two words.
+			CullPacks(frustum, count, lastPlane, load, outside, [&](uint32 bits, size_t i, size_t)
+			{
+				visible[i / 64] |= uint64(bits) << (i % 64);
+			});
+		}
+
+		template<typename Load, typename Outside>
+		size_t CullToIndices(const Frustum& frustum, size_t count, std::span<uint32> visible, std::span<uint8> lastPlane, Load&& load, Outside&& outside)
+		{
+			assert(visible.size() >= count);
+
+			size_t written = 0;
+			CullPacks(frustum, count, lastPlane, load, outside, [&](uint32 bits, size_t i, size_t)
+			{
+				for (; bits; bits &= bits - 1)
+				{
+					visible[written++] = static_cast<uint32>(i + std::countr_zero(bits));
+				}
+			});
+			return written;
+		}
+
+		inline auto LoadSpheres(const SphereStream& spheres)
+		{
+			return [&spheres]<size_t W>(size_t i, size_t lanes) { return spheres.LoadPack<W>(i, lanes); };
+		}
+
+		// Center and extents of the boxes.
+		inline auto LoadBoxes(const AABBStream& boxes)
+		{
+			return [&boxes]<size_t W>(size_t i, size_t lanes)
+			{
+				using PackType = simd::Pack<float32, W>;
+
+				const PackType half = PackType::Broadcast(0.5f);
+				VecPack<6, float32, W> box = boxes.LoadPack<W>(i, lanes);
+				VecPack<6, float32, W> result;
+				for (size_t c = 0; c < 3; ++c)
+				{
+					result.c[c] = (box.c[c] + box.c[3 + c]) * half;
+					result.c[3 + c] = (box.c[3 + c] - box.c[c]) * half;
+				}
+				return result;
+			};
+		}
+
+		// Dot(n, center) + d < -radius
+		template<size_t W>
+		auto SphereOutside(const VecPack<4, float32, W>& s, const PlanePack<W>& plane)
+		{
+			return MulAdd(plane.nx, s.c[0], MulAdd(plane.ny, s.c[1], MulAdd(plane.nz, s.c[2], plane.d))) < -s.c[3];
+		}
+
+		// Dot(n, center) + d + Dot(|n|, extents) < 0
+		template<size_t W>
+		auto BoxOutside(const VecPack<6, float32, W>& b, const PlanePack<W>& plane)
+		{
+			auto distance = MulAdd(plane.nx, b.c[0], MulAdd(plane.ny, b.c[1], MulAdd(plane.nz, b.c[2], plane.d)));
+			auto radius = MulAdd(plane.ax, b.c[3], MulAdd(plane.ay, b.c[4], plane.az * b.c[5]));
+			return distance + radius < simd::Pack<float32, W>::Zero();
+		}
+	}
+
+	inline void CullSpheres(const Frustum& frustum, const SphereStream& spheres, std::span<uint64> visible, std::span<uint8> lastPlane = {})
+	{
+		detail::CullToMask(frustum, spheres.Size(), visible, lastPlane, detail::LoadSpheres(spheres),
+			[]<size_t W>(const VecPack<4, float32, W>& s, const detail::PlanePack<W>& plane) { return detail::SphereOutside(s, plane); });
+	}
+
+	// Returns the number of indices written.
+	inline size_t CullSpheres(const Frustum& frustum, const SphereStream& spheres, std::span<uint32> visible, std::span<uint8> lastPlane = {})
+	{
+		return detail::CullToIndices(frustum, spheres.Size(), visible, lastPlane, detail::LoadSpheres(spheres),
+			[]<size_t W>(const VecPack<4, float32, W>& s, const detail::PlanePack<W>& plane) { return detail::SphereOutside(s, plane); });
+	}
+
+	inline void CullBoxes(const Frustum& frustum, const AABBStream& boxes, std::span<uint64> visible, std::span<uint8> lastPlane = {})
+	{
+		detail::CullToMask(frustum, boxes.Size(), visible, lastPlane, detail::LoadBoxes(boxes),
+			[]<size_t W>(const VecPack<6, float32, W>& b, const detail::PlanePack<W>& plane) { return detail::BoxOutside(b, plane); });
+	}
+
+	// Returns the number of indices written.
+	inline size_t CullBoxes(const Frustum& frustum, const AABBStream& boxes, std::span<uint32> visible, std::span<uint8> lastPlane = {})
+	{
+		return detail::CullToIndices(frustum, boxes.Size(), visible, lastPlane, detail::LoadBoxes(boxes),
+			[]<size_t W>(const VecPack<6, float32, W>& b, const detail::PlanePack<W>& plane) { return detail::BoxOutside(b, plane); });
+	}
+}
+
+#endif // MATHLIB_FRUSTUM_HPP
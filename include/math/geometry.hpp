@@ -0,0 +1,351 @@
+#ifndef MATHLIB_GEOMETRY_HPP
+#define MATHLIB_GEOMETRY_HPP
+#pragma once
+
+#include <math/vector.hpp>
+#include <math/stream.hpp>
+
+#include <limits>
+#include <span>
+
+namespace math
+{
+	// PLANE
+	// Points p with Dot(normal, p) + distance = 0; the normal side is positive.
+
+	struct Plane
+	{
+		Vec3 normal;
+		float32 distance;
+
+		constexpr Plane() : normal(0, 1, 0), distance(0) {}
+		constexpr Plane(const Vec3& normal, float32 distance) : normal(normal), distance(distance) {}
+
+		static constexpr Plane FromPointNormal(const Vec3& point, const Vec3& normal)
+		{
+			Vec3 n = normal.Normalize();
+			return Plane(n, -Dot(n, point));
+		}
+
+		// Counter-clockwise a, b, c seen from the positive side.
+		static constexpr Plane FromPoints(const Vec3& a, const Vec3& b, const Vec3& c)
+		{
+			return FromPointNormal(a, Cross(b - a, c - a));
+		}
+
+		// Scales normal and distance so that the normal has unit length.
+		constexpr Plane Normalize() const
+		{
+			float32 len = normal.Length();
+			assert(len > 0);
+			float32 inv = 1.0f / len;
+			return Plane(normal * inv, distance * inv);
+		}
+
+		constexpr float32 SignedDistance(const Vec3& p) const
+		{
+			return Dot(normal, p) + distance;
+		}
+
+		constexpr Vec3 ClosestPoint(const Vec3& p) const
+		{
+			return p - normal * SignedDistance(p);
+		}
+	};
+
+	// SPHERE
+
+	struct Sphere
+	{
+		Vec3 center;
+		float32 radius;
+
+		constexpr Sphere() : center(0, 0, 0), radius(0) {}
+		constexpr Sphere(const Vec3& center, float32 radius) : center(center), radius(radius) {}
+
+		constexpr bool Contains(const Vec3& p) const
+		{
+			return DistanceSquared(center, p) <= radius * radius;
+		}
+	};
+
+	// RAY
+	// Points origin + direction * t for t >= 0. The direction is not normalized, hit
+	// distances are in units of its length.
+
+	struct Ray
+	{
+		Vec3 origin;
+		Vec3 direction;
+
+		constexpr Ray() : origin(0, 0, 0), direction(0, 0, 1) {}
+		constexpr Ray(const Vec3& origin, const Vec3& direction) : origin(origin), direction(direction) {}
+
+		constexpr Vec3 At(float32 t) const
+		{
+			return origin + direction * t;
+		}
+	};
+
+	// TRIANGLE
+
+	struct Triangle
+	{
+		Vec3 a;
+		Vec3 b;
+		Vec3 c;
+
+		constexpr Triangle() : a(0, 0, 0), b(0, 0, 0), c(0, 0, 0) {}
+		constexpr Triangle(const Vec3& a, const Vec3& b, const Vec3& c) : a(a), b(b), c(c) {}
+
+		// Unit normal, counter-clockwise a, b, c seen from its side.
+		constexpr Vec3 Normal() const
+		{
+			return Cross(b - a, c - a).Normalize();
+		}
+
+		constexpr float32 Area() const
+		{
+			return Cross(b - a, c - a).Length() * 0.5f;
+		}
+	};
+
+	// AABB
+	// Default constructed empty (min > max), so Expand() can grow it from nothing.
+
+	struct AABB
+	{
+		Vec3 min;
+		Vec3 max;
+
+		constexpr AABB() : min(Vec3(1, 1, 1) * std::numeric_limits<float32>::max()), max(Vec3(1, 1, 1) * -std::numeric_limits<float32>::max()) {}
+		constexpr AABB(const Vec3& min, const Vec3& max) : min(min), max(max) {}
+
+		static constexpr AABB FromCenterExtents(const Vec3& center, const Vec3& extents)
+		{
+			return AABB(center - extents, center + extents);
+		}
+
+		constexpr Vec3 Center() const { return (min + max) * 0.5f; }
+		constexpr Vec3 Extents() const { return (max - min) * 0.5f; }
+		constexpr Vec3 Size() const { return max - min; }
+
+		constexpr bool IsEmpty() const
+		{
+			return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+		}
+
+		constexpr float32 SurfaceArea() const
+		{
+			Vec3 s = Size();
+			return 2.0f * (s[0] * s[1] + s[1] * s[2] + s[2] * s[0]);
+		}
+
+		constexpr bool Contains(const Vec3& p) const
+		{
+			return p[0] >= min[0] && p[0] <= max[0] &&
+				p[1] >= min[1] && p[1] <= max[1] &&
+				p[2] >= min[2] && p[2] <= max[2];
+		}
+
+		constexpr void Expand(const Vec3& p)
+		{
+			min = Min(min, p);
+			max = Max(max, p);
+		}
+
+		constexpr void Expand(const AABB& other)
+		{
+			min = Min(min, other.min);
+			max = Max(max, other.max);
+		}
+
+		constexpr Vec3 ClosestPoint(const Vec3& p) const
+		{
+			return Clamp(p, min, max);
+		}
+	};
+
+	constexpr AABB Bounds(const Triangle& triangle)
+	{
+		return AABB(Min(Min(triangle.a, triangle.b), triangle.c), Max(Max(triangle.a, triangle.b), triangle.c));
+	}
+
+	constexpr AABB Bounds(const Sphere& sphere)
+	{
+		return AABB::FromCenterExtents(sphere.center, Vec3(1, 1, 1) * sphere.radius);
+	}
+
+	constexpr AABB Merge(const AABB& a, const AABB& b)
+	{
+		return AABB(Min(a.min, b.min), Max(a.max, b.max));
+	}
+
+	constexpr bool Overlaps(const AABB& a, const AABB& b)
+	{
+		return a.min[0] <= b.max[0] && a.max[0] >= b.min[0] &&
+			a.min[1] <= b.max[1] && a.max[1] >= b.min[1] &&
+			a.min[2] <= b.max[2] && a.max[2] >= b.min[2];
+	}
+
+	constexpr bool Overlaps(const AABB& box, const Sphere& sphere)
+	{
+		return DistanceSquared(box.ClosestPoint(sphere.center), sphere.center) <= sphere.radius * sphere.radius;
+	}
+
+	constexpr bool Overlaps(const Sphere& a, const Sphere& b)
+	{
+		float32 r = a.radius + b.radius;
+		return DistanceSquared(a.center, b.center) <= r * r;
+	}
+
+	// SOA STREAMS
+
+	// Center x, y, z then radius component arrays.
+	struct SphereStream : VecStream<4, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit SphereStream(std::span<const Sphere> spheres)
+		{
+			Assign(spheres);
+		}
+
+		Sphere Get(size_t index) const
+		{
+			return Sphere(Vec3(components[0][index], components[1][index], components[2][index]), components[3][index]);
+		}
+
+		void Set(size_t index, const Sphere& sphere)
+		{
+			components[0][index] = sphere.center[0];
+			components[1][index] = sphere.center[1];
+			components[2][index] = sphere.center[2];
+			components[3][index] = sphere.radius;
+		}
+
+		void Assign(std::span<const Sphere> spheres)
+		{
+			Resize(spheres.size());
+			for (size_t index = 0; index < spheres.size(); ++index)
+			{
+				Set(index, spheres[index]);
+			}
+		}
+	};
+
+	// Origin x, y, z then direction x, y, z component arrays.
+	struct RayStream : VecStream<6, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit RayStream(std::span<const Ray> rays)
+		{
+			Assign(rays);
+		}
+
+		Ray Get(size_t index) const
+		{
+			return Ray(
+				Vec3(components[0][index], components[1][index], components[2][index]),
+				Vec3(components[3][index], components[4][index], components[5][index])
+			);
+		}
+
+		void Set(size_t index, const Ray& ray)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				components[i][index] = ray.origin[i];
+				components[3 + i][index] = ray.direction[i];
+			}
+		}
+
+		void Assign(std::span<const Ray> rays)
+		{
+			Resize(rays.size());
+			for (size_t index = 0; index < rays.size(); ++index)
+			{
+				Set(index, rays[index]);
+			}
+		}
+	};
+
+	// A x, y, z, b x, y, z then c x, y, z component arrays.
+	struct TriangleStream : VecStream<9, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit TriangleStream(std::span<const Triangle> triangles)
+		{
+			Assign(triangles);
+		}
+
+		Triangle Get(size_t index) const
+		{
+			return Triangle(
+				Vec3(components[0][index], components[1][index], components[2][index]),
+				Vec3(components[3][index], components[4][index], components[5][index]),
+				Vec3(components[6][index], components[7][index], components[8][index])
+			);
+		}
+
+		void Set(size_t index, const Triangle& triangle)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				components[i][index] = triangle.a[i];
+				components[3 + i][index] = triangle.b[i];
+				components[6 + i][index] = triangle.c[i];
+			}
+		}
+
+		void Assign(std::span<const Triangle> triangles)
+		{
+			Resize(triangles.size());
+			for (size_t index = 0; index < triangles.size(); ++index)
+			{
+				Set(index, triangles[index]);
+			}
+		}
+	};
+
+	// Min x, y, z then max x, y, z component arrays.
+	struct AABBStream : VecStream<6, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit AABBStream(std::span<const AABB> boxes)
+		{
+			Assign(boxes);
+		}
+
+		AABB Get(size_t index) const
+		{
+			return AABB(
+				Vec3(components[0][index], components[1][index], components[2][index]),
+				Vec3(components[3][index], components[4][index], components[5][index])
+			);
+		}
+
+		void Set(size_t index, const AABB& box)
+		{
+			for (size_t i = 0; i < 3; ++i)
+			{
+				components[i][index] = box.min[i];
+				components[3 + i][index] = box.max[i];
+			}
+		}
+
+		void Assign(std::span<const AABB> boxes)
+		{
+			Resize(boxes.size());
+			for (size_t index = 0; index < boxes.size(); ++index)
+			{
+				Set(index, boxes[index]);
+			}
+		}
+	};
+}
+
+#endif // MATHLIB_GEOMETRY_HPP
@@ -0,0 +1,369 @@
+#ifndef MATHLIB_HIERARCHY_HPP
+#define MATHLIB_HIERARCHY_HPP
+#pragma once
+
+#include <math/transform.hpp>
+#include <math/stream.hpp>
+#include <math/parallel.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace math
+{
+	// TRANSFORM HIERARCHY
+	// Nodes keep a local translation, rotation and scale; Update() rebuilds the world
+	// matrices of the nodes whose local TRS or ancestors changed since the last update,
+	// so the work follows the moved subtrees rather than the node count.
+	// Storage is SoA in breadth-first order: every depth level is a contiguous range and
+	// the children of a node are contiguous in the next one. Levels run on ParallelFor.
+	// Handles stay valid; adding or reparenting nodes reorders the arrays once, in O(n),
+	// on the next Update().
+
+	class TransformHierarchy
+	{
+	public:
+		static constexpr uint32 NO_PARENT = ~0u;
+
+		// Levels with fewer moved nodes than this are updated on the calling thread.
+		static constexpr size_t PARALLEL_GRAIN = 2048;
+
+		uint32 AddNode(uint32 parent = NO_PARENT, const Vec3& position = Vec3(), const Quaternion& rotation = Quaternion(), const Vec3& scale = Vec3(1, 1, 1))
+		{
+			assert(parent == NO_PARENT || parent < indices.size());
+
+			uint32 handle = static_cast<uint32>(indices.size());
+			uint32 index = static_cast<uint32>(handles.size());
+			indices.push_back(index);
+			handles.push_back(handle);
+
+			parents.push_back(parent == NO_PARENT ? NO_PARENT : indices[parent]);
+			childBegin.push_back(0);
+			childEnd.push_back(0);
+			positions.components[0].push_back(position[0]);
+			positions.components[1].push_back(position[1]);
+			positions.components[2].push_back(position[2]);
+			rotations.components[0].push_back(rotation.x);
+			rotations.components[1].push_back(rotation.y);
+			rotations.components[2].push_back(rotation.z);
+			rotations.components[3].push_back(rotation.w);
+			scales.components[0].push_back(scale[0]);
+			scales.components[1].push_back(scale[1]);
+			scales.components[2].push_back(scale[2]);
+			locals.push_back(Identity<Mat4>());
+			worlds.push_back(Identity<Mat4>());
+			localDirty.push_back(0);
+			queued.push_back(0);
+
+			MarkDirty(index);
+			orderDirty = true;
+			return handle;
+		}
+
+		// Moves node and its subtree under newParent (NO_PARENT for a root).
+		void SetParent(uint32 node, uint32 newParent)
+		{
+			assert(node < indices.size() && (newParent == NO_PARENT || newParent < indices.size()));
+			assert(!IsAncestor(node, newParent));
+
+			parents[indices[node]] = newParent == NO_PARENT ? NO_PARENT : indices[newParent];
+			MarkDirty(indices[node]);
+			orderDirty = true;
+		}
+
+		void SetPosition(uint32 node, const Vec3& position)
+		{
+			uint32 i = indices[node];
+			positions.Set(i, position);
+			MarkDirty(i);
+		}
+
+		void SetRotation(uint32 node, const Quaternion& rotation)
+		{
+			uint32 i = indices[node];
+			rotations.Set(i, rotation);
+			MarkDirty(i);
+		}
+
+		void SetScale(uint32 node, const Vec3& scale)
+		{
+			uint32 i = indices[node];
+			scales.Set(i, scale);
+			MarkDirty(i);
+		}
+
+		void SetLocal(uint32 node, const Vec3& position, const Quaternion& rotation, const Vec3& scale)
+		{
+			uint32 i = indices[node];
+			positions.Set(i, position);
+			rotations.Set(i, rotation);
+			scales.Set(i, scale);
+			MarkDirty(i);
+		}
+
+		size_t Size() const { return handles.size(); }
+
+		uint32 GetParent(uint32 node) const
+		{
+			uint32 parent = parents[indices[node]];
+			return parent == NO_PARENT ? NO_PARENT : handles[parent];
+		}
+
+		Vec3 GetPosition(uint32 node) const { return positions.Get(indices[node]); }
+		Quaternion GetRotation(uint32 node) const { return rotations.Get(indices[node]); }
+		Vec3 GetScale(uint32 node) const { return scales.Get(indices[node]); }
+
+		// Valid after Update().
+		const Mat4& GetLocal(uint32 node) const { return locals[indices[node]]; }
+		const Mat4& GetWorld(uint32 node) const { return worlds[indices[node]]; }
+
+		// Recomputes the moved world matrices and returns how many were rebuilt.
+		size_t Update()
+		{
+			if (dirty.empty())
+			{
+				return 0;
+			}
+			if (orderDirty)
+			{
+				SortBreadthFirst();
+			}
+
+			// Breadth-first order: sorting the indices sorts them by depth too. A scan of the
+			// flags is cheaper than sorting once a sizeable part of the nodes moved.
+			if (dirty.size() > Size() / 16)
+			{
+				dirty.clear();
+				for (uint32 i = 0; i < Size(); ++i)
+				{
+					if (localDirty[i])
+					{
+						dirty.push_back(i);
+					}
+				}
+			}
+			else
+			{
+				std::sort(dirty.begin(), dirty.end());
+			}
+
+			size_t updated = 0;
+			size_t nextDirty = 0;
+			std::vector<uint32> level, children;
+
+			for (size_t depth = 0; depth + 1 < levelStarts.size(); ++depth)
+			{
+				// This level: its dirty nodes plus the children of the last level's nodes.
+				level.swap(children);
+				children.clear();
+				for (; nextDirty < dirty.size() && dirty[nextDirty] < levelStarts[depth + 1]; ++nextDirty)
+				{
+					if (!queued[dirty[nextDirty]])
+					{
+						queued[dirty[nextDirty]] = 1;
+						level.push_back(dirty[nextDirty]);
+					}
+				}
+				if (level.empty())
+				{
+					if (nextDirty == dirty.size())
+					{
+						break;
+					}
+					continue;
+				}
+
+				ParallelFor(level.size(), PARALLEL_GRAIN, [&](size_t first, size_t last)
+				{
+					for (size_t k = first; k < last; ++k)
+					{
+						UpdateNode(level[k]);
+					}
+				});
+				updated += level.size();
+
+				for (uint32 i : level)
+				{
+					for (uint32 child = childBegin[i]; child < childEnd[i]; ++child)
+					{
+						if (!queued[child])
+						{
+							queued[child] = 1;
+							children.push_back(child);
+						}
+					}
+					queued[i] = 0;
+					localDirty[i] = 0;
+				}
+			}
+
+			dirty.clear();
+			return updated;
+		}
+
+	private:
+		void MarkDirty(uint32 index)
+		{
+			if (!localDirty[index])
+			{
+				localDirty[index] = 1;
+				dirty.push_back(index);
+			}
+		}
+
+		bool IsAncestor(uint32 node, uint32 candidate) const
+		{
+			for (uint32 h = candidate; h != NO_PARENT; h = GetParent(h))
+			{
+				if (h == node)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Parents are one level up, already final when a level runs.
+		void UpdateNode(uint32 i)
+		{
+			if (localDirty[i])
+			{
+				locals[i] = LocalMatrix(i);
+			}
+			uint32 parent = parents[i];
+			worlds[i] = parent == NO_PARENT ? locals[i] : worlds[parent] * locals[i];
+		}
+
+		Mat4 LocalMatrix(size_t i) const
+		{
+			return Transform(positions.Get(i), rotations.Get(i), scales.Get(i)).ToMatrix4();
+		}
+
+		// Roots first, then the children of each node in turn, keeping the current
+		// relative order of siblings.
+		void SortBreadthFirst()
+		{
+			const uint32 n = static_cast<uint32>(Size());
+
+			// Children lists of the current order, grouped by parent.
+			std::vector<uint32> offsets(n + 1, 0);
+			for (uint32 parent : parents)
+			{
+				if (parent != NO_PARENT)
+				{
+					++offsets[parent + 1];
+				}
+			}
+			for (uint32 i = 0; i < n; ++i)
+			{
+				offsets[i + 1] += offsets[i];
+			}
+			std::vector<uint32> kids(offsets[n]);
+			{
+				std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+				for (uint32 i = 0; i < n; ++i)
+				{
+					if (parents[i] != NO_PARENT)
+					{
+						kids[cursor[parents[i]]++] = i;
+					}
+				}
+			}
+
+			std::vector<uint32> order;
+			order.reserve(n);
+			for (uint32 i = 0; i < n; ++i)
+			{
+				if (parents[i] == NO_PARENT)
+				{
+					order.push_back(i);
+				}
+			}
+			assert(!order.empty() || n == 0);
+
+			levelStarts.assign(1, 0);
+			std::vector<uint32> newBegin(n), newEnd(n);
+			for (uint32 slot = 0, levelEnd = static_cast<uint32>(order.size()); slot < order.size(); ++slot)
+			{
+				if (slot == levelEnd)
+				{
+					levelStarts.push_back(slot);
+					levelEnd = static_cast<uint32>(order.size());
+				}
+				uint32 i = order[slot];
+				newBegin[slot] = static_cast<uint32>(order.size());
+				order.insert(order.end(), kids.begin() + offsets[i], kids.begin() + offsets[i + 1]);
+				newEnd[slot] = static_cast<uint32>(order.size());
+			}
+			levelStarts.push_back(n);
+			assert(order.size() == n);
+
+			std::vector<uint32> newIndex(n);
+			for (uint32 slot = 0; slot < n; ++slot)
+			{
+				newIndex[order[slot]] = slot;
+			}
+
+			auto permute = [&](auto& values)
+			{
+				auto sorted = values;
+				for (size_t slot = 0; slot < n; ++slot)
+				{
+					sorted[slot] = values[order[slot]];
+				}
+				values.swap(sorted);
+			};
+
+			for (uint32& parent : parents)
+			{
+				parent = parent == NO_PARENT ? NO_PARENT : newIndex[parent];
+			}
+			permute(parents);
+			permute(handles);
+			for (auto& component : positions.components) permute(component);
+			for (auto& component : rotations.components) permute(component);
+			for (auto& component : scales.components) permute(component);
+			permute(locals);
+			permute(worlds);
+			permute(localDirty);
+
+			for (uint32& index : dirty)
+			{
+				index = newIndex[index];
+			}
+			for (uint32 slot = 0; slot < n; ++slot)
+			{
+				indices[handles[slot]] = slot;
+			}
+
+			childBegin.swap(newBegin);
+			childEnd.swap(newEnd);
+			orderDirty = false;
+		}
+
+		// Indexed by handle: position of the node in the sorted arrays.
+		std::vector<uint32> indices;
+
+		// Indexed by position.
+		std::vector<uint32> handles;
+		std::vector<uint32> parents;
+		std::vector<uint32> childBegin;
+		std::vector<uint32> childEnd;
+		Vec3Stream positions;
+		QuaternionStream rotations;
+		Vec3Stream scales;
+		std::vector<Mat4> locals;
+		std::vector<Mat4> worlds;
+		std::vector<uint8> localDirty;
+		std::vector<uint8> queued;
+
+		// Positions whose local TRS changed since the last Update().
+		std::vector<uint32> dirty;
+
+		// levelStarts[d] is the first node of depth d, levelStarts.back() the node count.
+		std::vector<uint32> levelStarts{ 0 };
+		bool orderDirty = false;
+	};
+}
+
+#endif // MATHLIB_HIERARCHY_HPP
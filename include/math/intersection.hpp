@@ -0,0 +1,422 @@
+#ifndef MATHLIB_INTERSECTION_HPP
+#define MATHLIB_INTERSECTION_HPP
+#pragma once
+
+#include <math/geometry.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace math
+{
+	// RAY TESTS
+	// Each returns whether the ray hits and writes the parametric distance of the first hit
+	// (ray.At(distance)) only when it does. Rays starting inside a sphere or a box hit at 0;
+	// planes and triangles are two-sided.
+
+	namespace detail
+	{
+		// 1 / x, with the infinity of IEEE division by zero also in constant evaluation.
+		constexpr float32 Reciprocal(float32 x)
+		{
+			if (std::is_constant_evaluated() && x == 0.0f)
+			{
+				return std::numeric_limits<float32>::infinity();
+			}
+			return 1.0f / x;
+		}
+	}
+
+	constexpr bool RayPlane(const Ray& ray, const Plane& plane, float32& distance)
+	{
+		float32 denom = Dot(plane.normal, ray.direction);
+		if (denom == 0.0f)
+		{
+			return false;
+		}
+
+		float32 t = -plane.SignedDistance(ray.origin) / denom;
+		if (t < 0.0f)
+		{
+			return false;
+		}
+		distance = t;
+		return true;
+	}
+
+	constexpr bool RaySphere(const Ray& ray, const Sphere& sphere, float32& distance)
+	{
+		Vec3 oc = ray.origin - sphere.center;
+		float32 b = Dot(oc, ray.direction);
+		float32 c = Dot(oc, oc) - sphere.radius * sphere.radius;
+		if (c <= 0.0f)
+		{
+			distance = 0.0f;
+			return true;
+		}
+
+		// Outside and moving away, or passing by.
+		float32 a = Dot(ray.direction, ray.direction);
+		float32 discriminant = b * b - a * c;
+		if (b > 0.0f || discriminant < 0.0f)
+		{
+			return false;
+		}
+		distance = (-b - Sqrt(discriminant)) / a;
+		return true;
+	}
+
+	// Slab test.
+	constexpr bool RayAABB(const Ray& ray, const AABB& box, float32& distance)
+	{
+		float32 tNear = 0.0f;
+		float32 tFar = std::numeric_limits<float32>::infinity();
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			float32 inv = detail::Reciprocal(ray.direction[axis]);
+			float32 t1 = (box.min[axis] - ray.origin[axis]) * inv;
+			float32 t2 = (box.max[axis] - ray.origin[axis]) * inv;
+			tNear = Max(tNear, Min(t1, t2));
+			tFar = Min(tFar, Max(t1, t2));
+		}
+
+		if (tNear > tFar)
+		{
+			return false;
+		}
+		distance = tNear;
+		return true;
+	}
+
+	// Moller-Trumbore, branchless: a zero determinant gives infinite or NaN barycentrics,
+	// which fail the tests.
+	constexpr bool RayTriangle(const Ray& ray, const Triangle& triangle, float32& distance)
+	{
+		Vec3 e1 = triangle.b - triangle.a;
+		Vec3 e2 = triangle.c - triangle.a;
+		Vec3 p = Cross(ray.direction, e2);
+		float32 inv = detail::Reciprocal(Dot(e1, p));
+
+		Vec3 s = ray.origin - triangle.a;
+		Vec3 q = Cross(s, e1);
+		float32 u = Dot(s, p) * inv;
+		float32 v = Dot(ray.direction, q) * inv;
+		float32 t = Dot(e2, q) * inv;
+
+		bool hit = (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (t >= 0.0f);
+		if (hit)
+		{
+			distance = t;
+		}
+		return hit;
+	}
+
+	// RAY PACKETS
+	// The same tests on W lanes, rays and primitives both one register per component: W
+	// rays against one primitive with a BroadcastPack() primitive, one ray against W
+	// primitives with a RayPack::Broadcast() ray. Missed lanes get an infinite distance.
+	// Primitive packs use the stream layouts: SphereStream, AABBStream, TriangleStream,
+	// and normal x, y, z, distance for planes.
+
+	template<size_t W = simd::NativeWidth<float32>>
+	struct RayPack
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		VecPack<3, float32, W> origin;
+		VecPack<3, float32, W> direction;
+		VecPack<3, float32, W> inverse;
+
+		static RayPack FromComponents(const VecPack<3, float32, W>& origin, const VecPack<3, float32, W>& direction)
+		{
+			RayPack rays{ origin, direction, {} };
+			for (size_t i = 0; i < 3; ++i)
+			{
+				rays.inverse.c[i] = PackType::Broadcast(1.0f) / direction.c[i];
+			}
+			return rays;
+		}
+
+		static RayPack Broadcast(const Ray& ray)
+		{
+			VecPack<3, float32, W> o, d;
+			for (size_t i = 0; i < 3; ++i)
+			{
+				o.c[i] = PackType::Broadcast(ray.origin[i]);
+				d.c[i] = PackType::Broadcast(ray.direction[i]);
+			}
+			return FromComponents(o, d);
+		}
+
+		static RayPack Load(const RayStream& rays, size_t index, size_t lanes)
+		{
+			VecPack<6, float32, W> r = rays.template LoadPack<W>(index, lanes);
+			return FromComponents({ r.c[0], r.c[1], r.c[2] }, { r.c[3], r.c[4], r.c[5] });
+		}
+	};
+
+	template<size_t W, size_t N>
+	VecPack<N, float32, W> BroadcastPack(const std::array<float32, N>& values)
+	{
+		VecPack<N, float32, W> result;
+		for (size_t i = 0; i < N; ++i)
+		{
+			result.c[i] = simd::Pack<float32, W>::Broadcast(values[i]);
+		}
+		return result;
+	}
+
+	template<size_t W>
+	VecPack<4, float32, W> BroadcastPack(const Plane& plane)
+	{
+		return BroadcastPack<W, 4>({ plane.normal[0], plane.normal[1], plane.normal[2], plane.distance });
+	}
+
+	template<size_t W>
+	VecPack<4, float32, W> BroadcastPack(const Sphere& sphere)
+	{
+		return BroadcastPack<W, 4>({ sphere.center[0], sphere.center[1], sphere.center[2], sphere.radius });
+	}
+
+	template<size_t W>
+	VecPack<6, float32, W> BroadcastPack(const AABB& box)
+	{
+		return BroadcastPack<W, 6>({ box.min[0], box.min[1], box.min[2], box.max[0], box.max[1], box.max[2] });
+	}
+
+	template<size_t W>
+	VecPack<9, float32, W> BroadcastPack(const Triangle& triangle)
+	{
+		const Vec3& a = triangle.a;
+		const Vec3& b = triangle.b;
+		const Vec3& c = triangle.c;
+		return BroadcastPack<W, 9>({ a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2] });
+	}
+
+	namespace detail
+	{
+		template<size_t W>
+		simd::Pack<float32, W> DotPack(const VecPack<3, float32, W>& a, const simd::Pack<float32, W>& x, const simd::Pack<float32, W>& y, const simd::Pack<float32, W>& z)
+		{
+			return MulAdd(a.c[0], x, MulAdd(a.c[1], y, a.c[2] * z));
+		}
+
+		template<size_t W>
+		VecPack<3, float32, W> CrossPack(const VecPack<3, float32, W>& a, const VecPack<3, float32, W>& b)
+		{
+			VecPack<3, float32, W> r;
+			r.c[0] = a.c[1] * b.c[2] - a.c[2] * b.c[1];
+			r.c[1] = a.c[2] * b.c[0] - a.c[0] * b.c[2];
+			r.c[2] = a.c[0] * b.c[1] - a.c[1] * b.c[0];
+			return r;
+		}
+
+		template<size_t W>
+		simd::Pack<float32, W> MissDistance(const simd::Mask<float32, W>& hit, const simd::Pack<float32, W>& t)
+		{
+			return Select(hit, t, simd::Pack<float32, W>::Broadcast(std::numeric_limits<float32>::infinity()));
+		}
+	}
+
+	template<size_t W>
+	simd::Mask<float32, W> RayPlane(const RayPack<W>& rays, const VecPack<4, float32, W>& planes, simd::Pack<float32, W>& distance)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		PackType denom = detail::DotPack(rays.direction, planes.c[0], planes.c[1], planes.c[2]);
+		PackType signedDistance = detail::DotPack(rays.origin, planes.c[0], planes.c[1], planes.c[2]) + planes.c[3];
+		PackType t = -signedDistance / denom;
+
+		// A ray parallel to the plane divides by zero, an infinite or NaN t fails the test.
+		auto hit = (t >= PackType::Zero()) & (t < PackType::Broadcast(std::numeric_limits<float32>::infinity()));
+		distance = detail::MissDistance(hit, t);
+		return hit;
+	}
+
+	template<size_t W>
+	simd::Mask<float32, W> RaySphere(const RayPack<W>& rays, const VecPack<4, float32, W>& spheres, simd::Pack<float32, W>& distance)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		VecPack<3, float32, W> oc;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			oc.c[i] = rays.origin.c[i] - spheres.c[i];
+		}
+
+		PackType a = Dot(rays.direction, rays.direction);
+		PackType b = Dot(oc, rays.direction);
+		PackType c = Dot(oc, oc) - spheres.c[3] * spheres.c[3];
+		PackType discriminant = b * b - a * c;
+
+		auto inside = c <= PackType::Zero();
+		auto hit = inside | ((b <= PackType::Zero()) & (discriminant >= PackType::Zero()));
+		PackType t = (-b - Sqrt(Max(discriminant, PackType::Zero()))) / a;
+		distance = detail::MissDistance(hit, Select(inside, PackType::Zero(), t));
+		return hit;
+	}
+
+	template<size_t W>
+	simd::Mask<float32, W> RayAABB(const RayPack<W>& rays, const VecPack<6, float32, W>& boxes, simd::Pack<float32, W>& distance)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		PackType tNear = PackType::Zero();
+		PackType tFar = PackType::Broadcast(std::numeric_limits<float32>::infinity());
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			PackType t1 = (boxes.c[axis] - rays.origin.c[axis]) * rays.inverse.c[axis];
+			PackType t2 = (boxes.c[3 + axis] - rays.origin.c[axis]) * rays.inverse.c[axis];
+			tNear = Max(tNear, Min(t1, t2));
+			tFar = Min(tFar, Max(t1, t2));
+		}
+
+		auto hit = tNear <= tFar;
+		distance = detail::MissDistance(hit, tNear);
+		return hit;
+	}
+
+	template<size_t W>
+	simd::Mask<float32, W> RayTriangle(const RayPack<W>& rays, const VecPack<9, float32, W>& triangles, simd::Pack<float32, W>& distance)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		VecPack<3, float32, W> e1, e2, s;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			e1.c[i] = triangles.c[3 + i] - triangles.c[i];
+			e2.c[i] = triangles.c[6 + i] - triangles.c[i];
+			s.c[i] = rays.origin.c[i] - triangles.c[i];
+		}
+
+		VecPack<3, float32, W> p = detail::CrossPack(rays.direction, e2);
+		VecPack<3, float32, W> q = detail::CrossPack(s, e1);
+
+		// A zero determinant gives infinite or NaN barycentrics, which fail the tests.
+		PackType inv = PackType::Broadcast(1.0f) / Dot(e1, p);
+		PackType u = Dot(s, p) * inv;
+		PackType v = Dot(rays.direction, q) * inv;
+		PackType t = Dot(e2, q) * inv;
+
+		const PackType zero = PackType::Zero();
+		auto hit = (u >= zero) & (v >= zero) & (u + v <= PackType::Broadcast(1.0f)) & (t >= zero);
+		distance = detail::MissDistance(hit, t);
+		return hit;
+	}
+
+	// BATCH TESTS
+	// Dispatched loops over the packet tests, W rays against one primitive or one ray
+	// against W primitives per iteration. Bit i of hits[i / 64] is set when ray or
+	// primitive i is hit, distances (optional) receives the distances.
+
+	namespace detail
+	{
+		// prepare<W>() builds the broadcast operands once per width and returns
+		// test(i, lanes, distance), the hit mask of the pack at i.
+		template<typename Prepare>
+		void IntersectPacks(size_t count, std::span<uint64> hits, std::span<float32> distances, Prepare&& prepare)
+		{
+			assert(hits.size() >= (count + 63) / 64);
+			assert(distances.empty() || distances.size() >= count);
+			std::fill(hits.begin(), hits.begin() + (count + 63) / 64, uint64(0));
+
+			simd::Dispatch<float32>([&]<size_t W>()
+			{
+				auto test = prepare.template operator()<W>();
+
+				// W divides 64, so a pack never straddles two words.
+				simd::ForEachPack<float32, W>(count, [&](size_t i, size_t lanes)
+				{
+					simd::Pack<float32, W> distance;
+					const uint32 bits = test(i, lanes, distance).Bits() & ((1u << lanes) - 1u);
+					hits[i / 64] |= uint64(bits) << (i % 64);
+					if (!distances.empty())
+					{
+						distance.StorePartial(distances.data() + i, lanes);
+					}
+				});
+			});
+		}
+	}
+
+	inline void RayPlane(const RayStream& rays, const Plane& plane, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(rays.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&rays, primitive = BroadcastPack<W>(plane)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RayPlane(RayPack<W>::Load(rays, i, lanes), primitive, distance);
+			};
+		});
+	}
+
+	inline void RaySphere(const RayStream& rays, const Sphere& sphere, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(rays.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&rays, primitive = BroadcastPack<W>(sphere)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RaySphere(RayPack<W>::Load(rays, i, lanes), primitive, distance);
+			};
+		});
+	}
+
+	inline void RayAABB(const RayStream& rays, const AABB& box, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(rays.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&rays, primitive = BroadcastPack<W>(box)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RayAABB(RayPack<W>::Load(rays, i, lanes), primitive, distance);
+			};
+		});
+	}
+
+	inline void RayTriangle(const RayStream& rays, const Triangle& triangle, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(rays.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&rays, primitive = BroadcastPack<W>(triangle)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RayTriangle(RayPack<W>::Load(rays, i, lanes), primitive, distance);
+			};
+		});
+	}
+
+	inline void RaySphere(const Ray& ray, const SphereStream& spheres, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(spheres.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&spheres, rays = RayPack<W>::Broadcast(ray)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RaySphere(rays, spheres.template LoadPack<W>(i, lanes), distance);
+			};
+		});
+	}
+
+	inline void RayAABB(const Ray& ray, const AABBStream& boxes, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(boxes.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&boxes, rays = RayPack<W>::Broadcast(ray)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RayAABB(rays, boxes.template LoadPack<W>(i, lanes), distance);
+			};
+		});
+	}
+
+	inline void RayTriangle(const Ray& ray, const TriangleStream& triangles, std::span<uint64> hits, std::span<float32> distances = {})
+	{
+		detail::IntersectPacks(triangles.Size(), hits, distances, [&]<size_t W>()
+		{
+			return [&triangles, rays = RayPack<W>::Broadcast(ray)](size_t i, size_t lanes, simd::Pack<float32, W>& distance)
+			{
+				return RayTriangle(rays, triangles.template LoadPack<W>(i, lanes), distance);
+			};
+		});
+	}
+}
+
+#endif // MATHLIB_INTERSECTION_HPP
@@ -0,0 +1,278 @@
+#ifndef MATHLIB_KDTREE_HPP
+#define MATHLIB_KDTREE_HPP
+#pragma once
+
+#include <math/parallel.hpp>
+#include <math/vector.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace math
+{
+	// K-D TREE
+	// Implicit tree over Vec<N, T> points: the median of a range along its split axis sits
+	// in the middle slot, the lower half before it and the upper half after it, so the tree
+	// is one array of points, with no nodes or pointers. Build() partitions that array in
+	// place with nth_element, splitting the widest axis of the range's cell; ranges of at
+	// most LEAF_SIZE points are scanned linearly. Subtrees of PARALLEL_GRAIN points or
+	// fewer are built on ParallelFor.
+	// Queries report the index of the point in the span given to Build() and its squared
+	// distance. The search keeps the distance from the query to the current cell
+	// incrementally (Arya and Mount) and visits the nearer child first. With epsilon > 0 it
+	// is approximate: each neighbour found is within (1 + epsilon) times the distance of
+	// the true neighbour of the same rank. Coordinates are floating point: the search
+	// bounds start at infinity.
+
+	template<size_t N, std::floating_point T = float32>
+	class KdTree
+	{
+	public:
+		using VecType = Vec<N, T>;
+
+		static constexpr size_t LEAF_SIZE = 16;
+		static constexpr size_t PARALLEL_GRAIN = 4096;
+
+		// Queries per ParallelFor chunk in the batched queries.
+		static constexpr size_t QUERY_GRAIN = 256;
+
+		struct Neighbor
+		{
+			static constexpr uint32 NONE = ~0u;
+
+			uint32 index = NONE;
+			T distanceSquared = std::numeric_limits<T>::infinity();
+
+			constexpr bool operator<(const Neighbor& other) const { return distanceSquared < other.distanceSquared; }
+		};
+
+		void Build(std::span<const VecType> source)
+		{
+			assert(source.size() < Neighbor::NONE);
+			const size_t count = source.size();
+			entries.resize(count);
+			axes.assign(count, 0);
+			if (count == 0)
+			{
+				return;
+			}
+
+			VecType low = source[0], high = source[0];
+			for (size_t i = 0; i < count; ++i)
+			{
+				entries[i] = { source[i], static_cast<uint32>(i) };
+				for (size_t c = 0; c < N; ++c)
+				{
+					low[c] = Min(low[c], source[i][c]);
+					high[c] = Max(high[c], source[i][c]);
+				}
+			}
+
+			std::vector<Subtree> subtrees;
+			Split({ 0, count, low, high }, &subtrees);
+			ParallelFor(subtrees.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t s = begin; s < end; ++s)
+				{
+					Split(subtrees[s], nullptr);
+				}
+			});
+		}
+
+		bool Empty() const { return entries.empty(); }
+		size_t Size() const { return entries.size(); }
+
+		// The min(k, Size()) nearest points, closest first, with k = nearest.size(). Returns
+		// how many were written.
+		size_t Nearest(const VecType& query, std::span<Neighbor> nearest, T epsilon = T(0)) const
+		{
+			const size_t k = nearest.size();
+			if (k == 0 || entries.empty())
+			{
+				return 0;
+			}
+
+			// Max-heap on distance, bounded to k entries: the front is the current k-th.
+			size_t found = 0;
+			T bound = std::numeric_limits<T>::infinity();
+			Search(query, epsilon, bound, [&](uint32 index, T distanceSquared)
+			{
+				if (found < k)
+				{
+					nearest[found++] = { index, distanceSquared };
+					std::push_heap(nearest.begin(), nearest.begin() + found);
+				}
+				else
+				{
+					std::pop_heap(nearest.begin(), nearest.end());
+					nearest[k - 1] = { index, distanceSquared };
+					std::push_heap(nearest.begin(), nearest.end());
+				}
+				if (found == k)
+				{
+					bound = nearest[0].distanceSquared;
+				}
+			});
+
+			std::sort_heap(nearest.begin(), nearest.begin() + found);
+			return found;
+		}
+
+		// f(index, distanceSquared) for every point within radius of query, in no particular order.
+		template<typename F>
+		void Radius(const VecType& query, T radius, F&& f) const
+		{
+			assert(radius >= T(0));
+			if (entries.empty())
+			{
+				return;
+			}
+			// Just above radius squared: points at exactly the radius pass the strict test of Search.
+			T bound = std::nextafter(radius * radius, std::numeric_limits<T>::infinity());
+			Search(query, T(0), bound, f);
+		}
+
+		// k nearest of every query on ParallelFor: those of queries[q] are nearest[q * k] to
+		// nearest[q * k + k - 1], padded with default Neighbors when Size() < k.
+		void Nearest(std::span<const VecType> queries, size_t k, std::span<Neighbor> nearest, T epsilon = T(0)) const
+		{
+			assert(nearest.size() >= queries.size() * k);
+			ParallelFor(queries.size(), QUERY_GRAIN, [&](size_t begin, size_t end)
+			{
+				for (size_t q = begin; q < end; ++q)
+				{
+					std::span<Neighbor> result = nearest.subspan(q * k, k);
+					std::fill(result.begin() + Nearest(queries[q], result, epsilon), result.end(), Neighbor());
+				}
+			});
+		}
+
+		// Points within radius of queries[q] are neighbors[offsets[q]] to
+		// neighbors[offsets[q + 1]], on ParallelFor.
+		void Radius(std::span<const VecType> queries, T radius, std::vector<uint32>& offsets, std::vector<Neighbor>& neighbors) const
+		{
+			ParallelCollect(queries.size(), QUERY_GRAIN, offsets, neighbors, [&](size_t q, std::vector<Neighbor>& found)
+			{
+				Radius(queries[q], radius, [&](uint32 index, T distanceSquared) { found.push_back({ index, distanceSquared }); });
+			});
+		}
+
+	private:
+		struct Entry
+		{
+			VecType point;
+			uint32 index;
+		};
+
+		// Range of entries and its cell.
+		struct Subtree
+		{
+			size_t begin, end;
+			VecType low, high;
+		};
+
+		static T DistanceSquared(const VecType& a, const VecType& b)
+		{
+			T sum = T(0);
+			for (size_t c = 0; c < N; ++c)
+			{
+				const T d = a[c] - b[c];
+				sum += d * d;
+			}
+			return sum;
+		}
+
+		void Split(const Subtree& range, std::vector<Subtree>* deferred)
+		{
+			const size_t count = range.end - range.begin;
+			if (count <= LEAF_SIZE)
+			{
+				return;
+			}
+			if (deferred && count <= PARALLEL_GRAIN)
+			{
+				deferred->push_back(range);
+				return;
+			}
+
+			size_t axis = 0;
+			for (size_t c = 1; c < N; ++c)
+			{
+				if (range.high[c] - range.low[c] > range.high[axis] - range.low[axis])
+				{
+					axis = c;
+				}
+			}
+
+			const size_t mid = range.begin + count / 2;
+			std::nth_element(entries.begin() + range.begin, entries.begin() + mid, entries.begin() + range.end,
+				[axis](const Entry& a, const Entry& b) { return a.point[axis] < b.point[axis]; });
+			axes[mid] = static_cast<uint8>(axis);
+
+			Subtree lower = range, upper = range;
+			lower.end = mid;
+			lower.high[axis] = entries[mid].point[axis];
+			upper.begin = mid + 1;
+			upper.low[axis] = entries[mid].point[axis];
+			Split(lower, deferred);
+			Split(upper, deferred);
+		}
+
+		// visit(index, distanceSquared) for the points closer than bound, which visit may lower.
+		template<typename Visit>
+		void Search(const VecType& query, T epsilon, T& bound, Visit&& visit) const
+		{
+			std::array<T, N> offsets{};
+			const T scale = (T(1) + epsilon) * (T(1) + epsilon);
+			Search(query, 0, entries.size(), T(0), offsets, scale, bound, visit);
+		}
+
+		template<typename Visit>
+		void Search(const VecType& query, size_t begin, size_t end, T cellDistance, std::array<T, N>& offsets, T scale, T& bound, Visit& visit) const
+		{
+			if (end - begin <= LEAF_SIZE)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					const T distanceSquared = DistanceSquared(query, entries[i].point);
+					if (distanceSquared < bound)
+					{
+						visit(entries[i].index, distanceSquared);
+					}
+				}
+				return;
+			}
+
+			const size_t mid = begin + (end - begin) / 2;
+			const size_t axis = axes[mid];
+			const T delta = query[axis] - entries[mid].point[axis];
+
+			const T distanceSquared = DistanceSquared(query, entries[mid].point);
+			if (distanceSquared < bound)
+			{
+				visit(entries[mid].index, distanceSquared);
+			}
+
+			const bool lowerFirst = delta < T(0);
+			Search(query, lowerFirst ? begin : mid + 1, lowerFirst ? mid : end, cellDistance, offsets, scale, bound, visit);
+
+			// The far cell differs from this one along axis only.
+			const T previous = offsets[axis];
+			const T farDistance = cellDistance - previous * previous + delta * delta;
+			if (farDistance * scale < bound)
+			{
+				offsets[axis] = delta;
+				Search(query, lowerFirst ? mid + 1 : begin, lowerFirst ? end : mid, farDistance, offsets, scale, bound, visit);
+				offsets[axis] = previous;
+			}
+		}
+
+		std::vector<Entry> entries;
+		std::vector<uint8> axes;	// Split axis of the range whose median is in this slot.
+	};
+}
+
+#endif // MATHLIB_KDTREE_HPP
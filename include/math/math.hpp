@@ -3,9 +3,23 @@
 #pragma once
 
 #include <math/common.hpp>
+#include <math/simd.hpp>
 #include <math/vector.hpp>
+#include <math/fast.hpp>
 #include <math/matrix.hpp>
 #include <math/transform.hpp>
 #include <math/quaternion.hpp>
+#include <math/stream.hpp>
+#include <math/parallel.hpp>
+#include <math/hierarchy.hpp>
+#include <math/skinning.hpp>
+#include <math/dualquaternion.hpp>
+#include <math/geometry.hpp>
+#include <math/frustum.hpp>
+#include <math/intersection.hpp>
+#include <math/bvh.hpp>
+#include <math/spatialhash.hpp>
+#include <math/kdtree.hpp>
+#include <math/dynmatrix.hpp>
 
 #endif //MATHLIB_MATH_HPP
\ No newline at end of file
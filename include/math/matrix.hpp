@@ -5,6 +5,15 @@
 
 namespace math
 {
+	template<typename M>
+	constexpr M Zero();
+
+	template<typename M>
+	constexpr M Identity();
+
+	template<typename M>
+	constexpr M Transpose(const M& matrix);
+
 	template<size_t R, size_t C, typename T>
 	struct Matrix
 	{
@@ -18,7 +27,7 @@ namespace math
 
 		Matrix() = default;
 
-		Matrix(std::initializer_list<T> list, bool rowMajor = true)
+		constexpr Matrix(std::initializer_list<T> list, bool rowMajor = true)
 		{
 			assert(list.size() == R * C);
 
@@ -41,7 +50,7 @@ namespace math
 			}
 		}
 
-		Matrix(std::initializer_list<Vec<R, T>> columns)
+		constexpr Matrix(std::initializer_list<Vec<R, T>> columns)
 		{
 			assert(columns.size() == C);
 
@@ -55,19 +64,32 @@ namespace math
 			}
 		}
 
-		T operator()(size_t row, size_t col) const
+		constexpr T operator()(size_t row, size_t col) const
 		{
 			return values[col * R + row];
 		}
 
-		T& operator()(size_t row, size_t col)
+		constexpr T& operator()(size_t row, size_t col)
 		{
 			return values[col * R + row];
 		}
 
+		constexpr const T* Data() const { return values.data(); }
+		constexpr T* Data() { return values.data(); }
+
 		template<size_t C2>
-		Matrix<R, C2, T> operator*(const Matrix<C, C2, T>& other) const
+		constexpr Matrix<R, C2, T> operator*(const Matrix<C, C2, T>& other) const
 		{
+			if constexpr (simd::IsPackable<R, T> && C <= 4)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					Matrix<R, C2, T> result;
+					simd::MulMatrix<R, C, C2>(values.data(), other.Data(), result.Data());
+					return result;
+				}
+			}
+
 			Matrix<R, C2, T> result = Zero<Matrix<R, C2, T>>();
 
 			for (size_t i = 0; i < R; ++i)
@@ -84,8 +106,18 @@ namespace math
 			return result;
 		}
 
-		Vec<R, T> operator*(const Vec<C, T>& other) const
+		constexpr Vec<R, T> operator*(const Vec<C, T>& other) const
 		{
+			if constexpr (simd::IsPackable<R, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					Vec<R, T> result;
+					simd::MulVector<R, C>(values.data(), other.Data(), result.Data());
+					return result;
+				}
+			}
+
 			Vec<R, T> result{};
 
 			for (size_t i = 0; i < R; ++i)
@@ -101,7 +133,7 @@ namespace math
 			return result;
 		}
 
-		Matrix<R, C, T> operator*(T scalar) const
+		constexpr Matrix<R, C, T> operator*(T scalar) const
 		{
 			Matrix<R, C, T> result;
 
@@ -113,7 +145,7 @@ namespace math
 			return result;
 		}
 
-		Matrix<R, C, T> operator-(T scalar) const
+		constexpr Matrix<R, C, T> operator-(T scalar) const
 		{
 			Matrix<R, C, T> result;
 
@@ -125,7 +157,7 @@ namespace math
 			return result;
 		}
 
-		Matrix<R, C, T> operator+(T scalar) const
+		constexpr Matrix<R, C, T> operator+(T scalar) const
 		{
 			Matrix<R, C, T> result;
 
@@ -146,17 +178,17 @@ namespace math
 		template<typename M>
 		friend constexpr M Transpose(const M& matrix);
 
-		friend Matrix<R, C, T> operator*(T scalar, const Matrix<R, C, T>& mat)
+		friend constexpr Matrix<R, C, T> operator*(T scalar, const Matrix<R, C, T>& mat)
 		{
 			return mat * scalar;
 		}
 
-		friend Matrix<R, C, T> operator+(T scalar, const Matrix<R, C, T>& mat)
+		friend constexpr Matrix<R, C, T> operator+(T scalar, const Matrix<R, C, T>& mat)
 		{
 			return mat + scalar;
 		}
 
-		friend Matrix<R, C, T> operator-(T scalar, const Matrix<R, C, T>& mat)
+		friend constexpr Matrix<R, C, T> operator-(T scalar, const Matrix<R, C, T>& mat)
 		{
 			Matrix<R, C, T> result;
 
@@ -168,7 +200,7 @@ namespace math
 			return result;
 		}
 
-		Vec<R, T> GetColumn(size_t col) const
+		constexpr Vec<R, T> GetColumn(size_t col) const
 		{
 			assert(col < C);
 			Vec<R, T> result;
@@ -179,7 +211,7 @@ namespace math
 			return result;
 		}
 
-		Vec<C, T> GetRow(size_t row) const
+		constexpr Vec<C, T> GetRow(size_t row) const
 		{
 			assert(row < R);
 			Vec<C, T> result;
@@ -190,7 +222,7 @@ namespace math
 			return result;
 		}
 
-		void SetColumn(size_t col, const Vec<R, T>& v)
+		constexpr void SetColumn(size_t col, const Vec<R, T>& v)
 		{
 			assert(col < C);
 			for (size_t row = 0; row < R; ++row)
@@ -199,7 +231,7 @@ namespace math
 			}
 		}
 
-		void SetRow(size_t row, const Vec<C, T>& v)
+		constexpr void SetRow(size_t row, const Vec<C, T>& v)
 		{
 			assert(row < R);
 			for (size_t col = 0; col < C; ++col)
@@ -269,29 +301,179 @@ namespace math
 		return result;
 	}
 
+	// LU DECOMPOSITION
+
+	// PA = LU with partial pivoting. L (unit diagonal) is stored below the diagonal of lu,
+	// U on and above it. singular is set when a column has no non-zero pivot left.
+	template<size_t N, typename T>
+	struct LUDecomposition
+	{
+		Matrix<N, N, T> lu;
+		std::array<size_t, N> permutation{};
+		T sign = static_cast<T>(1);
+		bool singular = false;
+
+		constexpr T Determinant() const
+		{
+			T det = sign;
+			for (size_t i = 0; i < N; ++i)
+			{
+				det *= lu(i, i);
+			}
+			return det;
+		}
+
+		constexpr Vec<N, T> Solve(const Vec<N, T>& b) const
+		{
+			assert(!singular);
+
+			Vec<N, T> x;
+			for (size_t i = 0; i < N; ++i)
+			{
+				T sum = b[permutation[i]];
+				for (size_t k = 0; k < i; ++k)
+				{
+					sum -= lu(i, k) * x[k];
+				}
+				x[i] = sum;
+			}
+
+			for (size_t i = N; i-- > 0;)
+			{
+				T sum = x[i];
+				for (size_t k = i + 1; k < N; ++k)
+				{
+					sum -= lu(i, k) * x[k];
+				}
+				x[i] = sum / lu(i, i);
+			}
+
+			return x;
+		}
+
+		constexpr Matrix<N, N, T> Inverse() const
+		{
+			Matrix<N, N, T> result;
+			for (size_t col = 0; col < N; ++col)
+			{
+				Vec<N, T> e;
+				e[col] = static_cast<T>(1);
+				result.SetColumn(col, Solve(e));
+			}
+			return result;
+		}
+	};
+
+	template<typename M>
+	constexpr LUDecomposition<M::rows, typename M::value_type> DecomposeLU(const M& matrix)
+	{
+		static_assert(M::rows == M::cols, "Matrix must be square");
+
+		using T = typename M::value_type;
+		constexpr size_t N = M::rows;
+
+		LUDecomposition<N, T> result;
+		result.lu = matrix;
+		Matrix<N, N, T>& lu = result.lu;
+
+		for (size_t i = 0; i < N; ++i)
+		{
+			result.permutation[i] = i;
+		}
+
+		for (size_t k = 0; k < N; ++k)
+		{
+			size_t pivot = k;
+			T pivotAbs = Absolute(lu(k, k));
+			for (size_t i = k + 1; i < N; ++i)
+			{
+				T a = Absolute(lu(i, k));
+				if (a > pivotAbs)
+				{
+					pivot = i;
+					pivotAbs = a;
+				}
+			}
+
+			if (pivotAbs == static_cast<T>(0))
+			{
+				result.singular = true;
+				continue;
+			}
+
+			if (pivot != k)
+			{
+				for (size_t j = 0; j < N; ++j)
+				{
+					T tmp = lu(k, j);
+					lu(k, j) = lu(pivot, j);
+					lu(pivot, j) = tmp;
+				}
+				size_t tmp = result.permutation[k];
+				result.permutation[k] = result.permutation[pivot];
+				result.permutation[pivot] = tmp;
+				result.sign = -result.sign;
+			}
+
+			T invPivot = static_cast<T>(1) / lu(k, k);
+			for (size_t i = k + 1; i < N; ++i)
+			{
+				T factor = lu(i, k) * invPivot;
+				lu(i, k) = factor;
+				for (size_t j = k + 1; j < N; ++j)
+				{
+					lu(i, j) -= factor * lu(k, j);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	// DETERMINANT AND INVERSE
+
 	template<typename M>
 	constexpr typename M::value_type Determinant(const M& matrix)
 	{
 		static_assert(M::rows == M::cols, "Matrix must be square");
 
+		const M& m = matrix;
+
 		if constexpr (M::rows == 1)
 		{
-			return matrix(0, 0);
+			return m(0, 0);
 		}
 		else if constexpr (M::rows == 2)
 		{
-			return matrix(0, 0) * matrix(1, 1) - matrix(0, 1) * matrix(1, 0);
+			return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+		}
+		else if constexpr (M::rows == 3)
+		{
+			return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+				- m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+				+ m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+		}
+		else if constexpr (M::rows == 4)
+		{
+			auto s0 = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+			auto s1 = m(0, 0) * m(1, 2) - m(0, 2) * m(1, 0);
+			auto s2 = m(0, 0) * m(1, 3) - m(0, 3) * m(1, 0);
+			auto s3 = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+			auto s4 = m(0, 1) * m(1, 3) - m(0, 3) * m(1, 1);
+			auto s5 = m(0, 2) * m(1, 3) - m(0, 3) * m(1, 2);
+
+			auto c5 = m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2);
+			auto c4 = m(2, 1) * m(3, 3) - m(2, 3) * m(3, 1);
+			auto c3 = m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1);
+			auto c2 = m(2, 0) * m(3, 3) - m(2, 3) * m(3, 0);
+			auto c1 = m(2, 0) * m(3, 2) - m(2, 2) * m(3, 0);
+			auto c0 = m(2, 0) * m(3, 1) - m(2, 1) * m(3, 0);
+
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 		}
 		else
 		{
-			typename M::value_type det = 0;
-			for (size_t col = 0; col < M::cols; ++col)
-			{
-				auto minor = Minor(matrix, 0, col);
-				auto sign = (col % 2 == 0) ? 1 : -1;
-				det += sign * matrix(0, col) * Determinant(minor);
-			}
-			return det;
+			return DecomposeLU(matrix).Determinant();
 		}
 	}
 
@@ -318,31 +500,147 @@ namespace math
 		return result;
 	}
 
+	// Writes the inverse into result and returns the determinant. Closed form up to 4x4
+	// (SIMD for Mat4), LU with partial pivoting above. result is meaningless when the
+	// returned determinant is zero.
+	template<typename M>
+	constexpr typename M::value_type InverseDeterminant(const M& matrix, M& result)
+	{
+		static_assert(M::rows == M::cols, "Matrix must be square");
+
+		using T = typename M::value_type;
+		const M& m = matrix;
+		M& r = result;
+
+		if constexpr (M::rows == 1)
+		{
+			T det = m(0, 0);
+			r(0, 0) = static_cast<T>(1) / det;
+			return det;
+		}
+		else if constexpr (M::rows == 2)
+		{
+			T det = Determinant(m);
+			T invDet = static_cast<T>(1) / det;
+			r(0, 0) = m(1, 1) * invDet;
+			r(0, 1) = -m(0, 1) * invDet;
+			r(1, 0) = -m(1, 0) * invDet;
+			r(1, 1) = m(0, 0) * invDet;
+			return det;
+		}
+		else if constexpr (M::rows == 3)
+		{
+			T c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+			T c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+			T c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+
+			T det = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+			T invDet = static_cast<T>(1) / det;
+
+			r(0, 0) = c00 * invDet;
+			r(1, 0) = c01 * invDet;
+			r(2, 0) = c02 * invDet;
+			r(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * invDet;
+			r(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * invDet;
+			r(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * invDet;
+			r(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * invDet;
+			r(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * invDet;
+			r(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * invDet;
+			return det;
+		}
+		else if constexpr (M::rows == 4)
+		{
+#if defined(MATHLIB_SSE2)
+			if constexpr (std::is_same_v<T, float32>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return simd::InverseMatrix4(m.Data(), r.Data());
+				}
+			}
+#endif
+			T s0 = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+			T s1 = m(0, 0) * m(1, 2) - m(0, 2) * m(1, 0);
+			T s2 = m(0, 0) * m(1, 3) - m(0, 3) * m(1, 0);
+			T s3 = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+			T s4 = m(0, 1) * m(1, 3) - m(0, 3) * m(1, 1);
+			T s5 = m(0, 2) * m(1, 3) - m(0, 3) * m(1, 2);
+
+			T c5 = m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2);
+			T c4 = m(2, 1) * m(3, 3) - m(2, 3) * m(3, 1);
+			T c3 = m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1);
+			T c2 = m(2, 0) * m(3, 3) - m(2, 3) * m(3, 0);
+			T c1 = m(2, 0) * m(3, 2) - m(2, 2) * m(3, 0);
+			T c0 = m(2, 0) * m(3, 1) - m(2, 1) * m(3, 0);
+
+			T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			T invDet = static_cast<T>(1) / det;
+
+			r(0, 0) = (m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3) * invDet;
+			r(0, 1) = (-m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3) * invDet;
+			r(0, 2) = (m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3) * invDet;
+			r(0, 3) = (-m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3) * invDet;
+
+			r(1, 0) = (-m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1) * invDet;
+			r(1, 1) = (m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1) * invDet;
+			r(1, 2) = (-m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1) * invDet;
+			r(1, 3) = (m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1) * invDet;
+
+			r(2, 0) = (m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0) * invDet;
+			r(2, 1) = (-m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0) * invDet;
+			r(2, 2) = (m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0) * invDet;
+			r(2, 3) = (-m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0) * invDet;
+
+			r(3, 0) = (-m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0) * invDet;
+			r(3, 1) = (m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0) * invDet;
+			r(3, 2) = (-m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0) * invDet;
+			r(3, 3) = (m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0) * invDet;
+
+			return det;
+		}
+		else
+		{
+			auto lu = DecomposeLU(m);
+			if (lu.singular)
+			{
+				return static_cast<T>(0);
+			}
+			r = lu.Inverse();
+			return lu.Determinant();
+		}
+	}
+
 	template<typename M>
 	constexpr auto Inverse(const M& matrix)
 	{
 		static_assert(M::rows == M::cols);
 
 		using T = typename M::value_type;
-		const size_t N = M::rows;
 
-		T det = Determinant(matrix);
+		M result;
+		[[maybe_unused]] T det = InverseDeterminant(matrix, result);
 		assert(det != static_cast<T>(0));
 
-		Matrix<N, N, T> cofactorMat;
+		return result;
+	}
 
-		for (size_t i = 0; i < N; ++i)
+	// Returns false when the matrix is singular or ill-conditioned, i.e. |det| is below
+	// tolerance times its Hadamard bound (the product of the column lengths).
+	template<typename M>
+	constexpr bool TryInverse(const M& matrix, M& result, typename M::value_type tolerance = static_cast<typename M::value_type>(EPSILON_f32))
+	{
+		static_assert(M::rows == M::cols, "Matrix must be square");
+
+		using T = typename M::value_type;
+
+		T bound = static_cast<T>(1);
+		for (size_t col = 0; col < M::cols; ++col)
 		{
-			for (size_t j = 0; j < N; ++j)
-			{
-				auto minor = Minor(matrix, i, j);
-				T cofactor = Determinant(minor);
-				if ((i + j) % 2 == 1) cofactor = -cofactor;
-				cofactorMat(j, i) = cofactor;
-			}
+			bound *= matrix.GetColumn(col).Length();
 		}
 
-		return cofactorMat * (static_cast<T>(1) / det);
+		T det = InverseDeterminant(matrix, result);
+		return IsFinite(det) && Absolute(det) > tolerance * bound;
 	}
 }
 
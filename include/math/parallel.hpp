@@ -0,0 +1,221 @@
+#ifndef MATHLIB_PARALLEL_HPP
+#define MATHLIB_PARALLEL_HPP
+#pragma once
+
+#include <math/common.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace math
+{
+	// THREAD POOL
+	// hardware_concurrency() - 1 workers started on first use; the calling thread takes
+	// chunks too. One parallel loop runs at a time, a loop started from inside a chunk
+	// runs serially on that thread.
+
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(size_t workerCount)
+		{
+			for (size_t i = 0; i < workerCount; ++i)
+			{
+				workers.emplace_back([this] { WorkerLoop(); });
+			}
+		}
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		size_t ThreadCount() const { return workers.size() + 1; }
+
+		static ThreadPool& Default()
+		{
+			static ThreadPool pool(Max(std::thread::hardware_concurrency(), 1u) - 1);
+			return pool;
+		}
+
+		// f(begin, end) over [0, count) in chunks of `grain` indices.
+		template<typename F>
+		void For(size_t count, size_t grain, F&& f)
+		{
+			grain = Max<size_t>(grain, 1);
+			if (workers.empty() || count <= grain || InsideChunk())
+			{
+				f(size_t(0), count);
+				return;
+			}
+
+			std::lock_guard submit(submitMutex);
+
+			Job job;
+			job.count = count;
+			job.grain = grain;
+			job.context = &f;
+			job.run = [](void* context, size_t begin, size_t end) { (*static_cast<std::remove_reference_t<F>*>(context))(begin, end); };
+
+			{
+				std::lock_guard lock(mutex);
+				current = &job;
+				++generation;
+			}
+			wake.notify_all();
+
+			size_t processed = Work(job);
+
+			// Workers that picked the job up hold a reference until they leave Work().
+			std::unique_lock lock(mutex);
+			job.finished += processed;
+			current = nullptr;
+			done.wait(lock, [&] { return job.finished == job.count && job.active == 0; });
+		}
+
+	private:
+		struct Job
+		{
+			size_t count = 0;
+			size_t grain = 1;
+			void* context = nullptr;
+			void (*run)(void*, size_t, size_t) = nullptr;
+			std::atomic<size_t> next{ 0 };
+			size_t finished = 0;
+			size_t active = 0;
+		};
+
+		static bool& InsideChunk()
+		{
+			thread_local bool inside = false;
+			return inside;
+		}
+
+		size_t Work(Job& job)
+		{
+			InsideChunk() = true;
+			size_t processed = 0;
+			for (;;)
+			{
+				size_t begin = job.next.fetch_add(job.grain, std::memory_order_relaxed);
+				if (begin >= job.count)
+				{
+					break;
+				}
+				size_t end = Min(begin + job.grain, job.count);
+				job.run(job.context, begin, end);
+				processed += end - begin;
+			}
+			InsideChunk() = false;
+			return processed;
+		}
+
+		void WorkerLoop()
+		{
+			uint64 seen = 0;
+			for (;;)
+			{
+				Job* job;
+				{
+					std::unique_lock lock(mutex);
+					wake.wait(lock, [&] { return stopping || (current && generation != seen); });
+					if (stopping)
+					{
+						return;
+					}
+					seen = generation;
+					job = current;
+					++job->active;
+				}
+
+				size_t processed = Work(*job);
+
+				std::lock_guard lock(mutex);
+				job->finished += processed;
+				--job->active;
+				done.notify_all();
+			}
+		}
+
+		std::vector<std::thread> workers;
+		std::mutex submitMutex;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		Job* current = nullptr;
+		uint64 generation = 0;
+		bool stopping = false;
+	};
+
+	// f(begin, end) over [0, count) on the default pool, serial when count <= grain.
+	template<typename F>
+	void ParallelFor(size_t count, size_t grain, F&& f)
+	{
+		ThreadPool::Default().For(count, grain, std::forward<F>(f));
+	}
+
+	// Variable-length results in index order: f(i, out) appends those of index i to out, a
+	// std::vector<T>. They end up in values[offsets[i]] to values[offsets[i + 1]].
+	template<typename T, typename F>
+	void ParallelCollect(size_t count, size_t grain, std::vector<uint32>& offsets, std::vector<T>& values, F&& f)
+	{
+		grain = Max<size_t>(grain, 1);
+		const size_t chunkCount = (count + grain - 1) / grain;
+		std::vector<std::vector<T>> chunks(chunkCount);
+		offsets.resize(count + 1);
+		offsets[0] = 0;
+
+		// Offsets are first relative to the chunk, then rebased once the sizes are known.
+		ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; ++c)
+			{
+				for (size_t i = c * grain; i < Min(count, (c + 1) * grain); ++i)
+				{
+					f(i, chunks[c]);
+					offsets[i + 1] = static_cast<uint32>(chunks[c].size());
+				}
+			}
+		});
+
+		std::vector<size_t> bases(chunkCount);
+		size_t total = 0;
+		for (size_t c = 0; c < chunkCount; ++c)
+		{
+			bases[c] = total;
+			total += chunks[c].size();
+		}
+		assert(total < std::numeric_limits<uint32>::max());
+		values.resize(total);
+
+		ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; ++c)
+			{
+				std::copy(chunks[c].begin(), chunks[c].end(), values.begin() + bases[c]);
+				for (size_t i = c * grain; i < Min(count, (c + 1) * grain); ++i)
+				{
+					offsets[i + 1] += static_cast<uint32>(bases[c]);
+				}
+			}
+		});
+	}
+}
+
+#endif // MATHLIB_PARALLEL_HPP
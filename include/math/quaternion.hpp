@@ -3,6 +3,9 @@
 #pragma once 
 
 #include <math/matrix.hpp>
+#include <math/fast.hpp>
+
+#include <span>
 
 namespace math
 {
@@ -10,27 +13,26 @@ namespace math
 	{
 		float32 x, y, z, w;
 
-		Quaternion() : x(0), y(0), z(0), w(1) {}
-		Quaternion(float32 x, float32 y, float32 z, float32 w) : x(x), y(y), z(z), w(w) {}
+		constexpr Quaternion() : x(0), y(0), z(0), w(1) {}
+		constexpr Quaternion(float32 x, float32 y, float32 z, float32 w) : x(x), y(y), z(z), w(w) {}
 
-		static Quaternion FromAxisAngle(const Vec3& axis, float32 angle)
+		static constexpr Quaternion FromAxisAngle(const Vec3& axis, float32 angle, TrigPrecision precision = TrigPrecision::Exact)
 		{
 			Vec3 a = axis.Normalize();
-			float32 halfAngle = angle * 0.5f;
-			float32 s = std::sin(halfAngle);
-			float32 c = std::cos(halfAngle);
+			float32 s, c;
+			fast::SinCos(angle * 0.5f, s, c, precision);
 
 			return Quaternion(a[0] * s, a[1] * s, a[2] * s, c);
 		}
 
-		static Quaternion FromEuler(float32 pitch, float32 yaw, float32 roll)
+		// The fast tiers evaluate the three half-angle sines and cosines in one pack.
+		static constexpr Quaternion FromEuler(float32 pitch, float32 yaw, float32 roll, TrigPrecision precision = TrigPrecision::Exact)
 		{
-			float32 cy = std::cos(yaw * 0.5f);
-			float32 sy = std::sin(yaw * 0.5f);
-			float32 cp = std::cos(pitch * 0.5f);
-			float32 sp = std::sin(pitch * 0.5f);
-			float32 cr = std::cos(roll * 0.5f);
-			float32 sr = std::sin(roll * 0.5f);
+			Vec3 sines, cosines;
+			fast::SinCos(Vec3(pitch, yaw, roll) * 0.5f, sines, cosines, precision);
+
+			float32 sp = sines[0], sy = sines[1], sr = sines[2];
+			float32 cp = cosines[0], cy = cosines[1], cr = cosines[2];
 
 			Quaternion q;
 			q.w = cr * cp * cy + sr * sp * sy;
@@ -41,14 +43,14 @@ namespace math
 			return q;
 		}
 
-		static Quaternion FromRotationMatrix(const Mat3& m)
+		static constexpr Quaternion FromRotationMatrix(const Mat3& m)
 		{
 			Quaternion q;
 			float32 trace = m(0, 0) + m(1, 1) + m(2, 2);
 
 			if (trace > 0.0f)
 			{
-				float32 s = std::sqrt(trace + 1.0f) * 2.0f;
+				float32 s = Sqrt(trace + 1.0f) * 2.0f;
 				q.w = 0.25f * s;
 				q.x = (m(2, 1) - m(1, 2)) / s;
 				q.y = (m(0, 2) - m(2, 0)) / s;
@@ -56,7 +58,7 @@ namespace math
 			}
 			else if ((m(0, 0) > m(1, 1)) && (m(0, 0) > m(2, 2)))
 			{
-				float32 s = std::sqrt(1.0f + m(0, 0) - m(1, 1) - m(2, 2)) * 2.0f;
+				float32 s = Sqrt(1.0f + m(0, 0) - m(1, 1) - m(2, 2)) * 2.0f;
 				q.w = (m(2, 1) - m(1, 2)) / s;
 				q.x = 0.25f * s;
 				q.y = (m(0, 1) + m(1, 0)) / s;
@@ -64,7 +66,7 @@ namespace math
 			}
 			else if (m(1, 1) > m(2, 2))
 			{
-				float32 s = std::sqrt(1.0f + m(1, 1) - m(0, 0) - m(2, 2)) * 2.0f;
+				float32 s = Sqrt(1.0f + m(1, 1) - m(0, 0) - m(2, 2)) * 2.0f;
 				q.w = (m(0, 2) - m(2, 0)) / s;
 				q.x = (m(0, 1) + m(1, 0)) / s;
 				q.y = 0.25f * s;
@@ -72,7 +74,7 @@ namespace math
 			}
 			else
 			{
-				float32 s = std::sqrt(1.0f + m(2, 2) - m(0, 0) - m(1, 1)) * 2.0f;
+				float32 s = Sqrt(1.0f + m(2, 2) - m(0, 0) - m(1, 1)) * 2.0f;
 				q.w = (m(1, 0) - m(0, 1)) / s;
 				q.x = (m(0, 2) + m(2, 0)) / s;
 				q.y = (m(1, 2) + m(2, 1)) / s;
@@ -82,7 +84,7 @@ namespace math
 			return q;
 		}
 
-		static Quaternion FromRotationMatrix(const Mat4& m)
+		static constexpr Quaternion FromRotationMatrix(const Mat4& m)
 		{
 			Mat3 m3 = Zero<Mat3>();
 			for (size_t i = 0; i < 3; ++i)
@@ -95,8 +97,16 @@ namespace math
 			return FromRotationMatrix(m3);
 		}
 
-		Quaternion operator*(const Quaternion& other) const
+		constexpr Quaternion operator*(const Quaternion& other) const
 		{
+#if defined(MATHLIB_SSE2)
+			if (!std::is_constant_evaluated())
+			{
+				Quaternion result;
+				simd::QuaternionMul(&x, &other.x, &result.x);
+				return result;
+			}
+#endif
 			return Quaternion(
 				w * other.x + x * other.w + y * other.z - z * other.y,
 				w * other.y - x * other.z + y * other.w + z * other.x,
@@ -105,34 +115,42 @@ namespace math
 			);
 		}
 
-		Vec3 operator*(const Vec3& v) const
+		constexpr Vec3 operator*(const Vec3& v) const
 		{
+#if defined(MATHLIB_SSE2)
+			if (!std::is_constant_evaluated())
+			{
+				Vec3 result;
+				simd::QuaternionRotate(&x, v.Data(), result.Data());
+				return result;
+			}
+#endif
 			Vec3 qv(x, y, z);
 			Vec3 t = Cross(qv, v) * 2.0f;
 			return v + t * w + Cross(qv, t);
 		}
 
-		Quaternion operator+(const Quaternion& other) const
+		constexpr Quaternion operator+(const Quaternion& other) const
 		{
 			return Quaternion(x + other.x, y + other.y, z + other.z, w + other.w);
 		}
 
-		Quaternion operator*(float32 scalar) const
+		constexpr Quaternion operator*(float32 scalar) const
 		{
 			return Quaternion(x * scalar, y * scalar, z * scalar, w * scalar);
 		}
 
-		friend Quaternion operator*(float32 scalar, const Quaternion& q)
+		friend constexpr Quaternion operator*(float32 scalar, const Quaternion& q)
 		{
 			return q * scalar;
 		}
 
-		Quaternion Conjugate() const
+		constexpr Quaternion Conjugate() const
 		{
 			return Quaternion(-x, -y, -z, w);
 		}
 
-		Quaternion Inverse() const
+		constexpr Quaternion Inverse() const
 		{
 			float32 lenSq = LengthSquared();
 			assert(lenSq > 0);
@@ -140,24 +158,51 @@ namespace math
 			return conj * (1.0f / lenSq);
 		}
 
-		float32 Length() const
+		constexpr float32 Length() const
 		{
-			return std::sqrt(x * x + y * y + z * z + w * w);
+			return Sqrt(x * x + y * y + z * z + w * w);
 		}
 
-		float32 LengthSquared() const
+		constexpr float32 LengthSquared() const
 		{
 			return x * x + y * y + z * z + w * w;
 		}
 
-		Quaternion Normalize() const
+		constexpr Quaternion Normalize() const
 		{
 			float32 len = Length();
 			assert(len > 0);
 			return (*this) * (1.0f / len);
 		}
 
-		Mat3 ToMatrix3() const
+		constexpr float32 InvLength(SqrtPrecision precision = SqrtPrecision::Accurate) const
+		{
+			return simd::InvSqrt(LengthSquared(), precision);
+		}
+
+		constexpr Quaternion NormalizeFast(SqrtPrecision precision = SqrtPrecision::Accurate) const
+		{
+			if (precision == SqrtPrecision::Exact)
+			{
+				return Normalize();
+			}
+
+			float32 lengthSquared = LengthSquared();
+			assert(lengthSquared > 0);
+			return (*this) * simd::InvSqrt(lengthSquared, precision);
+		}
+
+		// Returns identity for zero, denormal-length or NaN quaternions.
+		constexpr Quaternion NormalizeSafe(SqrtPrecision precision = SqrtPrecision::Exact) const
+		{
+			if (!(LengthSquared() > std::numeric_limits<float32>::min()))
+			{
+				return Quaternion();
+			}
+			return NormalizeFast(precision);
+		}
+
+		constexpr Mat3 ToMatrix3() const
 		{
 			Mat3 result = Identity<Mat3>();
 
@@ -180,7 +225,7 @@ namespace math
 			return result;
 		}
 
-		Mat4 ToMatrix4() const
+		constexpr Mat4 ToMatrix4() const
 		{
 			Mat4 result = Identity<Mat4>();
 			Mat3 rot = ToMatrix3();
@@ -196,37 +241,37 @@ namespace math
 			return result;
 		}
 
-		Vec3 ToEuler() const
+		constexpr Vec3 ToEuler(TrigPrecision precision = TrigPrecision::Exact) const
 		{
 			Vec3 angles;
 
 			float32 sinp = 2.0f * (w * x - z * y);
 			if (Absolute(sinp) >= 1.0f)
 			{
-				angles[0] = std::copysign(PI_f32 / 2.0f, sinp);
+				angles[0] = (sinp < 0.0f) ? -PI_f32 / 2.0f : PI_f32 / 2.0f;
 			}
 			else
 			{
-				angles[0] = std::asin(sinp);
+				angles[0] = fast::Asin(sinp, precision);
 			}
 
 			float32 siny_cosp = 2.0f * (w * y + z * x);
 			float32 cosy_cosp = 1.0f - 2.0f * (x * x + y * y);
-			angles[1] = std::atan2(siny_cosp, cosy_cosp);
+			angles[1] = fast::Atan2(siny_cosp, cosy_cosp, precision);
 
 			float32 sinr_cosp = 2.0f * (w * z + x * y);
 			float32 cosr_cosp = 1.0f - 2.0f * (z * z + x * x);
-			angles[2] = std::atan2(sinr_cosp, cosr_cosp);
+			angles[2] = fast::Atan2(sinr_cosp, cosr_cosp, precision);
 
 			return angles;
 		}
 
-		bool operator==(const Quaternion& other) const
+		constexpr bool operator==(const Quaternion& other) const
 		{
 			return x == other.x && y == other.y && z == other.z && w == other.w;
 		}
 
-		bool NearlyEquals(const Quaternion& other, float32 epsilon = EPSILON_f32) const
+		constexpr bool NearlyEquals(const Quaternion& other, float32 epsilon = EPSILON_f32) const
 		{
 			return Absolute(x - other.x) < epsilon &&
 				Absolute(y - other.y) < epsilon &&
@@ -235,12 +280,12 @@ namespace math
 		}
 	};
 
-	inline float32 Dot(const Quaternion& a, const Quaternion& b)
+	constexpr float32 Dot(const Quaternion& a, const Quaternion& b)
 	{
 		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
 	}
 
-	inline Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float32 t)
+	constexpr Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float32 t)
 	{
 		Quaternion q0 = a;
 		Quaternion q1 = b;
@@ -256,7 +301,7 @@ namespace math
 		return result.Normalize();
 	}
 
-	inline Quaternion Slerp(const Quaternion& a, const Quaternion& b, float32 t)
+	constexpr Quaternion Slerp(const Quaternion& a, const Quaternion& b, float32 t)
 	{
 		Quaternion q0 = a.Normalize();
 		Quaternion q1 = b.Normalize();
@@ -274,16 +319,101 @@ namespace math
 			return Nlerp(q0, q1, t);
 		}
 
-		float32 theta = std::acos(dot);
-		float32 sinTheta = std::sin(theta);
+		float32 theta = Acos(dot);
+		float32 sinTheta = Sin(theta);
 
-		float32 w0 = std::sin((1.0f - t) * theta) / sinTheta;
-		float32 w1 = std::sin(t * theta) / sinTheta;
+		float32 w0 = Sin((1.0f - t) * theta) / sinTheta;
+		float32 w1 = Sin(t * theta) / sinTheta;
 
 		return q0 * w0 + q1 * w1;
 	}
 
-	inline Quaternion RotationBetween(const Vec3& from, const Vec3& to)
+	// POLYNOMIAL SLERP
+
+	enum class SlerpPrecision
+	{
+		Exact,		// Acos / Sin, same result as Slerp()
+		Accurate,	// 16-term series, max error 2e-7 (float32 rounding)
+		Fast		// 8-term series, max error 3e-5
+	};
+
+	// sin(t * theta) / sin(theta) as a series in x - 1, x = cos(theta), after Eberly,
+	// "A Fast and Accurate Algorithm for Computing SLERP". The last term is scaled by
+	// (1 + mu), mu fitted to minimize the max error over theta in [0, pi/2], t in [0, 1].
+	template<size_t Terms>
+	struct SlerpSeries
+	{
+		static_assert(Terms == 8 || Terms == 16);
+
+		static constexpr float64 MU = (Terms == 8) ? 0.85297780916711541 : 0.91666681062292643;
+
+		static constexpr std::array<float32, Terms> U = []()
+		{
+			std::array<float32, Terms> u{};
+			for (size_t i = 1; i <= Terms; ++i)
+			{
+				float64 scale = (i == Terms) ? 1.0 + MU : 1.0;
+				u[i - 1] = static_cast<float32>(scale / (i * (2.0 * i + 1.0)));
+			}
+			return u;
+		}();
+
+		static constexpr std::array<float32, Terms> V = []()
+		{
+			std::array<float32, Terms> v{};
+			for (size_t i = 1; i <= Terms; ++i)
+			{
+				float64 scale = (i == Terms) ? 1.0 + MU : 1.0;
+				v[i - 1] = static_cast<float32>(scale * i / (2.0 * i + 1.0));
+			}
+			return v;
+		}();
+	};
+
+	template<size_t Terms>
+	constexpr float32 SlerpCoefficient(float32 t, float32 xm1)
+	{
+		using S = SlerpSeries<Terms>;
+
+		float32 sqrT = t * t;
+		float32 result = 1.0f;
+		for (size_t i = Terms; i-- > 0;)
+		{
+			result = 1.0f + (S::U[i] * sqrT - S::V[i]) * xm1 * result;
+		}
+		return t * result;
+	}
+
+	template<size_t Terms>
+	constexpr Quaternion SlerpPolynomial(const Quaternion& a, const Quaternion& b, float32 t)
+	{
+		float32 x = Dot(a, b);
+		float32 sign = 1.0f;
+		if (x < 0.0f)
+		{
+			x = -x;
+			sign = -1.0f;
+		}
+
+		float32 xm1 = x - 1.0f;
+		float32 c0 = SlerpCoefficient<Terms>(1.0f - t, xm1);
+		float32 c1 = SlerpCoefficient<Terms>(t, xm1) * sign;
+
+		return a * c0 + b * c1;
+	}
+
+	// Inputs must be unit quaternions for the polynomial tiers.
+	constexpr Quaternion Slerp(const Quaternion& a, const Quaternion& b, float32 t, SlerpPrecision precision)
+	{
+		switch (precision)
+		{
+		case SlerpPrecision::Accurate: return SlerpPolynomial<16>(a, b, t);
+		case SlerpPrecision::Fast: return SlerpPolynomial<8>(a, b, t);
+		default: return Slerp(a, b, t);
+		}
+	}
+
+	constexpr Quaternion RotationBetween(const Vec3& from, const Vec3& to)
 	{
 		Vec3 f = from.Normalize();
 		Vec3 t = to.Normalize();
@@ -305,7 +435,7 @@ namespace math
 		}
 
 		Vec3 axis = Cross(f, t);
-		float32 s = std::sqrt((1.0f + dot) * 2.0f);
+		float32 s = Sqrt((1.0f + dot) * 2.0f);
 		float32 invS = 1.0f / s;
 
 		return Quaternion(
@@ -316,7 +446,7 @@ namespace math
 		).Normalize();
 	}
 
-	inline Quaternion LookRotation(const Vec3& forward, const Vec3& up = Vec3(0, 1, 0))
+	constexpr Quaternion LookRotation(const Vec3& forward, const Vec3& up = Vec3(0, 1, 0))
 	{
 		Vec3 f = forward.Normalize();
 		Vec3 r = Cross(up, f).Normalize();
@@ -330,11 +460,26 @@ namespace math
 		return Quaternion::FromRotationMatrix(rotMat);
 	}
 
-	inline float32 AngleBetween(const Quaternion& a, const Quaternion& b)
+	constexpr float32 AngleBetween(const Quaternion& a, const Quaternion& b)
 	{
 		float32 dot = Dot(a.Normalize(), b.Normalize());
 		dot = Clamp(dot, -1.0f, 1.0f);
-		return std::acos(Absolute(dot)) * 2.0f;
+		return Acos(Absolute(dot)) * 2.0f;
+	}
+
+	// BATCHED ROTATION
+
+	static_assert(sizeof(Quaternion) == 4 * sizeof(float32) && sizeof(Vec3) == 3 * sizeof(float32), "Batched rotation reads packed floats");
+
+	// out[i] = q * vectors[i] for unit q, one simd::Dispatch pack of vectors per iteration.
+	// out may alias vectors.
+	inline void Rotate(const Quaternion& q, std::span<const Vec3> vectors, std::span<Vec3> out)
+	{
+		assert(out.size() >= vectors.size());
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::RotateVec3<W>(&q.x, reinterpret_cast<const float32*>(vectors.data()), reinterpret_cast<float32*>(out.data()), vectors.size());
+		});
 	}
 }
 
@@ -0,0 +1,1587 @@
+#ifndef MATHLIB_SIMD_HPP
+#define MATHLIB_SIMD_HPP
+#pragma once
+
+#include <math/common.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <vector>
+
+// ISA SELECTION
+// Backends are picked from the compiler's target flags (-msse4.1, -mavx2, /arch:AVX2...).
+// Define MATHLIB_NO_SIMD to force the scalar fallback, MATHLIB_NO_FMA to keep
+// multiply-add unfused (bit-identical to the scalar code).
+
+#if !defined(MATHLIB_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define MATHLIB_SSE2 1
+	#endif
+	#if defined(MATHLIB_SSE2) && (defined(__SSE4_1__) || defined(__AVX__))
+		#define MATHLIB_SSE41 1
+	#endif
+	#if defined(MATHLIB_SSE41) && defined(__AVX2__)
+		#define MATHLIB_AVX2 1
+	#endif
+	#if defined(MATHLIB_AVX2) && !defined(MATHLIB_NO_FMA) && (defined(__FMA__) || defined(_MSC_VER))
+		#define MATHLIB_FMA 1
+	#endif
+#endif
+
+// RUNTIME DISPATCH SELECTION
+// On x86-64 the batched kernels are also built for AVX2 and AVX-512 and picked from
+// CPUID at run time (see RUNTIME DISPATCH). GCC / Clang need optimization for this, the
+// wide kernels are flattened into their target-attributed entry points. Define
+// MATHLIB_NO_DISPATCH to keep the compile-time width only.
+
+#if defined(MATHLIB_SSE2) && !defined(MATHLIB_NO_DISPATCH) && (defined(_M_X64) || defined(__x86_64__)) && (defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(__clang__)))
+	#define MATHLIB_DISPATCH 1
+#endif
+
+#if defined(MATHLIB_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+	#define MATHLIB_TARGET_AVX2 __attribute__((target("avx2")))
+	#define MATHLIB_TARGET_AVX512 __attribute__((target("avx512f")))
+	#define MATHLIB_FLATTEN __attribute__((flatten))
+#else
+	#define MATHLIB_TARGET_AVX2
+	#define MATHLIB_TARGET_AVX512
+	#define MATHLIB_FLATTEN
+#endif
+
+#if defined(MATHLIB_SSE2)
+	#include <immintrin.h>
+#endif
+
+#if defined(MATHLIB_DISPATCH)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+// Batched kernels switch to non-temporal stores above this output size (bytes).
+#if !defined(MATHLIB_STREAMING_STORE_BYTES)
+	#define MATHLIB_STREAMING_STORE_BYTES (8u << 20)
+#endif
+
+namespace math::simd
+{
+	// GENERIC (SCALAR) PACK
+
+	template<typename T, size_t W>
+	struct Mask
+	{
+		std::array<bool, W> lanes{};
+
+		bool operator[](size_t i) const { return lanes[i]; }
+
+		friend Mask operator&(const Mask& a, const Mask& b) { Mask r; for (size_t i = 0; i < W; ++i) r.lanes[i] = a.lanes[i] && b.lanes[i]; return r; }
+		friend Mask operator|(const Mask& a, const Mask& b) { Mask r; for (size_t i = 0; i < W; ++i) r.lanes[i] = a.lanes[i] || b.lanes[i]; return r; }
+		friend Mask operator^(const Mask& a, const Mask& b) { Mask r; for (size_t i = 0; i < W; ++i) r.lanes[i] = a.lanes[i] != b.lanes[i]; return r; }
+		Mask operator~() const { Mask r; for (size_t i = 0; i < W; ++i) r.lanes[i] = !lanes[i]; return r; }
+
+		uint32 Bits() const
+		{
+			uint32 bits = 0;
+			for (size_t i = 0; i < W; ++i)
+			{
+				bits |= static_cast<uint32>(lanes[i]) << i;
+			}
+			return bits;
+		}
+	};
+
+	template<typename T, size_t W>
+	struct Pack
+	{
+		std::array<T, W> lanes{};
+
+		using value_type = T;
+		static constexpr size_t width = W;
+
+		static Pack Zero() { return Pack(); }
+
+		static Pack Broadcast(T value)
+		{
+			Pack r;
+			r.lanes.fill(value);
+			return r;
+		}
+
+		static Pack Load(const T* src) { return LoadPartial(src, W); }
+		static Pack LoadAligned(const T* src) { return LoadPartial(src, W); }
+
+		static Pack LoadPartial(const T* src, size_t count)
+		{
+			Pack r;
+			for (size_t i = 0; i < count; ++i) r.lanes[i] = src[i];
+			return r;
+		}
+
+		void Store(T* dst) const { StorePartial(dst, W); }
+		void StoreAligned(T* dst) const { StorePartial(dst, W); }
+
+		void StorePartial(T* dst, size_t count) const
+		{
+			for (size_t i = 0; i < count; ++i) dst[i] = lanes[i];
+		}
+
+		T operator[](size_t i) const { return lanes[i]; }
+
+		template<typename F>
+		static Pack Map(const Pack& a, const Pack& b, F f)
+		{
+			Pack r;
+			for (size_t i = 0; i < W; ++i) r.lanes[i] = f(a.lanes[i], b.lanes[i]);
+			return r;
+		}
+
+		template<typename F>
+		static Mask<T, W> Compare(const Pack& a, const Pack& b, F f)
+		{
+			Mask<T, W> r;
+			for (size_t i = 0; i < W; ++i) r.lanes[i] = f(a.lanes[i], b.lanes[i]);
+			return r;
+		}
+
+		friend Pack operator+(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return x + y; }); }
+		friend Pack operator-(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return x - y; }); }
+		friend Pack operator*(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return x * y; }); }
+		friend Pack operator/(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return x / y; }); }
+		Pack operator-() const { return Map(Zero(), *this, [](T x, T y) { return x - y; }); }
+
+		friend Mask<T, W> operator<(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x < y; }); }
+		friend Mask<T, W> operator<=(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x <= y; }); }
+		friend Mask<T, W> operator>(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x > y; }); }
+		friend Mask<T, W> operator>=(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x >= y; }); }
+		friend Mask<T, W> operator==(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x == y; }); }
+		friend Mask<T, W> operator!=(const Pack& a, const Pack& b) { return Compare(a, b, [](T x, T y) { return x != y; }); }
+
+		friend Pack Min(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return (y < x) ? y : x; }); }
+		friend Pack Max(const Pack& a, const Pack& b) { return Map(a, b, [](T x, T y) { return (x < y) ? y : x; }); }
+		friend Pack Abs(const Pack& a) { return Map(a, a, [](T x, T) { return (x < T(0)) ? -x : x; }); }
+		friend Pack Sqrt(const Pack& a) { return Map(a, a, [](T x, T) { return static_cast<T>(std::sqrt(x)); }); }
+		friend Pack Rsqrt(const Pack& a) { return Map(a, a, [](T x, T) { return static_cast<T>(T(1) / std::sqrt(x)); }); }
+
+		friend Pack MulAdd(const Pack& a, const Pack& b, const Pack& c)
+		{
+			Pack r;
+			for (size_t i = 0; i < W; ++i) r.lanes[i] = a.lanes[i] * b.lanes[i] + c.lanes[i];
+			return r;
+		}
+
+		friend Pack Select(const Mask<T, W>& m, const Pack& a, const Pack& b)
+		{
+			Pack r;
+			for (size_t i = 0; i < W; ++i) r.lanes[i] = m.lanes[i] ? a.lanes[i] : b.lanes[i];
+			return r;
+		}
+
+		friend T ReduceAdd(const Pack& a)
+		{
+			T sum = 0;
+			for (size_t i = 0; i < W; ++i) sum += a.lanes[i];
+			return sum;
+		}
+	};
+
+#if defined(MATHLIB_SSE2)
+
+	// SSE PACK (4 x float32)
+
+	template<>
+	struct Mask<float32, 4>
+	{
+		__m128 m;
+
+		bool operator[](size_t i) const { return (Bits() >> i) & 1u; }
+
+		friend Mask operator&(Mask a, Mask b) { return { _mm_and_ps(a.m, b.m) }; }
+		friend Mask operator|(Mask a, Mask b) { return { _mm_or_ps(a.m, b.m) }; }
+		friend Mask operator^(Mask a, Mask b) { return { _mm_xor_ps(a.m, b.m) }; }
+		Mask operator~() const { return { _mm_xor_ps(m, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+
+		uint32 Bits() const { return static_cast<uint32>(_mm_movemask_ps(m)); }
+	};
+
+	template<>
+	struct Pack<float32, 4>
+	{
+		__m128 v;
+
+		using value_type = float32;
+		static constexpr size_t width = 4;
+
+		static Pack Zero() { return { _mm_setzero_ps() }; }
+		static Pack Broadcast(float32 value) { return { _mm_set1_ps(value) }; }
+		static Pack Load(const float32* src) { return { _mm_loadu_ps(src) }; }
+		static Pack LoadAligned(const float32* src) { return { _mm_load_ps(src) }; }
+
+		static Pack LoadPartial(const float32* src, size_t count)
+		{
+			switch (count)
+			{
+			case 4: return Load(src);
+			case 3: return { _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src)), _mm_load_ss(src + 2)) };
+			case 2: return { _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(src)) };
+			case 1: return { _mm_load_ss(src) };
+			default: return Zero();
+			}
+		}
+
+		void Store(float32* dst) const { _mm_storeu_ps(dst, v); }
+		void StoreAligned(float32* dst) const { _mm_store_ps(dst, v); }
+
+		void StorePartial(float32* dst, size_t count) const
+		{
+			switch (count)
+			{
+			case 4: Store(dst); break;
+			case 3: _mm_storel_pi(reinterpret_cast<__m64*>(dst), v); _mm_store_ss(dst + 2, _mm_movehl_ps(v, v)); break;
+			case 2: _mm_storel_pi(reinterpret_cast<__m64*>(dst), v); break;
+			case 1: _mm_store_ss(dst, v); break;
+			default: break;
+			}
+		}
+
+		float32 operator[](size_t i) const
+		{
+			alignas(16) float32 tmp[4];
+			_mm_store_ps(tmp, v);
+			return tmp[i];
+		}
+
+		friend Pack operator+(Pack a, Pack b) { return { _mm_add_ps(a.v, b.v) }; }
+		friend Pack operator-(Pack a, Pack b) { return { _mm_sub_ps(a.v, b.v) }; }
+		friend Pack operator*(Pack a, Pack b) { return { _mm_mul_ps(a.v, b.v) }; }
+		friend Pack operator/(Pack a, Pack b) { return { _mm_div_ps(a.v, b.v) }; }
+		Pack operator-() const { return { _mm_xor_ps(v, _mm_set1_ps(-0.0f)) }; }
+
+		friend Mask<float32, 4> operator<(Pack a, Pack b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+		friend Mask<float32, 4> operator<=(Pack a, Pack b) { return { _mm_cmple_ps(a.v, b.v) }; }
+		friend Mask<float32, 4> operator>(Pack a, Pack b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+		friend Mask<float32, 4> operator>=(Pack a, Pack b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+		friend Mask<float32, 4> operator==(Pack a, Pack b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+		friend Mask<float32, 4> operator!=(Pack a, Pack b) { return { _mm_cmpneq_ps(a.v, b.v) }; }
+
+		friend Pack Min(Pack a, Pack b) { return { _mm_min_ps(a.v, b.v) }; }
+		friend Pack Max(Pack a, Pack b) { return { _mm_max_ps(a.v, b.v) }; }
+		friend Pack Abs(Pack a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+		friend Pack Sqrt(Pack a) { return { _mm_sqrt_ps(a.v) }; }
+		friend Pack Rsqrt(Pack a) { return { _mm_rsqrt_ps(a.v) }; }
+
+		friend Pack MulAdd(Pack a, Pack b, Pack c)
+		{
+#if defined(MATHLIB_FMA)
+			return { _mm_fmadd_ps(a.v, b.v, c.v) };
+#else
+			return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) };
+#endif
+		}
+
+		friend Pack Select(Mask<float32, 4> m, Pack a, Pack b)
+		{
+#if defined(MATHLIB_SSE41)
+			return { _mm_blendv_ps(b.v, a.v, m.m) };
+#else
+			return { _mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)) };
+#endif
+		}
+
+		friend float32 ReduceAdd(Pack a)
+		{
+			__m128 shuf = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+			__m128 sums = _mm_add_ps(a.v, shuf);
+			shuf = _mm_movehl_ps(shuf, sums);
+			sums = _mm_add_ss(sums, shuf);
+			return _mm_cvtss_f32(sums);
+		}
+	};
+
+#endif // MATHLIB_SSE2
+
+#if defined(MATHLIB_AVX2) || defined(MATHLIB_DISPATCH)
+
+	// AVX PACK (8 x float32)
+
+	template<>
+	struct Mask<float32, 8>
+	{
+		__m256 m;
+
+		MATHLIB_TARGET_AVX2 bool operator[](size_t i) const { return (Bits() >> i) & 1u; }
+
+		MATHLIB_TARGET_AVX2 friend Mask operator&(Mask a, Mask b) { return { _mm256_and_ps(a.m, b.m) }; }
+		MATHLIB_TARGET_AVX2 friend Mask operator|(Mask a, Mask b) { return { _mm256_or_ps(a.m, b.m) }; }
+		MATHLIB_TARGET_AVX2 friend Mask operator^(Mask a, Mask b) { return { _mm256_xor_ps(a.m, b.m) }; }
+		MATHLIB_TARGET_AVX2 Mask operator~() const { return { _mm256_xor_ps(m, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+
+		MATHLIB_TARGET_AVX2 uint32 Bits() const { return static_cast<uint32>(_mm256_movemask_ps(m)); }
+	};
+
+	template<>
+	struct Pack<float32, 8>
+	{
+		__m256 v;
+
+		using value_type = float32;
+		static constexpr size_t width = 8;
+
+		MATHLIB_TARGET_AVX2 static Pack Zero() { return { _mm256_setzero_ps() }; }
+		MATHLIB_TARGET_AVX2 static Pack Broadcast(float32 value) { return { _mm256_set1_ps(value) }; }
+		MATHLIB_TARGET_AVX2 static Pack Load(const float32* src) { return { _mm256_loadu_ps(src) }; }
+		MATHLIB_TARGET_AVX2 static Pack LoadAligned(const float32* src) { return { _mm256_load_ps(src) }; }
+
+		MATHLIB_TARGET_AVX2 static Pack LoadPartial(const float32* src, size_t count)
+		{
+			if (count >= 8) return Load(src);
+			const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+			const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32>(count)), lane);
+			return { _mm256_maskload_ps(src, mask) };
+		}
+
+		MATHLIB_TARGET_AVX2 void Store(float32* dst) const { _mm256_storeu_ps(dst, v); }
+		MATHLIB_TARGET_AVX2 void StoreAligned(float32* dst) const { _mm256_store_ps(dst, v); }
+
+		MATHLIB_TARGET_AVX2 void StorePartial(float32* dst, size_t count) const
+		{
+			if (count >= 8) { Store(dst); return; }
+			const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+			const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32>(count)), lane);
+			_mm256_maskstore_ps(dst, mask, v);
+		}
+
+		MATHLIB_TARGET_AVX2 float32 operator[](size_t i) const
+		{
+			alignas(32) float32 tmp[8];
+			_mm256_store_ps(tmp, v);
+			return tmp[i];
+		}
+
+		MATHLIB_TARGET_AVX2 friend Pack operator+(Pack a, Pack b) { return { _mm256_add_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack operator-(Pack a, Pack b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack operator*(Pack a, Pack b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack operator/(Pack a, Pack b) { return { _mm256_div_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 Pack operator-() const { return { _mm256_xor_ps(v, _mm256_set1_ps(-0.0f)) }; }
+
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator<(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator<=(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator>(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator>=(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator==(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+		MATHLIB_TARGET_AVX2 friend Mask<float32, 8> operator!=(Pack a, Pack b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ) }; }
+
+		MATHLIB_TARGET_AVX2 friend Pack Min(Pack a, Pack b) { return { _mm256_min_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack Max(Pack a, Pack b) { return { _mm256_max_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack Abs(Pack a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack Sqrt(Pack a) { return { _mm256_sqrt_ps(a.v) }; }
+		MATHLIB_TARGET_AVX2 friend Pack Rsqrt(Pack a) { return { _mm256_rsqrt_ps(a.v) }; }
+
+		MATHLIB_TARGET_AVX2 friend Pack MulAdd(Pack a, Pack b, Pack c)
+		{
+#if defined(MATHLIB_FMA)
+			return { _mm256_fmadd_ps(a.v, b.v, c.v) };
+#else
+			return { _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v) };
+#endif
+		}
+
+		MATHLIB_TARGET_AVX2 friend Pack Select(Mask<float32, 8> m, Pack a, Pack b) { return { _mm256_blendv_ps(b.v, a.v, m.m) }; }
+
+		MATHLIB_TARGET_AVX2 friend float32 ReduceAdd(Pack a)
+		{
+			__m128 lo = _mm256_castps256_ps128(a.v);
+			__m128 hi = _mm256_extractf128_ps(a.v, 1);
+			return ReduceAdd(Pack<float32, 4>{ _mm_add_ps(lo, hi) });
+		}
+	};
+
+#endif // MATHLIB_AVX2 || MATHLIB_DISPATCH
+
+#if defined(MATHLIB_DISPATCH)
+
+	// AVX-512 PACK (16 x float32)
+	// Only reached through Dispatch(), NativeWidth stays at 8. Multiply-adds are fused,
+	// results may differ from the narrower paths in the last bit.
+
+	template<>
+	struct Mask<float32, 16>
+	{
+		__mmask16 m;
+
+		bool operator[](size_t i) const { return (m >> i) & 1u; }
+
+		friend Mask operator&(Mask a, Mask b) { return { static_cast<__mmask16>(a.m & b.m) }; }
+		friend Mask operator|(Mask a, Mask b) { return { static_cast<__mmask16>(a.m | b.m) }; }
+		friend Mask operator^(Mask a, Mask b) { return { static_cast<__mmask16>(a.m ^ b.m) }; }
+		Mask operator~() const { return { static_cast<__mmask16>(~m) }; }
+
+		uint32 Bits() const { return m; }
+	};
+
+	template<>
+	struct Pack<float32, 16>
+	{
+		__m512 v;
+
+		using value_type = float32;
+		static constexpr size_t width = 16;
+
+		MATHLIB_TARGET_AVX512 static Pack Zero() { return { _mm512_setzero_ps() }; }
+		MATHLIB_TARGET_AVX512 static Pack Broadcast(float32 value) { return { _mm512_set1_ps(value) }; }
+		MATHLIB_TARGET_AVX512 static Pack Load(const float32* src) { return { _mm512_loadu_ps(src) }; }
+		MATHLIB_TARGET_AVX512 static Pack LoadAligned(const float32* src) { return { _mm512_load_ps(src) }; }
+
+		MATHLIB_TARGET_AVX512 static Pack LoadPartial(const float32* src, size_t count)
+		{
+			if (count >= 16) return Load(src);
+			return { _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << count) - 1u), src) };
+		}
+
+		MATHLIB_TARGET_AVX512 void Store(float32* dst) const { _mm512_storeu_ps(dst, v); }
+		MATHLIB_TARGET_AVX512 void StoreAligned(float32* dst) const { _mm512_store_ps(dst, v); }
+
+		MATHLIB_TARGET_AVX512 void StorePartial(float32* dst, size_t count) const
+		{
+			if (count >= 16) { Store(dst); return; }
+			_mm512_mask_storeu_ps(dst, static_cast<__mmask16>((1u << count) - 1u), v);
+		}
+
+		MATHLIB_TARGET_AVX512 float32 operator[](size_t i) const
+		{
+			alignas(64) float32 tmp[16];
+			_mm512_store_ps(tmp, v);
+			return tmp[i];
+		}
+
+		MATHLIB_TARGET_AVX512 friend Pack operator+(Pack a, Pack b) { return { _mm512_add_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack operator-(Pack a, Pack b) { return { _mm512_sub_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack operator*(Pack a, Pack b) { return { _mm512_mul_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack operator/(Pack a, Pack b) { return { _mm512_div_ps(a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 Pack operator-() const { return { _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi32(INT32_MIN))) }; }
+
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator<(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator<=(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ) }; }
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator>(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ) }; }
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator>=(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ) }; }
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator==(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ) }; }
+		MATHLIB_TARGET_AVX512 friend Mask<float32, 16> operator!=(Pack a, Pack b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ) }; }
+
+		// Full zero-masked forms: GCC 12 flags the _mm512_undefined_ps() inside the unmasked
+		// ones with -Wmaybe-uninitialized. Same instructions.
+		MATHLIB_TARGET_AVX512 friend Pack Min(Pack a, Pack b) { return { _mm512_maskz_min_ps(0xFFFF, a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack Max(Pack a, Pack b) { return { _mm512_maskz_max_ps(0xFFFF, a.v, b.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack Abs(Pack a) { return { _mm512_abs_ps(a.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack Sqrt(Pack a) { return { _mm512_maskz_sqrt_ps(0xFFFF, a.v) }; }
+		MATHLIB_TARGET_AVX512 friend Pack Rsqrt(Pack a) { return { _mm512_rsqrt14_ps(a.v) }; }
+
+		// AVX-512F implies FMA, the compiler contracts a * b + c anyway.
+		MATHLIB_TARGET_AVX512 friend Pack MulAdd(Pack a, Pack b, Pack c) { return { _mm512_fmadd_ps(a.v, b.v, c.v) }; }
+
+		MATHLIB_TARGET_AVX512 friend Pack Select(Mask<float32, 16> m, Pack a, Pack b) { return { _mm512_mask_blend_ps(m.m, b.v, a.v) }; }
+
+		MATHLIB_TARGET_AVX512 friend float32 ReduceAdd(Pack a) { return _mm512_reduce_add_ps(a.v); }
+	};
+
+#endif // MATHLIB_DISPATCH
+
+	// ALIGNED STORAGE
+
+	constexpr size_t ALIGNMENT = 64;
+
+	template<typename T, size_t Align = ALIGNMENT>
+	struct AlignedAllocator
+	{
+		using value_type = T;
+
+		template<typename U>
+		struct rebind { using other = AlignedAllocator<U, Align>; };
+
+		AlignedAllocator() = default;
+
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Align)));
+		}
+
+		void deallocate(T* ptr, size_t)
+		{
+			::operator delete(ptr, std::align_val_t(Align));
+		}
+
+		friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+		friend bool operator!=(const AlignedAllocator&, const AlignedAllocator&) { return false; }
+	};
+
+	template<typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+	// DISPATCH HELPERS
+
+	template<typename T>
+	constexpr size_t NativeWidth =
+#if defined(MATHLIB_AVX2)
+		std::is_same_v<T, float32> ? 8 :
+#elif defined(MATHLIB_SSE2)
+		std::is_same_v<T, float32> ? 4 :
+#endif
+		1;
+
+	template<typename T>
+	using NativePack = Pack<T, NativeWidth<T>>;
+
+	// Calls f(index, lanes) over [0, count) in W steps, the last call may be partial.
+	template<typename T, size_t W = NativeWidth<T>, typename F>
+	void ForEachPack(size_t count, F&& f)
+	{
+		size_t i = 0;
+		for (; i + W <= count; i += W)
+		{
+			f(i, W);
+		}
+		if (i < count)
+		{
+			f(i, count - i);
+		}
+	}
+
+	// RUNTIME DISPATCH
+	// The widest float32 path the CPU and OS support is detected once; MATHLIB_ISA
+	// (scalar, sse2, avx2, avx512) in the environment or SetIsa() can force a lower one.
+	// Without MATHLIB_DISPATCH the compile-time width is the only path.
+
+	enum class Isa : uint32
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		AVX512
+	};
+
+	inline const char* IsaName(Isa isa)
+	{
+		switch (isa)
+		{
+		case Isa::SSE2: return "sse2";
+		case Isa::AVX2: return "avx2";
+		case Isa::AVX512: return "avx512";
+		default: return "scalar";
+		}
+	}
+
+	// Level the batched float32 kernels are compiled at when nothing is dispatched.
+	constexpr Isa CompiledIsa()
+	{
+		if constexpr (NativeWidth<float32> >= 8) return Isa::AVX2;
+		else if constexpr (NativeWidth<float32> >= 4) return Isa::SSE2;
+		else return Isa::Scalar;
+	}
+
+#if defined(MATHLIB_DISPATCH)
+	namespace detail
+	{
+		inline void Cpuid(uint32 leaf, uint32 subleaf, uint32 regs[4])
+		{
+#if defined(_MSC_VER)
+			int out[4];
+			__cpuidex(out, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (size_t i = 0; i < 4; ++i) regs[i] = static_cast<uint32>(out[i]);
+#else
+			if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+			{
+				regs[0] = regs[1] = regs[2] = regs[3] = 0;
+			}
+#endif
+		}
+
+		// XCR0: register state the OS saves on context switch.
+		inline uint64 Xgetbv()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			uint32 lo, hi;
+			__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return (static_cast<uint64>(hi) << 32) | lo;
+#endif
+		}
+
+		inline Isa QueryIsa()
+		{
+			uint32 regs[4];
+			Cpuid(0, 0, regs);
+			const uint32 maxLeaf = regs[0];
+
+			Cpuid(1, 0, regs);
+			const bool osxsave = (regs[2] >> 27) & 1u;
+			const bool avx = (regs[2] >> 28) & 1u;
+			if (!osxsave || !avx || maxLeaf < 7) return Isa::SSE2;
+
+			const uint64 xcr0 = Xgetbv();
+			if ((xcr0 & 0x6) != 0x6) return Isa::SSE2;
+
+			Cpuid(7, 0, regs);
+			const bool avx2 = (regs[1] >> 5) & 1u;
+			const bool avx512f = (regs[1] >> 16) & 1u;
+			if (!avx2) return Isa::SSE2;
+#if !defined(MATHLIB_NO_FMA)
+			if (avx512f && (xcr0 & 0xE6) == 0xE6) return Isa::AVX512;
+#endif
+			return Isa::AVX2;
+		}
+	}
+#endif
+
+	// Widest level usable on this machine.
+	inline Isa DetectIsa()
+	{
+#if defined(MATHLIB_DISPATCH)
+		static const Isa detected = detail::QueryIsa();
+		return detected;
+#else
+		return CompiledIsa();
+#endif
+	}
+
+	namespace detail
+	{
+		inline Isa IsaFromEnvironment(Isa fallback)
+		{
+#if defined(_MSC_VER)
+#pragma warning(suppress : 4996)
+#endif
+			const char* value = std::getenv("MATHLIB_ISA");
+			if (value == nullptr) return fallback;
+
+			const std::string_view name = value;
+			for (Isa isa : { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512 })
+			{
+				if (name == IsaName(isa)) return isa;
+			}
+			return fallback;
+		}
+
+		inline Isa Clamp(Isa isa)
+		{
+			return static_cast<uint32>(isa) < static_cast<uint32>(DetectIsa()) ? isa : DetectIsa();
+		}
+
+		inline std::atomic<Isa>& ActiveIsaSlot()
+		{
+			static std::atomic<Isa> active{ Clamp(IsaFromEnvironment(DetectIsa())) };
+			return active;
+		}
+	}
+
+	// Level used by Dispatch(), resolved on first use.
+	inline Isa ActiveIsa()
+	{
+		return detail::ActiveIsaSlot().load(std::memory_order_relaxed);
+	}
+
+	// Forces a level for the following calls, clamped to DetectIsa(). Returns the level set.
+	inline Isa SetIsa(Isa isa)
+	{
+		isa = detail::Clamp(isa);
+		detail::ActiveIsaSlot().store(isa, std::memory_order_relaxed);
+		return isa;
+	}
+
+#if defined(MATHLIB_DISPATCH)
+	namespace detail
+	{
+		// Everything f inlines is compiled for the target, the packs never cross a call boundary.
+		template<typename F>
+		MATHLIB_TARGET_AVX2 MATHLIB_FLATTEN void RunAvx2(F& f) { f.template operator()<8>(); }
+
+		template<typename F>
+		MATHLIB_TARGET_AVX512 MATHLIB_FLATTEN void RunAvx512(F& f) { f.template operator()<16>(); }
+	}
+#endif
+
+	// Calls f.template operator()<W>() with the pack width of the active level, e.g.
+	// Dispatch<float32>([&]<size_t W>() { ForEachPack<float32, W>(...); }). Types
+	// other than float32 always run at NativeWidth<T>.
+	template<typename T, typename F>
+	void Dispatch(F&& f)
+	{
+		if constexpr (std::is_same_v<T, float32>)
+		{
+			switch (ActiveIsa())
+			{
+			case Isa::Scalar:
+				f.template operator()<1>();
+				return;
+			case Isa::SSE2:
+				f.template operator()<4>();
+				return;
+#if defined(MATHLIB_DISPATCH)
+			case Isa::AVX2:
+				detail::RunAvx2(f);
+				return;
+			case Isa::AVX512:
+				detail::RunAvx512(f);
+				return;
+#endif
+			default:
+				break;
+			}
+		}
+		f.template operator()<NativeWidth<T>>();
+	}
+
+	// Vec<3, float32> and Vec<4, float32> live in one 128-bit register, Vec3 with a zero padding lane.
+	template<size_t N, typename T>
+	constexpr bool IsPackable =
+#if defined(MATHLIB_SSE2)
+		std::is_same_v<T, float32> && (N == 3 || N == 4);
+#else
+		false;
+#endif
+
+	template<size_t N, typename T>
+	Pack<T, 4> LoadVec(const T* src)
+	{
+		return Pack<T, 4>::LoadPartial(src, N);
+	}
+
+	template<size_t N, typename T>
+	void StoreVec(const Pack<T, 4>& p, T* dst)
+	{
+		p.StorePartial(dst, N);
+	}
+
+	// Sum of the first N lanes, the padding lane of a Vec3 is zero.
+	template<size_t N>
+	float32 Dot(const Pack<float32, 4>& a, const Pack<float32, 4>& b)
+	{
+#if defined(MATHLIB_SSE41)
+		return _mm_cvtss_f32(_mm_dp_ps(a.v, b.v, N == 3 ? 0x71 : 0xF1));
+#else
+		return ReduceAdd(a * b);
+#endif
+	}
+
+	// 1 / sqrt(x) at the given SqrtPrecision. Without a hardware estimate (scalar
+	// fallback, float64, constant evaluation) every tier is exact.
+	template<typename P> requires (!std::floating_point<P>)
+	P InvSqrt(const P& x, SqrtPrecision precision)
+	{
+		using T = typename P::value_type;
+
+		if (precision == SqrtPrecision::Exact)
+		{
+			return P::Broadcast(T(1)) / Sqrt(x);
+		}
+
+		P y = Rsqrt(x);
+		if (precision == SqrtPrecision::Accurate)
+		{
+			P halfX = x * P::Broadcast(T(0.5));
+			y = y * MulAdd(-(halfX * y), y, P::Broadcast(T(1.5)));
+		}
+		return y;
+	}
+
+	template<std::floating_point T>
+	constexpr T InvSqrt(T x, [[maybe_unused]] SqrtPrecision precision)
+	{
+#if defined(MATHLIB_SSE2)
+		if constexpr (std::is_same_v<T, float32>)
+		{
+			if (precision != SqrtPrecision::Exact && !std::is_constant_evaluated())
+			{
+				float32 y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+				if (precision == SqrtPrecision::Accurate)
+				{
+					y = y * (1.5f - 0.5f * x * y * y);
+				}
+				return y;
+			}
+		}
+#endif
+		return T(1) / Sqrt(x);
+	}
+
+	// INTERLEAVED LOADS
+	// W consecutive x,y,z(,w) tuples <-> one register per component.
+
+	template<size_t W>
+	void LoadInterleaved3(const float32* src, Pack<float32, W>& x, Pack<float32, W>& y, Pack<float32, W>& z)
+	{
+		for (size_t i = 0; i < W; ++i)
+		{
+			x.lanes[i] = src[i * 3 + 0];
+			y.lanes[i] = src[i * 3 + 1];
+			z.lanes[i] = src[i * 3 + 2];
+		}
+	}
+
+	template<size_t W>
+	void StoreInterleaved3(float32* dst, const Pack<float32, W>& x, const Pack<float32, W>& y, const Pack<float32, W>& z)
+	{
+		for (size_t i = 0; i < W; ++i)
+		{
+			dst[i * 3 + 0] = x.lanes[i];
+			dst[i * 3 + 1] = y.lanes[i];
+			dst[i * 3 + 2] = z.lanes[i];
+		}
+	}
+
+	template<size_t W>
+	void StreamInterleaved3(float32* dst, const Pack<float32, W>& x, const Pack<float32, W>& y, const Pack<float32, W>& z)
+	{
+		StoreInterleaved3(dst, x, y, z);
+	}
+
+	template<size_t W>
+	void LoadInterleaved4(const float32* src, Pack<float32, W>& x, Pack<float32, W>& y, Pack<float32, W>& z, Pack<float32, W>& w)
+	{
+		for (size_t i = 0; i < W; ++i)
+		{
+			x.lanes[i] = src[i * 4 + 0];
+			y.lanes[i] = src[i * 4 + 1];
+			z.lanes[i] = src[i * 4 + 2];
+			w.lanes[i] = src[i * 4 + 3];
+		}
+	}
+
+	template<size_t W>
+	void StoreInterleaved4(float32* dst, const Pack<float32, W>& x, const Pack<float32, W>& y, const Pack<float32, W>& z, const Pack<float32, W>& w)
+	{
+		for (size_t i = 0; i < W; ++i)
+		{
+			dst[i * 4 + 0] = x.lanes[i];
+			dst[i * 4 + 1] = y.lanes[i];
+			dst[i * 4 + 2] = z.lanes[i];
+			dst[i * 4 + 3] = w.lanes[i];
+		}
+	}
+
+	inline void StreamFence()
+	{
+#if defined(MATHLIB_SSE2)
+		_mm_sfence();
+#endif
+	}
+
+#if defined(MATHLIB_SSE2)
+
+	// (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3) <-> (x0..x3) (y0..y3) (z0..z3)
+
+	inline void Deinterleave3(__m128 a, __m128 b, __m128 c, __m128& x, __m128& y, __m128& z)
+	{
+		__m128 xy = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+		__m128 yz = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+		x = _mm_shuffle_ps(a, xy, _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+		z = _mm_shuffle_ps(yz, c, _MM_SHUFFLE(3, 0, 3, 1));
+	}
+
+	inline void Interleave3(__m128 x, __m128 y, __m128 z, __m128& a, __m128& b, __m128& c)
+	{
+		__m128 xy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 yz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+		__m128 zx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+		a = _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+		b = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+		c = _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	inline void LoadInterleaved3(const float32* src, Pack<float32, 4>& x, Pack<float32, 4>& y, Pack<float32, 4>& z)
+	{
+		Deinterleave3(_mm_loadu_ps(src), _mm_loadu_ps(src + 4), _mm_loadu_ps(src + 8), x.v, y.v, z.v);
+	}
+
+	inline void StoreInterleaved3(float32* dst, const Pack<float32, 4>& x, const Pack<float32, 4>& y, const Pack<float32, 4>& z)
+	{
+		__m128 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		_mm_storeu_ps(dst, a);
+		_mm_storeu_ps(dst + 4, b);
+		_mm_storeu_ps(dst + 8, c);
+	}
+
+	// dst must be 16-byte aligned.
+	inline void StreamInterleaved3(float32* dst, const Pack<float32, 4>& x, const Pack<float32, 4>& y, const Pack<float32, 4>& z)
+	{
+		__m128 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		_mm_stream_ps(dst, a);
+		_mm_stream_ps(dst + 4, b);
+		_mm_stream_ps(dst + 8, c);
+	}
+
+	inline void LoadInterleaved4(const float32* src, Pack<float32, 4>& x, Pack<float32, 4>& y, Pack<float32, 4>& z, Pack<float32, 4>& w)
+	{
+		x.v = _mm_loadu_ps(src);
+		y.v = _mm_loadu_ps(src + 4);
+		z.v = _mm_loadu_ps(src + 8);
+		w.v = _mm_loadu_ps(src + 12);
+		_MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+	}
+
+	inline void StoreInterleaved4(float32* dst, Pack<float32, 4> x, Pack<float32, 4> y, Pack<float32, 4> z, Pack<float32, 4> w)
+	{
+		_MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+		_mm_storeu_ps(dst, x.v);
+		_mm_storeu_ps(dst + 4, y.v);
+		_mm_storeu_ps(dst + 8, z.v);
+		_mm_storeu_ps(dst + 12, w.v);
+	}
+
+#endif // MATHLIB_SSE2
+
+#if defined(MATHLIB_AVX2) || defined(MATHLIB_DISPATCH)
+
+	// Points 0-3 in the low 128-bit lane, 4-7 in the high one.
+
+	MATHLIB_TARGET_AVX2 inline void Deinterleave3(__m256 a, __m256 b, __m256 c, __m256& x, __m256& y, __m256& z)
+	{
+		__m256 xy = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+		__m256 yz = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+		x = _mm256_shuffle_ps(a, xy, _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+		z = _mm256_shuffle_ps(yz, c, _MM_SHUFFLE(3, 0, 3, 1));
+	}
+
+	MATHLIB_TARGET_AVX2 inline void Interleave3(__m256 x, __m256 y, __m256 z, __m256& a, __m256& b, __m256& c)
+	{
+		__m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+		__m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+		__m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+		a = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+		b = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+		c = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+	}
+
+	MATHLIB_TARGET_AVX2 inline void LoadInterleaved3(const float32* src, Pack<float32, 8>& x, Pack<float32, 8>& y, Pack<float32, 8>& z)
+	{
+		__m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 12), 1);
+		__m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 16), 1);
+		__m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 20), 1);
+		Deinterleave3(a, b, c, x.v, y.v, z.v);
+	}
+
+	MATHLIB_TARGET_AVX2 inline void StoreInterleaved3(float32* dst, const Pack<float32, 8>& x, const Pack<float32, 8>& y, const Pack<float32, 8>& z)
+	{
+		__m256 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		_mm_storeu_ps(dst, _mm256_castps256_ps128(a));
+		_mm_storeu_ps(dst + 4, _mm256_castps256_ps128(b));
+		_mm_storeu_ps(dst + 8, _mm256_castps256_ps128(c));
+		_mm_storeu_ps(dst + 12, _mm256_extractf128_ps(a, 1));
+		_mm_storeu_ps(dst + 16, _mm256_extractf128_ps(b, 1));
+		_mm_storeu_ps(dst + 20, _mm256_extractf128_ps(c, 1));
+	}
+
+	// dst must be 16-byte aligned.
+	MATHLIB_TARGET_AVX2 inline void StreamInterleaved3(float32* dst, const Pack<float32, 8>& x, const Pack<float32, 8>& y, const Pack<float32, 8>& z)
+	{
+		__m256 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		_mm_stream_ps(dst, _mm256_castps256_ps128(a));
+		_mm_stream_ps(dst + 4, _mm256_castps256_ps128(b));
+		_mm_stream_ps(dst + 8, _mm256_castps256_ps128(c));
+		_mm_stream_ps(dst + 12, _mm256_extractf128_ps(a, 1));
+		_mm_stream_ps(dst + 16, _mm256_extractf128_ps(b, 1));
+		_mm_stream_ps(dst + 20, _mm256_extractf128_ps(c, 1));
+	}
+
+	// In-lane 4x4 transpose of both 128-bit halves.
+	MATHLIB_TARGET_AVX2 inline void Transpose4(__m256& a, __m256& b, __m256& c, __m256& d)
+	{
+		__m256 t0 = _mm256_unpacklo_ps(a, b);
+		__m256 t1 = _mm256_unpacklo_ps(c, d);
+		__m256 t2 = _mm256_unpackhi_ps(a, b);
+		__m256 t3 = _mm256_unpackhi_ps(c, d);
+		a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+		b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+		c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	MATHLIB_TARGET_AVX2 inline void LoadInterleaved4(const float32* src, Pack<float32, 8>& x, Pack<float32, 8>& y, Pack<float32, 8>& z, Pack<float32, 8>& w)
+	{
+		x.v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)), _mm_loadu_ps(src + 16), 1);
+		y.v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)), _mm_loadu_ps(src + 20), 1);
+		z.v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)), _mm_loadu_ps(src + 24), 1);
+		w.v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 12)), _mm_loadu_ps(src + 28), 1);
+		Transpose4(x.v, y.v, z.v, w.v);
+	}
+
+	MATHLIB_TARGET_AVX2 inline void StoreInterleaved4(float32* dst, Pack<float32, 8> x, Pack<float32, 8> y, Pack<float32, 8> z, Pack<float32, 8> w)
+	{
+		Transpose4(x.v, y.v, z.v, w.v);
+		_mm_storeu_ps(dst, _mm256_castps256_ps128(x.v));
+		_mm_storeu_ps(dst + 4, _mm256_castps256_ps128(y.v));
+		_mm_storeu_ps(dst + 8, _mm256_castps256_ps128(z.v));
+		_mm_storeu_ps(dst + 12, _mm256_castps256_ps128(w.v));
+		_mm_storeu_ps(dst + 16, _mm256_extractf128_ps(x.v, 1));
+		_mm_storeu_ps(dst + 20, _mm256_extractf128_ps(y.v, 1));
+		_mm_storeu_ps(dst + 24, _mm256_extractf128_ps(z.v, 1));
+		_mm_storeu_ps(dst + 28, _mm256_extractf128_ps(w.v, 1));
+	}
+
+#endif // MATHLIB_AVX2 || MATHLIB_DISPATCH
+
+#if defined(MATHLIB_DISPATCH)
+
+	// 16 x, y, z triplets in three registers: each component is gathered from (a, b)
+	// and completed from c with two two-source permutes.
+
+	MATHLIB_TARGET_AVX512 inline void Deinterleave3(__m512 a, __m512 b, __m512 c, __m512& x, __m512& y, __m512& z)
+	{
+		const __m512i x0 = _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0);
+		const __m512i x1 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29);
+		const __m512i y0 = _mm512_setr_epi32(1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0);
+		const __m512i y1 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30);
+		const __m512i z0 = _mm512_setr_epi32(2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0);
+		const __m512i z1 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31);
+		x = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, x0, b), x1, c);
+		y = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, y0, b), y1, c);
+		z = _mm512_permutex2var_ps(_mm512_permutex2var_ps(a, z0, b), z1, c);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void Interleave3(__m512 x, __m512 y, __m512 z, __m512& a, __m512& b, __m512& c)
+	{
+		const __m512i a0 = _mm512_setr_epi32(0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5);
+		const __m512i a1 = _mm512_setr_epi32(0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15);
+		const __m512i b0 = _mm512_setr_epi32(21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26);
+		const __m512i b1 = _mm512_setr_epi32(0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15);
+		const __m512i c0 = _mm512_setr_epi32(0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0);
+		const __m512i c1 = _mm512_setr_epi32(26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31);
+		a = _mm512_permutex2var_ps(_mm512_permutex2var_ps(x, a0, y), a1, z);
+		b = _mm512_permutex2var_ps(_mm512_permutex2var_ps(x, b0, y), b1, z);
+		c = _mm512_permutex2var_ps(_mm512_permutex2var_ps(x, c0, y), c1, z);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void LoadInterleaved3(const float32* src, Pack<float32, 16>& x, Pack<float32, 16>& y, Pack<float32, 16>& z)
+	{
+		Deinterleave3(_mm512_loadu_ps(src), _mm512_loadu_ps(src + 16), _mm512_loadu_ps(src + 32), x.v, y.v, z.v);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void StoreInterleaved3(float32* dst, const Pack<float32, 16>& x, const Pack<float32, 16>& y, const Pack<float32, 16>& z)
+	{
+		__m512 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		_mm512_storeu_ps(dst, a);
+		_mm512_storeu_ps(dst + 16, b);
+		_mm512_storeu_ps(dst + 32, c);
+	}
+
+	// 128-bit lane Lane of v. Zero-masked extract for the same GCC 12 warning as
+	// Pack<float32, 16>::Min; GCC 12 implements _mm512_castps512_ps128 with the unmasked one.
+	template<int Lane>
+	MATHLIB_TARGET_AVX512 inline __m128 Extract128(__m512 v)
+	{
+		return _mm512_maskz_extractf32x4_ps(0xF, v, Lane);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void Stream128(float32* dst, __m512 v)
+	{
+		_mm_stream_ps(dst, Extract128<0>(v));
+		_mm_stream_ps(dst + 4, Extract128<1>(v));
+		_mm_stream_ps(dst + 8, Extract128<2>(v));
+		_mm_stream_ps(dst + 12, Extract128<3>(v));
+	}
+
+	// dst must be 16-byte aligned.
+	MATHLIB_TARGET_AVX512 inline void StreamInterleaved3(float32* dst, const Pack<float32, 16>& x, const Pack<float32, 16>& y, const Pack<float32, 16>& z)
+	{
+		__m512 a, b, c;
+		Interleave3(x.v, y.v, z.v, a, b, c);
+		Stream128(dst, a);
+		Stream128(dst + 16, b);
+		Stream128(dst + 32, c);
+	}
+
+	// In-lane 4x4 transpose of the four 128-bit blocks. Zero-masked unpacks for the same
+	// GCC 12 warning as Pack<float32, 16>::Min.
+	MATHLIB_TARGET_AVX512 inline void Transpose4(__m512& a, __m512& b, __m512& c, __m512& d)
+	{
+		__m512 t0 = _mm512_maskz_unpacklo_ps(0xFFFF, a, b);
+		__m512 t1 = _mm512_maskz_unpacklo_ps(0xFFFF, c, d);
+		__m512 t2 = _mm512_maskz_unpackhi_ps(0xFFFF, a, b);
+		__m512 t3 = _mm512_maskz_unpackhi_ps(0xFFFF, c, d);
+		a = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+		b = _mm512_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+		c = _mm512_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		d = _mm512_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	// Tuples 4k..4k+3 of the four 16-float blocks in 128-bit lane k.
+	MATHLIB_TARGET_AVX512 inline __m512 LoadLanes4(const float32* src)
+	{
+		__m512 r = _mm512_castps128_ps512(_mm_loadu_ps(src));
+		r = _mm512_insertf32x4(r, _mm_loadu_ps(src + 16), 1);
+		r = _mm512_insertf32x4(r, _mm_loadu_ps(src + 32), 2);
+		return _mm512_insertf32x4(r, _mm_loadu_ps(src + 48), 3);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void StoreLanes4(float32* dst, __m512 v)
+	{
+		_mm_storeu_ps(dst, Extract128<0>(v));
+		_mm_storeu_ps(dst + 16, Extract128<1>(v));
+		_mm_storeu_ps(dst + 32, Extract128<2>(v));
+		_mm_storeu_ps(dst + 48, Extract128<3>(v));
+	}
+
+	MATHLIB_TARGET_AVX512 inline void LoadInterleaved4(const float32* src, Pack<float32, 16>& x, Pack<float32, 16>& y, Pack<float32, 16>& z, Pack<float32, 16>& w)
+	{
+		x.v = LoadLanes4(src);
+		y.v = LoadLanes4(src + 4);
+		z.v = LoadLanes4(src + 8);
+		w.v = LoadLanes4(src + 12);
+		Transpose4(x.v, y.v, z.v, w.v);
+	}
+
+	MATHLIB_TARGET_AVX512 inline void StoreInterleaved4(float32* dst, const Pack<float32, 16>& x, const Pack<float32, 16>& y, const Pack<float32, 16>& z, const Pack<float32, 16>& w)
+	{
+		__m512 a = x.v, b = y.v, c = z.v, d = w.v;
+		Transpose4(a, b, c, d);
+		StoreLanes4(dst, a);
+		StoreLanes4(dst + 4, b);
+		StoreLanes4(dst + 8, c);
+		StoreLanes4(dst + 12, d);
+	}
+
+#endif // MATHLIB_DISPATCH
+
+	// BATCHED VEC3 KERNELS
+
+	// Runs f(x, y, z) in place over count packed x, y, z triplets, W per iteration,
+	// scalar head/tail broadcast through the same f. dst may alias src; outputs over
+	// MATHLIB_STREAMING_STORE_BYTES use non-temporal stores.
+	template<size_t W = NativeWidth<float32>, typename F>
+	void ForEachVec3(const float32* src, float32* dst, size_t count, F&& f)
+	{
+		using P = Pack<float32, W>;
+
+		auto single = [&](size_t i)
+		{
+			Pack<float32, 1> x, y, z;
+			LoadInterleaved3(src + i * 3, x, y, z);
+			P px = P::Broadcast(x[0]), py = P::Broadcast(y[0]), pz = P::Broadcast(z[0]);
+			f(px, py, pz);
+			dst[i * 3 + 0] = px[0];
+			dst[i * 3 + 1] = py[0];
+			dst[i * 3 + 2] = pz[0];
+		};
+
+		const bool nonTemporal = count * 3 * sizeof(float32) >= MATHLIB_STREAMING_STORE_BYTES;
+
+		size_t i = 0;
+		if (nonTemporal)
+		{
+			for (; i < count && (reinterpret_cast<uintptr_t>(dst + i * 3) & 15) != 0; ++i)
+			{
+				single(i);
+			}
+		}
+
+		for (; i + W <= count; i += W)
+		{
+			P x, y, z;
+			LoadInterleaved3(src + i * 3, x, y, z);
+			f(x, y, z);
+			if (nonTemporal)
+			{
+				StreamInterleaved3(dst + i * 3, x, y, z);
+			}
+			else
+			{
+				StoreInterleaved3(dst + i * 3, x, y, z);
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			single(i);
+		}
+
+		if (nonTemporal)
+		{
+			StreamFence();
+		}
+	}
+
+	enum class TransformKind
+	{
+		Point,
+		Direction,
+		Projective
+	};
+
+	// out = m * (v, 1) / (v, 0) / (v, 1) with w-divide, m column-major 4x4. Rows are
+	// accumulated in the same order as Matrix * Vec, with the matrix held in registers.
+	template<TransformKind Kind, size_t W = NativeWidth<float32>>
+	void TransformVec3(const float32* m, const float32* src, float32* dst, size_t count)
+	{
+		using P = Pack<float32, W>;
+
+		P c[4][4];
+		for (size_t col = 0; col < 4; ++col)
+		{
+			for (size_t row = 0; row < 4; ++row)
+			{
+				c[row][col] = P::Broadcast(m[col * 4 + row]);
+			}
+		}
+
+		auto row = [&](size_t r, const P& x, const P& y, const P& z)
+		{
+			P acc = MulAdd(c[r][2], z, MulAdd(c[r][1], y, c[r][0] * x));
+			if constexpr (Kind != TransformKind::Direction)
+			{
+				acc = acc + c[r][3];
+			}
+			return acc;
+		};
+
+		auto transform = [&](P& x, P& y, P& z)
+		{
+			P ox = row(0, x, y, z);
+			P oy = row(1, x, y, z);
+			P oz = row(2, x, y, z);
+			if constexpr (Kind == TransformKind::Projective)
+			{
+				P w = row(3, x, y, z);
+				ox = ox / w;
+				oy = oy / w;
+				oz = oz / w;
+			}
+			x = ox;
+			y = oy;
+			z = oz;
+		};
+
+		ForEachVec3<W>(src, dst, count, transform);
+	}
+
+	// out = q * v * q^-1 for unit q (x, y, z, w), same two-cross-product form as
+	// Quaternion * Vec3.
+	template<size_t W = NativeWidth<float32>>
+	void RotateVec3(const float32* q, const float32* src, float32* dst, size_t count)
+	{
+		using P = Pack<float32, W>;
+
+		const P qx = P::Broadcast(q[0]);
+		const P qy = P::Broadcast(q[1]);
+		const P qz = P::Broadcast(q[2]);
+		const P qw = P::Broadcast(q[3]);
+		const P two = P::Broadcast(2.0f);
+
+		ForEachVec3<W>(src, dst, count, [&](P& x, P& y, P& z)
+		{
+			P tx = (qy * z - qz * y) * two;
+			P ty = (qz * x - qx * z) * two;
+			P tz = (qx * y - qy * x) * two;
+
+			x = x + tx * qw + (qy * tz - qz * ty);
+			y = y + ty * qw + (qz * tx - qx * tz);
+			z = z + tz * qw + (qx * ty - qy * tx);
+		});
+	}
+
+	// MATRIX KERNELS
+	// Column-major storage, each column of R <= 4 rows sits in one register. Every
+	// output element accumulates from zero in the same k order as the scalar loop,
+	// so results are bit-identical to it unless MATHLIB_FMA is enabled.
+
+	template<size_t R, size_t C, size_t C2>
+	void MulMatrix(const float32* a, const float32* b, float32* out)
+	{
+#if defined(MATHLIB_AVX2)
+		if constexpr (R == 4 && C == 4 && C2 % 2 == 0)
+		{
+			__m256 cols[4];
+			for (size_t k = 0; k < 4; ++k)
+			{
+				cols[k] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + k * 4));
+			}
+
+			for (size_t j = 0; j < C2; j += 2)
+			{
+				__m256 rhs = _mm256_loadu_ps(b + j * 4);
+				Pack<float32, 8> acc = Pack<float32, 8>::Zero();
+				acc = MulAdd(Pack<float32, 8>{ cols[0] }, Pack<float32, 8>{ _mm256_permute_ps(rhs, 0x00) }, acc);
+				acc = MulAdd(Pack<float32, 8>{ cols[1] }, Pack<float32, 8>{ _mm256_permute_ps(rhs, 0x55) }, acc);
+				acc = MulAdd(Pack<float32, 8>{ cols[2] }, Pack<float32, 8>{ _mm256_permute_ps(rhs, 0xAA) }, acc);
+				acc = MulAdd(Pack<float32, 8>{ cols[3] }, Pack<float32, 8>{ _mm256_permute_ps(rhs, 0xFF) }, acc);
+				acc.Store(out + j * 4);
+			}
+			return;
+		}
+#endif
+		Pack<float32, 4> cols[C];
+		for (size_t k = 0; k < C; ++k)
+		{
+			cols[k] = Pack<float32, 4>::LoadPartial(a + k * R, R);
+		}
+
+		for (size_t j = 0; j < C2; ++j)
+		{
+			Pack<float32, 4> acc = Pack<float32, 4>::Zero();
+			for (size_t k = 0; k < C; ++k)
+			{
+				acc = MulAdd(cols[k], Pack<float32, 4>::Broadcast(b[j * C + k]), acc);
+			}
+			acc.StorePartial(out + j * R, R);
+		}
+	}
+
+	template<size_t R, size_t C>
+	void MulVector(const float32* a, const float32* v, float32* out)
+	{
+		Pack<float32, 4> acc = Pack<float32, 4>::Zero();
+		for (size_t k = 0; k < C; ++k)
+		{
+			acc = MulAdd(Pack<float32, 4>::LoadPartial(a + k * R, R), Pack<float32, 4>::Broadcast(v[k]), acc);
+		}
+		acc.StorePartial(out, R);
+	}
+
+#if defined(MATHLIB_SSE2)
+
+	// 2x2 blocks packed row-major as (m00, m01, m10, m11).
+
+	inline __m128 Mat2Mul(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+
+	// adj(a) * b
+	inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+	}
+
+	// a * adj(b)
+	inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+
+	// Block-wise 4x4 inverse. The kernel is written for row-major input; feeding it the
+	// columns inverts the transpose, whose rows are the columns of the inverse.
+	// Returns the determinant, out is only meaningful when it is non-zero.
+	inline float32 InverseMatrix4(const float32* m, float32* out)
+	{
+		__m128 r0 = _mm_loadu_ps(m + 0);
+		__m128 r1 = _mm_loadu_ps(m + 4);
+		__m128 r2 = _mm_loadu_ps(m + 8);
+		__m128 r3 = _mm_loadu_ps(m + 12);
+
+		__m128 A = _mm_movelh_ps(r0, r1);
+		__m128 B = _mm_movehl_ps(r1, r0);
+		__m128 C = _mm_movelh_ps(r2, r3);
+		__m128 D = _mm_movehl_ps(r3, r2);
+
+		// (|A|, |B|, |C|, |D|)
+		__m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+		__m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128 D_C = Mat2AdjMul(D, C);
+		__m128 A_B = Mat2AdjMul(A, B);
+		__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+		__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+		__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+		__m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+		__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+		__m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+		X = _mm_mul_ps(X, rDetM);
+		Y = _mm_mul_ps(Y, rDetM);
+		Z = _mm_mul_ps(Z, rDetM);
+		W = _mm_mul_ps(W, rDetM);
+
+		_mm_storeu_ps(out + 0, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(out + 4, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+		_mm_storeu_ps(out + 8, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(out + 12, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+
+		return _mm_cvtss_f32(detM);
+	}
+
+	inline __m128 Cross3(__m128 a, __m128 b)
+	{
+		__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		__m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+		return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+
+	// Inverse translation column -(c0 * t.x + c1 * t.y + c2 * t.z) with w = 1.
+	inline __m128 InverseTranslation(__m128 c0, __m128 c1, __m128 c2, __m128 t)
+	{
+		__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+		return _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), r);
+	}
+
+	// Affine 4x4 (bottom row 0, 0, 0, 1): the 3x3 inverse rows are the cross products
+	// of the columns over the determinant, transposed back into columns.
+	inline void InverseAffine4(const float32* m, float32* out)
+	{
+		__m128 c0 = _mm_loadu_ps(m + 0);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 t = _mm_loadu_ps(m + 12);
+
+		__m128 r0 = Cross3(c1, c2);
+		__m128 r1 = Cross3(c2, c0);
+		__m128 r2 = Cross3(c0, c1);
+		__m128 r3 = _mm_setzero_ps();
+
+		__m128 det = _mm_mul_ps(c0, r0);
+		det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 3, 0, 1)));
+		det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(1, 0, 3, 2)));
+		__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		r0 = _mm_mul_ps(r0, invDet);
+		r1 = _mm_mul_ps(r1, invDet);
+		r2 = _mm_mul_ps(r2, invDet);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_storeu_ps(out + 0, r0);
+		_mm_storeu_ps(out + 4, r1);
+		_mm_storeu_ps(out + 8, r2);
+		_mm_storeu_ps(out + 12, InverseTranslation(r0, r1, r2, t));
+	}
+
+	// Rotation + translation only: the 3x3 inverse is the transpose.
+	inline void InverseRigid4(const float32* m, float32* out)
+	{
+		__m128 r0 = _mm_loadu_ps(m + 0);
+		__m128 r1 = _mm_loadu_ps(m + 4);
+		__m128 r2 = _mm_loadu_ps(m + 8);
+		__m128 r3 = _mm_setzero_ps();
+		__m128 t = _mm_loadu_ps(m + 12);
+
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		_mm_storeu_ps(out + 0, r0);
+		_mm_storeu_ps(out + 4, r1);
+		_mm_storeu_ps(out + 8, r2);
+		_mm_storeu_ps(out + 12, InverseTranslation(r0, r1, r2, t));
+	}
+
+	// QUATERNION KERNELS
+	// (x, y, z, w) in one register. Each lane of a sums the four products it takes part
+	// in, b permuted and sign-flipped per term.
+
+	inline __m128 QuaternionMul(__m128 a, __m128 b)
+	{
+		const __m128 signX = _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+		const __m128 signY = _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f);
+		const __m128 signZ = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b);
+		r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3))), signX));
+		r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))), signY));
+		r = _mm_add_ps(r, _mm_xor_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1))), signZ));
+		return r;
+	}
+
+	inline void QuaternionMul(const float32* a, const float32* b, float32* out)
+	{
+		_mm_storeu_ps(out, QuaternionMul(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+	}
+
+	// Real parts at a, b, out, dual parts 4 floats after.
+	inline void DualQuaternionMul(const float32* a, const float32* b, float32* out)
+	{
+		__m128 ar = _mm_loadu_ps(a);
+		__m128 ad = _mm_loadu_ps(a + 4);
+		__m128 br = _mm_loadu_ps(b);
+		__m128 bd = _mm_loadu_ps(b + 4);
+
+		_mm_storeu_ps(out, QuaternionMul(ar, br));
+		_mm_storeu_ps(out + 4, _mm_add_ps(QuaternionMul(ar, bd), QuaternionMul(ad, br)));
+	}
+
+	// q * v * q^-1 for unit q: v + w t + q x t, t = 2 q x v. Lane 3 of v passes through.
+	inline __m128 QuaternionRotate(__m128 q, __m128 v)
+	{
+		__m128 t = _mm_mul_ps(Cross3(q, v), _mm_set1_ps(2.0f));
+		return _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 3, 3, 3)), t)), Cross3(q, t));
+	}
+
+	// v and out are 3 floats.
+	inline void QuaternionRotate(const float32* q, const float32* v, float32* out)
+	{
+		Pack<float32, 4>{ QuaternionRotate(_mm_loadu_ps(q), Pack<float32, 4>::LoadPartial(v, 3).v) }.StorePartial(out, 3);
+	}
+
+	// Unit dual quaternion at dq applied to the point p, plus the translation
+	// 2 (w d - dw r + r x d).
+	inline void DualQuaternionTransformPoint(const float32* dq, const float32* point, float32* out)
+	{
+		__m128 p = Pack<float32, 4>::LoadPartial(point, 3).v;
+		__m128 r = _mm_loadu_ps(dq);
+		__m128 d = _mm_loadu_ps(dq + 4);
+		__m128 rw = _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3));
+		__m128 dw = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128 translation = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rw, d), _mm_mul_ps(dw, r)), Cross3(r, d));
+		Pack<float32, 4>{ _mm_add_ps(QuaternionRotate(r, p), _mm_mul_ps(translation, _mm_set1_ps(2.0f))) }.StorePartial(out, 3);
+	}
+
+	// TRS KERNELS
+	// trs, parent, child and out point at a whole math::Transform, never at a member:
+	// position, rotation and scale in three 16-byte aligned slots at floats 0, 4 and 8.
+	// The padding lanes are masked on load and written as zero.
+
+	inline __m128 LoadXyz(const float32* src)
+	{
+		return _mm_and_ps(_mm_load_ps(src), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+	}
+
+	inline __m128 TransformPointTRS(const float32* trs, __m128 p)
+	{
+		return _mm_add_ps(LoadXyz(trs), QuaternionRotate(_mm_load_ps(trs + 4), _mm_mul_ps(LoadXyz(trs + 8), p)));
+	}
+
+	// point and out are 3 floats.
+	inline void TransformPointTRS(const float32* trs, const float32* point, float32* out)
+	{
+		Pack<float32, 4>{ TransformPointTRS(trs, Pack<float32, 4>::LoadPartial(point, 3).v) }.StorePartial(out, 3);
+	}
+
+	inline void ComposeTRS(const float32* parent, const float32* child, float32* out)
+	{
+		__m128 position = TransformPointTRS(parent, LoadXyz(child));
+		__m128 rotation = QuaternionMul(_mm_load_ps(parent + 4), _mm_load_ps(child + 4));
+		__m128 scale = _mm_mul_ps(LoadXyz(parent + 8), LoadXyz(child + 8));
+
+		_mm_store_ps(out, position);
+		_mm_store_ps(out + 4, rotation);
+		_mm_store_ps(out + 8, scale);
+	}
+
+#endif // MATHLIB_SSE2
+}
+
+#endif // MATHLIB_SIMD_HPP
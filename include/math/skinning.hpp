@@ -0,0 +1,280 @@
+#ifndef MATHLIB_SKINNING_HPP
+#define MATHLIB_SKINNING_HPP
+#pragma once
+
+#include <math/stream.hpp>
+#include <math/dualquaternion.hpp>
+#include <math/parallel.hpp>
+
+#include <cstring>
+#include <span>
+
+namespace math
+{
+	// SKINNING
+	// Linear blend and dual-quaternion skinning of SoA position and normal streams.
+	// Each pack of vertices first blends its bones one vertex at a time (a 3x4 affine or
+	// a dual quaternion in 4-wide registers), then transposes the blends to run the
+	// transform at the simd::Dispatch width. Chunks of SKIN_GRAIN vertices run on
+	// ParallelFor. Normals may be an empty stream; outputs may alias the inputs.
+
+	// count influences per vertex: vertex v reads bones[v * count + k] and
+	// weights[v * count + k]. Weights of a vertex sum to 1, unused slots have weight 0
+	// and any valid bone index.
+	struct SkinInfluences
+	{
+		std::span<const uint32> bones;
+		std::span<const float32> weights;
+		size_t count = 4;
+	};
+
+	constexpr size_t SKIN_GRAIN = 4096;
+
+	namespace detail
+	{
+		// Palette rows: 3 rows of 4 floats per bone, row-major, 16-byte aligned.
+		template<size_t R>
+		simd::AlignedVector<float32> AffineRows(std::span<const Matrix<R, 4, float32>> bones)
+		{
+			simd::AlignedVector<float32> rows(bones.size() * 12);
+			for (size_t b = 0; b < bones.size(); ++b)
+			{
+				for (size_t row = 0; row < 3; ++row)
+				{
+					for (size_t col = 0; col < 4; ++col)
+					{
+						rows[b * 12 + row * 4 + col] = bones[b](row, col);
+					}
+				}
+			}
+			return rows;
+		}
+
+		// Real part x, y, z, w then dual part x, y, z, w per bone, from rigid matrices.
+		template<size_t R>
+		simd::AlignedVector<float32> DualQuaternionRows(std::span<const Matrix<R, 4, float32>> bones)
+		{
+			simd::AlignedVector<float32> rows(bones.size() * 8);
+			for (size_t b = 0; b < bones.size(); ++b)
+			{
+				Mat3 rotation;
+				for (size_t col = 0; col < 3; ++col)
+				{
+					for (size_t row = 0; row < 3; ++row)
+					{
+						rotation(row, col) = bones[b](row, col);
+					}
+				}
+
+				Quaternion real = Quaternion::FromRotationMatrix(rotation).Normalize();
+				DualQuaternion dq = DualQuaternion::FromRotationTranslation(real, Vec3(bones[b](0, 3), bones[b](1, 3), bones[b](2, 3)));
+				std::memcpy(rows.data() + b * 8, &dq, sizeof(DualQuaternion));
+			}
+			return rows;
+		}
+
+		// Blends `Parts` 4-float groups of each vertex's bones into blend[part * W * 4 + lane * 4].
+		// Lanes past the end repeat the last vertex so every lane stays finite.
+		template<size_t W, size_t Parts, bool AlignSigns>
+		void BlendBones(const float32* palette, const SkinInfluences& influences, size_t first, size_t lanes, float32* blend)
+		{
+			using Pack4 = simd::Pack<float32, 4>;
+
+			for (size_t lane = 0; lane < W; ++lane)
+			{
+				const size_t v = first + Min(lane, lanes - 1);
+				const uint32* bones = influences.bones.data() + v * influences.count;
+				const float32* weights = influences.weights.data() + v * influences.count;
+				const float32* pivot = palette + size_t(bones[0]) * Parts * 4;
+
+				std::array<Pack4, Parts> sum{};
+				for (size_t k = 0; k < influences.count; ++k)
+				{
+					const float32* bone = palette + size_t(bones[k]) * Parts * 4;
+
+					// Dual quaternions: q and -q are the same rotation, blend in the pivot's hemisphere.
+					float32 weight = weights[k];
+					if constexpr (AlignSigns)
+					{
+						float32 dot = bone[0] * pivot[0] + bone[1] * pivot[1] + bone[2] * pivot[2] + bone[3] * pivot[3];
+						weight = dot < 0.0f ? -weight : weight;
+					}
+
+					const Pack4 w = Pack4::Broadcast(weight);
+					for (size_t part = 0; part < Parts; ++part)
+					{
+						sum[part] = k == 0 ? Pack4::Load(bone + part * 4) * w : MulAdd(Pack4::Load(bone + part * 4), w, sum[part]);
+					}
+				}
+
+				for (size_t part = 0; part < Parts; ++part)
+				{
+					sum[part].Store(blend + part * W * 4 + lane * 4);
+				}
+			}
+		}
+
+		template<typename Kernel>
+		void ForEachSkinPack(size_t count, Kernel&& kernel)
+		{
+			ParallelFor(count, SKIN_GRAIN, [&](size_t begin, size_t end)
+			{
+				simd::Dispatch<float32>([&]<size_t W>()
+				{
+					simd::ForEachPack<float32, W>(end - begin, [&](size_t i, size_t lanes)
+					{
+						kernel.template operator()<W>(begin + i, lanes);
+					});
+				});
+			});
+		}
+
+		template<typename P>
+		void Normalize3(P& x, P& y, P& z)
+		{
+			P len = Sqrt(x * x + y * y + z * z);
+			x = x / len;
+			y = y / len;
+			z = z / len;
+		}
+
+		inline void PrepareSkinOutputs([[maybe_unused]] const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+		{
+			assert(influences.count > 0);
+			assert(influences.bones.size() >= positions.Size() * influences.count && influences.weights.size() >= positions.Size() * influences.count);
+			assert(normals.Size() == 0 || normals.Size() == positions.Size());
+
+			outPositions.Resize(positions.Size());
+			outNormals.Resize(normals.Size());
+		}
+
+		inline void SkinLinear(const float32* palette, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+		{
+			PrepareSkinOutputs(influences, positions, normals, outPositions, outNormals);
+			const bool withNormals = normals.Size() != 0;
+
+			ForEachSkinPack(positions.Size(), [&]<size_t W>(size_t i, size_t lanes)
+			{
+				using PackType = simd::Pack<float32, W>;
+
+				alignas(64) float32 blend[3 * W * 4];
+				BlendBones<W, 3, false>(palette, influences, i, lanes, blend);
+
+				std::array<PackType, 12> m;
+				for (size_t row = 0; row < 3; ++row)
+				{
+					simd::LoadInterleaved4(blend + row * W * 4, m[row * 4 + 0], m[row * 4 + 1], m[row * 4 + 2], m[row * 4 + 3]);
+				}
+
+				VecPack<3, float32, W> p = positions.LoadPack<W>(i, lanes);
+				VecPack<3, float32, W> r;
+				for (size_t row = 0; row < 3; ++row)
+				{
+					r.c[row] = MulAdd(m[row * 4 + 0], p.c[0], MulAdd(m[row * 4 + 1], p.c[1], MulAdd(m[row * 4 + 2], p.c[2], m[row * 4 + 3])));
+				}
+				outPositions.StorePack(i, lanes, r);
+
+				if (withNormals)
+				{
+					VecPack<3, float32, W> n = normals.LoadPack<W>(i, lanes);
+					for (size_t row = 0; row < 3; ++row)
+					{
+						r.c[row] = MulAdd(m[row * 4 + 0], n.c[0], MulAdd(m[row * 4 + 1], n.c[1], m[row * 4 + 2] * n.c[2]));
+					}
+					Normalize3(r.c[0], r.c[1], r.c[2]);
+					outNormals.StorePack(i, lanes, r);
+				}
+			});
+		}
+
+		inline void SkinDualQuaternion(const float32* palette, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+		{
+			PrepareSkinOutputs(influences, positions, normals, outPositions, outNormals);
+			const bool withNormals = normals.Size() != 0;
+
+			ForEachSkinPack(positions.Size(), [&]<size_t W>(size_t i, size_t lanes)
+			{
+				using PackType = simd::Pack<float32, W>;
+
+				alignas(64) float32 blend[2 * W * 4];
+				BlendBones<W, 2, true>(palette, influences, i, lanes, blend);
+
+				PackType qx, qy, qz, qw, dx, dy, dz, dw;
+				simd::LoadInterleaved4(blend, qx, qy, qz, qw);
+				simd::LoadInterleaved4(blend + W * 4, dx, dy, dz, dw);
+
+				// Normalize by the real part only: the blend stays a rigid transform.
+				PackType inv = PackType::Broadcast(1.0f) / Sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+				qx = qx * inv; qy = qy * inv; qz = qz * inv; qw = qw * inv;
+				dx = dx * inv; dy = dy * inv; dz = dz * inv; dw = dw * inv;
+
+				const PackType two = PackType::Broadcast(2.0f);
+
+				// v + 2 q.xyz x (q.xyz x v + w v)
+				auto rotate = [&](const VecPack<3, float32, W>& v)
+				{
+					PackType tx = (qy * v.c[2] - qz * v.c[1]) + qw * v.c[0];
+					PackType ty = (qz * v.c[0] - qx * v.c[2]) + qw * v.c[1];
+					PackType tz = (qx * v.c[1] - qy * v.c[0]) + qw * v.c[2];
+
+					VecPack<3, float32, W> r;
+					r.c[0] = MulAdd(two, qy * tz - qz * ty, v.c[0]);
+					r.c[1] = MulAdd(two, qz * tx - qx * tz, v.c[1]);
+					r.c[2] = MulAdd(two, qx * ty - qy * tx, v.c[2]);
+					return r;
+				};
+
+				// Translation 2 (w d.xyz - d.w q.xyz + q.xyz x d.xyz)
+				VecPack<3, float32, W> r = rotate(positions.LoadPack<W>(i, lanes));
+				r.c[0] = MulAdd(two, qw * dx - dw * qx + (qy * dz - qz * dy), r.c[0]);
+				r.c[1] = MulAdd(two, qw * dy - dw * qy + (qz * dx - qx * dz), r.c[1]);
+				r.c[2] = MulAdd(two, qw * dz - dw * qz + (qx * dy - qy * dx), r.c[2]);
+				outPositions.StorePack(i, lanes, r);
+
+				if (withNormals)
+				{
+					outNormals.StorePack(i, lanes, rotate(normals.LoadPack<W>(i, lanes)));
+				}
+			});
+		}
+	}
+
+	// Linear blend skinning: each vertex goes through the weighted sum of its bone
+	// matrices. Normals use the same 3x3 and are renormalized, exact for palettes without
+	// non-uniform scale.
+	inline void SkinLinear(std::span<const Mat4> bones, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+	{
+		simd::AlignedVector<float32> palette = detail::AffineRows(bones);
+		detail::SkinLinear(palette.data(), influences, positions, normals, outPositions, outNormals);
+	}
+
+	inline void SkinLinear(std::span<const Mat3x4> bones, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+	{
+		simd::AlignedVector<float32> palette = detail::AffineRows(bones);
+		detail::SkinLinear(palette.data(), influences, positions, normals, outPositions, outNormals);
+	}
+
+	// Dual-quaternion skinning: blends the bones as unit dual quaternions, which keeps
+	// the volume at twisted joints. Bones must be rigid (rotation and translation only).
+	inline void SkinDualQuaternion(std::span<const Mat4> bones, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+	{
+		simd::AlignedVector<float32> palette = detail::DualQuaternionRows(bones);
+		detail::SkinDualQuaternion(palette.data(), influences, positions, normals, outPositions, outNormals);
+	}
+
+	inline void SkinDualQuaternion(std::span<const Mat3x4> bones, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+	{
+		simd::AlignedVector<float32> palette = detail::DualQuaternionRows(bones);
+		detail::SkinDualQuaternion(palette.data(), influences, positions, normals, outPositions, outNormals);
+	}
+
+	// Unit dual quaternion palette, used as is.
+	inline void SkinDualQuaternion(std::span<const DualQuaternion> bones, const SkinInfluences& influences, const Vec3Stream& positions, const Vec3Stream& normals, Vec3Stream& outPositions, Vec3Stream& outNormals)
+	{
+		simd::AlignedVector<float32> palette(bones.size() * 8);
+		std::memcpy(palette.data(), bones.data(), bones.size_bytes());
+		detail::SkinDualQuaternion(palette.data(), influences, positions, normals, outPositions, outNormals);
+	}
+}
+
+#endif // MATHLIB_SKINNING_HPP
@@ -0,0 +1,326 @@
+#ifndef MATHLIB_SPATIALHASH_HPP
+#define MATHLIB_SPATIALHASH_HPP
+#pragma once
+
+#include <math/parallel.hpp>
+#include <math/vector.hpp>
+
+#include <bit>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace math
+{
+	// SPATIAL HASH GRID
+	// Uniform grid of cubic cells over Vec3 points, the cells hashed into 2^k buckets with
+	// 2^k >= point count. Build() counting-sorts the points by bucket into one array and
+	// allocates nothing per cell; within a bucket the points keep their input order. Cells
+	// adjacent along x get adjacent buckets, so a query scans one contiguous run of points
+	// per row of cells: 4 to 9 rows when the cell size is close to the radius. Large builds
+	// hash and scatter on ParallelFor, into the same order as the serial build.
+	// Queries report the index of the point in the span given to Build() and its squared
+	// distance to the center, as DistanceSquared would.
+
+	class SpatialHashGrid
+	{
+	public:
+		static constexpr size_t PARALLEL_GRAIN = 4096;
+
+		// High bucket bits the parallel build sorts on first.
+		static constexpr size_t DIGIT_BITS = 10;
+
+		// Centers per ParallelFor chunk in the batched query.
+		static constexpr size_t QUERY_GRAIN = 1024;
+
+		void Build(std::span<const Vec3> source, float32 cellSize)
+		{
+			assert(cellSize > 0.0f && source.size() < std::numeric_limits<uint32>::max());
+			this->cellSize = cellSize;
+			inverseCellSize = 1.0f / cellSize;
+
+			const size_t count = source.size();
+			mask = static_cast<uint32>(std::bit_ceil(Max<size_t>(count, 1)) - 1);
+			bucketStart.assign(size_t(mask) + 2, 0);
+			buckets.resize(count);
+			points.resize(count);
+			indices.resize(count);
+
+			if (count > PARALLEL_GRAIN && ThreadPool::Default().ThreadCount() > 1)
+			{
+				SortParallel(source);
+			}
+			else
+			{
+				Sort(source);
+			}
+		}
+
+		bool Empty() const { return points.empty(); }
+		size_t Size() const { return points.size(); }
+		float32 CellSize() const { return cellSize; }
+		size_t BucketCount() const { return size_t(mask) + 1; }
+
+		// Points sorted by bucket: neighbours in space are mostly neighbours in memory.
+		std::span<const Vec3> Points() const { return points; }
+
+		// Build() index of each entry of Points().
+		std::span<const uint32> Indices() const { return indices; }
+
+		// f(index, distanceSquared) for every point within radius of center.
+		template<typename F>
+		void Query(const Vec3& center, float32 radius, F&& f) const
+		{
+			QuerySlots(center, radius, [&](size_t slot, float32 distanceSquared) { f(indices[slot], distanceSquared); });
+		}
+
+		// Neighbours of centers[i] are neighbors[offsets[i]] to neighbors[offsets[i + 1]], on
+		// ParallelFor. Passing Points() as the centers gives the most coherent memory access;
+		// Indices() then maps each center back to its point.
+		void Query(std::span<const Vec3> centers, float32 radius, std::vector<uint32>& offsets, std::vector<uint32>& neighbors) const
+		{
+			ParallelCollect(centers.size(), QUERY_GRAIN, offsets, neighbors, [&](size_t i, std::vector<uint32>& found)
+			{
+				Query(centers[i], radius, [&](uint32 index, float32) { found.push_back(index); });
+			});
+		}
+
+		// f(a, b, distanceSquared) once for every pair of points closer than radius.
+		template<typename F>
+		void ForEachPair(float32 radius, F&& f) const
+		{
+			for (size_t slot = 0; slot < points.size(); ++slot)
+			{
+				QuerySlots(points[slot], radius, [&](size_t other, float32 distanceSquared)
+				{
+					if (other > slot)
+					{
+						f(indices[slot], indices[other], distanceSquared);
+					}
+				});
+			}
+		}
+
+	private:
+		struct Cell
+		{
+			int32 x, y, z;
+		};
+
+		// Floor, for coordinates well inside the int32 range.
+		static constexpr int32 Coordinate(float32 x)
+		{
+			const int32 truncated = static_cast<int32>(x);
+			return truncated - (x < static_cast<float32>(truncated));
+		}
+
+		Cell CellOf(const Vec3& p) const
+		{
+			return { Coordinate(p[0] * inverseCellSize), Coordinate(p[1] * inverseCellSize), Coordinate(p[2] * inverseCellSize) };
+		}
+
+		// Rows along x hash to runs of consecutive buckets.
+		uint32 Bucket(int32 x, int32 y, int32 z) const
+		{
+			return (static_cast<uint32>(x) + ((static_cast<uint32>(y) * 73856093u) ^ (static_cast<uint32>(z) * 19349663u))) & mask;
+		}
+
+		// Counting sort by bucket, within a bucket in input order.
+		void Sort(std::span<const Vec3> source)
+		{
+			const size_t count = source.size();
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Cell cell = CellOf(source[i]);
+				buckets[i] = Bucket(cell.x, cell.y, cell.z);
+				++bucketStart[buckets[i] + 1];
+			}
+
+			for (size_t b = 1; b < bucketStart.size(); ++b)
+			{
+				bucketStart[b] += bucketStart[b - 1];
+			}
+
+			cursors.assign(bucketStart.begin(), bucketStart.end() - 1);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const uint32 slot = cursors[buckets[i]]++;
+				points[slot] = source[i];
+				indices[slot] = static_cast<uint32>(i);
+			}
+		}
+
+		// The same order in two stable passes. First by digit, the top DIGIT_BITS bits of
+		// the bucket: each PARALLEL_GRAIN chunk counts its digits, the counts are summed
+		// digit-major then chunk-minor, and each chunk scatters from its own offsets. Then
+		// each digit, a contiguous range of buckets, is counting-sorted on its own.
+		void SortParallel(std::span<const Vec3> source)
+		{
+			const size_t count = source.size();
+			const size_t chunkCount = (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+			const uint32 shift = static_cast<uint32>(Max<int32>(static_cast<int32>(std::bit_width(mask)) - int32(DIGIT_BITS), 0));
+			const size_t digitCount = (size_t(mask) >> shift) + 1;
+
+			std::vector<uint32> offsets(chunkCount * digitCount, 0);
+			ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t c = begin; c < end; ++c)
+				{
+					uint32* histogram = offsets.data() + c * digitCount;
+					for (size_t i = c * PARALLEL_GRAIN; i < Min(count, (c + 1) * PARALLEL_GRAIN); ++i)
+					{
+						const Cell cell = CellOf(source[i]);
+						buckets[i] = Bucket(cell.x, cell.y, cell.z);
+						++histogram[buckets[i] >> shift];
+					}
+				}
+			});
+
+			std::vector<uint32> digitStart(digitCount + 1);
+			uint32 total = 0;
+			for (size_t d = 0; d < digitCount; ++d)
+			{
+				digitStart[d] = total;
+				for (size_t c = 0; c < chunkCount; ++c)
+				{
+					const uint32 n = offsets[c * digitCount + d];
+					offsets[c * digitCount + d] = total;
+					total += n;
+				}
+			}
+			digitStart[digitCount] = total;
+
+			order.resize(count);
+			ParallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t c = begin; c < end; ++c)
+				{
+					uint32* cursor = offsets.data() + c * digitCount;
+					for (size_t i = c * PARALLEL_GRAIN; i < Min(count, (c + 1) * PARALLEL_GRAIN); ++i)
+					{
+						order[cursor[buckets[i] >> shift]++] = static_cast<uint32>(i);
+					}
+				}
+			});
+
+			// Digit d owns buckets [d << shift, (d + 1) << shift) and bucketStart entries
+			// past its first bucket, so the digits never write the same entry.
+			cursors.resize(BucketCount());
+			ParallelFor(digitCount, Max<size_t>(1, PARALLEL_GRAIN * digitCount / count), [&](size_t begin, size_t end)
+			{
+				for (size_t d = begin; d < end; ++d)
+				{
+					const size_t first = d << shift;
+					const size_t last = (d + 1) << shift;
+					for (uint32 k = digitStart[d]; k < digitStart[d + 1]; ++k)
+					{
+						++bucketStart[buckets[order[k]] + 1];
+					}
+
+					cursors[first] = digitStart[d];
+					for (size_t b = first; b < last; ++b)
+					{
+						bucketStart[b + 1] += cursors[b];
+						if (b + 1 < last)
+						{
+							cursors[b + 1] = bucketStart[b + 1];
+						}
+					}
+
+					for (uint32 k = digitStart[d]; k < digitStart[d + 1]; ++k)
+					{
+						const uint32 i = order[k];
+						const uint32 slot = cursors[buckets[i]]++;
+						points[slot] = source[i];
+						indices[slot] = i;
+					}
+				}
+			});
+		}
+
+		// f(slot, distanceSquared). Buckets shared by several rows of the range are scanned
+		// once per row, a point is reported from its own row only; within the radius, its
+		// x cell is always in the range.
+		template<typename F>
+		void QuerySlots(const Vec3& center, float32 radius, F&& f) const
+		{
+			assert(radius >= 0.0f);
+			const float32 radiusSquared = radius * radius;
+			auto test = [&](size_t slot)
+			{
+				const Vec3& p = points[slot];
+				const float32 dx = p[0] - center[0];
+				const float32 dy = p[1] - center[1];
+				const float32 dz = p[2] - center[2];
+				const float32 distanceSquared = dx * dx + dy * dy + dz * dz;
+				return distanceSquared <= radiusSquared ? distanceSquared : -1.0f;
+			};
+
+			const Cell low = CellOf(center - Vec3(radius, radius, radius));
+			const Cell high = CellOf(center + Vec3(radius, radius, radius));
+			const float64 cellCount = float64(high.x - low.x + 1) * float64(high.y - low.y + 1) * float64(high.z - low.z + 1);
+
+			// Wider than the table: every bucket would be visited, scan the points once instead.
+			if (cellCount > float64(BucketCount()))
+			{
+				for (size_t slot = 0; slot < points.size(); ++slot)
+				{
+					const float32 distanceSquared = test(slot);
+					if (distanceSquared >= 0.0f)
+					{
+						f(slot, distanceSquared);
+					}
+				}
+				return;
+			}
+
+			// A row of cells is a run of consecutive buckets, wrapping at the end of the table.
+			const uint32 rowLength = static_cast<uint32>(high.x - low.x + 1);
+			for (int32 z = low.z; z <= high.z; ++z)
+			{
+				for (int32 y = low.y; y <= high.y; ++y)
+				{
+					auto scan = [&](uint32 begin, uint32 end)
+					{
+						for (uint32 slot = bucketStart[begin]; slot < bucketStart[end]; ++slot)
+						{
+							const float32 distanceSquared = test(slot);
+							if (distanceSquared < 0.0f)
+							{
+								continue;
+							}
+							const Cell cell = CellOf(points[slot]);
+							if (cell.y == y && cell.z == z)
+							{
+								f(slot, distanceSquared);
+							}
+						}
+					};
+
+					const uint32 first = Bucket(low.x, y, z);
+					if (first + rowLength <= BucketCount())
+					{
+						scan(first, first + rowLength);
+					}
+					else
+					{
+						scan(first, mask + 1);
+						scan(0, first + rowLength - (mask + 1));
+					}
+				}
+			}
+		}
+
+		float32 cellSize = 1.0f;
+		float32 inverseCellSize = 1.0f;
+		uint32 mask = 0;
+		std::vector<uint32> bucketStart;	// BucketCount() + 1 offsets into points.
+		std::vector<Vec3> points;
+		std::vector<uint32> indices;
+		std::vector<uint32> buckets;		// Build scratch: bucket of each source point.
+		std::vector<uint32> cursors;		// Build scratch: next free slot of each bucket.
+		std::vector<uint32> order;			// Parallel build scratch: source indices sorted by digit.
+	};
+}
+
+#endif // MATHLIB_SPATIALHASH_HPP
@@ -0,0 +1,935 @@
+#ifndef MATHLIB_STREAM_HPP
+#define MATHLIB_STREAM_HPP
+#pragma once
+
+#include <math/vector.hpp>
+#include <math/quaternion.hpp>
+
+#include <span>
+
+namespace math
+{
+	// SOA PACK
+
+	// W vectors held one register per component.
+	template<size_t N, typename T, size_t W = simd::NativeWidth<T>>
+	struct VecPack
+	{
+		using PackType = simd::Pack<T, W>;
+
+		std::array<PackType, N> c;
+	};
+
+	template<size_t N, typename T, size_t W>
+	simd::Pack<T, W> Dot(const VecPack<N, T, W>& a, const VecPack<N, T, W>& b)
+	{
+		auto sum = a.c[0] * b.c[0];
+		for (size_t i = 1; i < N; ++i)
+		{
+			sum = MulAdd(a.c[i], b.c[i], sum);
+		}
+		return sum;
+	}
+
+	// SOA STREAMS
+
+	// Structure-of-arrays storage: one aligned array per component.
+	template<size_t N, typename T>
+	struct VecStream
+	{
+		std::array<simd::AlignedVector<T>, N> components;
+
+		VecStream() = default;
+
+		explicit VecStream(size_t count)
+		{
+			Resize(count);
+		}
+
+		explicit VecStream(std::span<const Vec<N, T>> vectors)
+		{
+			Assign(vectors);
+		}
+
+		size_t Size() const { return components[0].size(); }
+
+		void Resize(size_t count)
+		{
+			for (auto& component : components)
+			{
+				component.resize(count);
+			}
+		}
+
+		T* Data(size_t component) { return components[component].data(); }
+		const T* Data(size_t component) const { return components[component].data(); }
+
+		Vec<N, T> Get(size_t index) const
+		{
+			Vec<N, T> result;
+			for (size_t i = 0; i < N; ++i)
+			{
+				result[i] = components[i][index];
+			}
+			return result;
+		}
+
+		void Set(size_t index, const Vec<N, T>& v)
+		{
+			for (size_t i = 0; i < N; ++i)
+			{
+				components[i][index] = v[i];
+			}
+		}
+
+		void Assign(std::span<const Vec<N, T>> vectors)
+		{
+			Resize(vectors.size());
+			for (size_t index = 0; index < vectors.size(); ++index)
+			{
+				Set(index, vectors[index]);
+			}
+		}
+
+		void CopyTo(std::span<Vec<N, T>> vectors) const
+		{
+			assert(vectors.size() >= Size());
+			for (size_t index = 0; index < Size(); ++index)
+			{
+				vectors[index] = Get(index);
+			}
+		}
+
+		template<size_t W = simd::NativeWidth<T>>
+		VecPack<N, T, W> LoadPack(size_t index, size_t lanes) const
+		{
+			VecPack<N, T, W> result;
+			for (size_t i = 0; i < N; ++i)
+			{
+				result.c[i] = simd::Pack<T, W>::LoadPartial(Data(i) + index, lanes);
+			}
+			return result;
+		}
+
+		template<size_t W>
+		void StorePack(size_t index, size_t lanes, const VecPack<N, T, W>& pack)
+		{
+			for (size_t i = 0; i < N; ++i)
+			{
+				pack.c[i].StorePartial(Data(i) + index, lanes);
+			}
+		}
+	};
+
+	// UTILS TYPES FOR STREAMS
+
+	using Vec3Stream = VecStream<3, float32>;
+	using Vec4Stream = VecStream<4, float32>;
+
+	static_assert(sizeof(Quaternion) == 4 * sizeof(float32), "Quaternion must be tightly packed x, y, z, w");
+
+	// x, y, z, w component arrays.
+	struct QuaternionStream : VecStream<4, float32>
+	{
+		using VecStream::VecStream;
+
+		explicit QuaternionStream(std::span<const Quaternion> rotations)
+		{
+			Assign(rotations);
+		}
+
+		Quaternion Get(size_t index) const
+		{
+			return Quaternion(components[0][index], components[1][index], components[2][index], components[3][index]);
+		}
+
+		void Set(size_t index, const Quaternion& q)
+		{
+			components[0][index] = q.x;
+			components[1][index] = q.y;
+			components[2][index] = q.z;
+			components[3][index] = q.w;
+		}
+
+		void Assign(std::span<const Quaternion> rotations)
+		{
+			Resize(rotations.size());
+			for (size_t index = 0; index < rotations.size(); ++index)
+			{
+				Set(index, rotations[index]);
+			}
+		}
+
+		void CopyTo(std::span<Quaternion> rotations) const
+		{
+			assert(rotations.size() >= Size());
+			for (size_t index = 0; index < Size(); ++index)
+			{
+				rotations[index] = Get(index);
+			}
+		}
+	};
+
+	// Column-major component arrays: component col * R + row holds m(row, col), as in Matrix::Data().
+	template<size_t R, size_t C, typename T>
+	struct MatrixStream : VecStream<R * C, T>
+	{
+		using MatrixType = Matrix<R, C, T>;
+		using VecStream<R * C, T>::VecStream;
+		using VecStream<R * C, T>::Data;
+
+		explicit MatrixStream(std::span<const MatrixType> matrices)
+		{
+			Assign(matrices);
+		}
+
+		T* Data(size_t row, size_t col) { return this->components[col * R + row].data(); }
+		const T* Data(size_t row, size_t col) const { return this->components[col * R + row].data(); }
+
+		MatrixType Get(size_t index) const
+		{
+			MatrixType result;
+			for (size_t i = 0; i < R * C; ++i)
+			{
+				result.Data()[i] = this->components[i][index];
+			}
+			return result;
+		}
+
+		void Set(size_t index, const MatrixType& m)
+		{
+			for (size_t i = 0; i < R * C; ++i)
+			{
+				this->components[i][index] = m.Data()[i];
+			}
+		}
+
+		void Assign(std::span<const MatrixType> matrices)
+		{
+			this->Resize(matrices.size());
+			for (size_t index = 0; index < matrices.size(); ++index)
+			{
+				Set(index, matrices[index]);
+			}
+		}
+
+		void CopyTo(std::span<MatrixType> matrices) const
+		{
+			assert(matrices.size() >= this->Size());
+			for (size_t index = 0; index < this->Size(); ++index)
+			{
+				matrices[index] = Get(index);
+			}
+		}
+	};
+
+	using Mat3Stream = MatrixStream<3, 3, float32>;
+	using Mat4Stream = MatrixStream<4, 4, float32>;
+
+	// BATCHED VECTOR FUNCTIONS
+	// Same math as the Vec<N, T> functions, one pack of the width picked by
+	// simd::Dispatch per iteration (8 with AVX2, 16 with AVX-512). Outputs are resized
+	// to the input size and may alias an input.
+
+	template<size_t N, typename T>
+	void Dot(const VecStream<N, T>& a, const VecStream<N, T>& b, std::span<std::type_identity_t<T>> out)
+	{
+		assert(b.Size() == a.Size() && out.size() >= a.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			simd::ForEachPack<T, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				Dot(a.template LoadPack<W>(i, lanes), b.template LoadPack<W>(i, lanes)).StorePartial(out.data() + i, lanes);
+			});
+		});
+	}
+
+	template<typename T>
+	void Cross(const VecStream<3, T>& a, const VecStream<3, T>& b, VecStream<3, T>& out)
+	{
+		assert(b.Size() == a.Size());
+		out.Resize(a.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			simd::ForEachPack<T, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<3, T, W> va = a.template LoadPack<W>(i, lanes);
+				VecPack<3, T, W> vb = b.template LoadPack<W>(i, lanes);
+
+				VecPack<3, T, W> r;
+				r.c[0] = va.c[1] * vb.c[2] - va.c[2] * vb.c[1];
+				r.c[1] = va.c[2] * vb.c[0] - va.c[0] * vb.c[2];
+				r.c[2] = va.c[0] * vb.c[1] - va.c[1] * vb.c[0];
+
+				out.StorePack(i, lanes, r);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Normalize(const VecStream<N, T>& v, VecStream<N, T>& out)
+	{
+		out.Resize(v.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			simd::ForEachPack<T, W>(v.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> p = v.template LoadPack<W>(i, lanes);
+				auto len = Sqrt(Dot(p, p));
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					p.c[c] = p.c[c] / len;
+				}
+
+				out.StorePack(i, lanes, p);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void NormalizeFast(const VecStream<N, T>& v, VecStream<N, T>& out, SqrtPrecision precision = SqrtPrecision::Accurate)
+	{
+		out.Resize(v.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			simd::ForEachPack<T, W>(v.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> p = v.template LoadPack<W>(i, lanes);
+				auto invLength = simd::InvSqrt(Dot(p, p), precision);
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					p.c[c] = p.c[c] * invLength;
+				}
+
+				out.StorePack(i, lanes, p);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Lerp(const VecStream<N, T>& a, const VecStream<N, T>& b, T t, VecStream<N, T>& out)
+	{
+		assert(b.Size() == a.Size());
+		out.Resize(a.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			const auto vt = simd::Pack<T, W>::Broadcast(t);
+
+			simd::ForEachPack<T, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> pa = a.template LoadPack<W>(i, lanes);
+				VecPack<N, T, W> pb = b.template LoadPack<W>(i, lanes);
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					pa.c[c] = MulAdd(pb.c[c] - pa.c[c], vt, pa.c[c]);
+				}
+
+				out.StorePack(i, lanes, pa);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Reflect(const VecStream<N, T>& I, const VecStream<N, T>& Norm, VecStream<N, T>& out)
+	{
+		assert(Norm.Size() == I.Size());
+		out.Resize(I.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			const auto two = simd::Pack<T, W>::Broadcast(T(2));
+
+			simd::ForEachPack<T, W>(I.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> pi = I.template LoadPack<W>(i, lanes);
+				VecPack<N, T, W> pn = Norm.template LoadPack<W>(i, lanes);
+				auto scale = two * Dot(pi, pn);
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					pi.c[c] = pi.c[c] - pn.c[c] * scale;
+				}
+
+				out.StorePack(i, lanes, pi);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Refract(const VecStream<N, T>& I, const VecStream<N, T>& Norm, T Eta_In, T Eta_Out, VecStream<N, T>& out)
+	{
+		assert(Norm.Size() == I.Size());
+		out.Resize(I.Size());
+
+		const T eta = Eta_In / Eta_Out;
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<T, W>;
+
+			const PackType vEta = PackType::Broadcast(eta);
+			const PackType vEta2 = PackType::Broadcast(eta * eta);
+			const PackType one = PackType::Broadcast(T(1));
+			const PackType two = PackType::Broadcast(T(2));
+			const PackType zero = PackType::Zero();
+
+			simd::ForEachPack<T, W>(I.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> pi = I.template LoadPack<W>(i, lanes);
+				VecPack<N, T, W> pn = Norm.template LoadPack<W>(i, lanes);
+
+				PackType dotIN = Dot(pi, pn);
+				PackType cosi = -dotIN;
+				PackType k = one - vEta2 * (one - cosi * cosi);
+				auto totalReflection = k < zero;
+
+				PackType refractScale = vEta * cosi - Sqrt(Max(k, zero));
+				PackType reflectScale = two * dotIN;
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					PackType refracted = vEta * pi.c[c] + refractScale * pn.c[c];
+					PackType reflected = pi.c[c] - pn.c[c] * reflectScale;
+					pi.c[c] = Select(totalReflection, reflected, refracted);
+				}
+
+				out.StorePack(i, lanes, pi);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Distance(const VecStream<N, T>& a, const VecStream<N, T>& b, std::span<std::type_identity_t<T>> out)
+	{
+		assert(b.Size() == a.Size() && out.size() >= a.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			simd::ForEachPack<T, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> pa = a.template LoadPack<W>(i, lanes);
+				VecPack<N, T, W> pb = b.template LoadPack<W>(i, lanes);
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					pa.c[c] = pb.c[c] - pa.c[c];
+				}
+
+				Sqrt(Dot(pa, pa)).StorePartial(out.data() + i, lanes);
+			});
+		});
+	}
+
+	template<size_t N, typename T>
+	void Project(const VecStream<N, T>& a, const VecStream<N, T>& b, VecStream<N, T>& out)
+	{
+		assert(b.Size() == a.Size());
+		out.Resize(a.Size());
+
+		simd::Dispatch<T>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<T, W>;
+
+			const PackType zero = PackType::Zero();
+
+			simd::ForEachPack<T, W>(a.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<N, T, W> pa = a.template LoadPack<W>(i, lanes);
+				VecPack<N, T, W> pb = b.template LoadPack<W>(i, lanes);
+
+				PackType lengthSquared = Dot(pb, pb);
+				PackType scale = Select(lengthSquared == zero, zero, Dot(pa, pb) / lengthSquared);
+
+				for (size_t c = 0; c < N; ++c)
+				{
+					pb.c[c] = pb.c[c] * scale;
+				}
+
+				out.StorePack(i, lanes, pb);
+			});
+		});
+	}
+
+	// out[i] = rotations[i] * vectors[i] for unit rotations.
+	inline void Rotate(const QuaternionStream& rotations, const Vec3Stream& vectors, Vec3Stream& out)
+	{
+		assert(rotations.Size() == vectors.Size());
+		out.Resize(vectors.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			const auto two = simd::Pack<float32, W>::Broadcast(2.0f);
+
+			simd::ForEachPack<float32, W>(vectors.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<4, float32, W> q = rotations.LoadPack<W>(i, lanes);
+				VecPack<3, float32, W> v = vectors.LoadPack<W>(i, lanes);
+
+				VecPack<3, float32, W> t;
+				t.c[0] = (q.c[1] * v.c[2] - q.c[2] * v.c[1]) * two;
+				t.c[1] = (q.c[2] * v.c[0] - q.c[0] * v.c[2]) * two;
+				t.c[2] = (q.c[0] * v.c[1] - q.c[1] * v.c[0]) * two;
+
+				v.c[0] = v.c[0] + t.c[0] * q.c[3] + (q.c[1] * t.c[2] - q.c[2] * t.c[1]);
+				v.c[1] = v.c[1] + t.c[1] * q.c[3] + (q.c[2] * t.c[0] - q.c[0] * t.c[2]);
+				v.c[2] = v.c[2] + t.c[2] * q.c[3] + (q.c[0] * t.c[1] - q.c[1] * t.c[0]);
+
+				out.StorePack(i, lanes, v);
+			});
+		});
+	}
+
+	// POSE BLENDING
+
+	template<size_t W = simd::NativeWidth<float32>>
+	using QuatPack = VecPack<4, float32, W>;
+
+	template<size_t Terms, size_t W>
+	simd::Pack<float32, W> SlerpCoefficient(const simd::Pack<float32, W>& t, const simd::Pack<float32, W>& xm1)
+	{
+		using S = SlerpSeries<Terms>;
+		using PackType = simd::Pack<float32, W>;
+
+		const PackType one = PackType::Broadcast(1.0f);
+		PackType sqrT = t * t;
+		PackType result = one;
+		for (size_t i = Terms; i-- > 0;)
+		{
+			PackType term = MulAdd(PackType::Broadcast(S::U[i]), sqrT, PackType::Broadcast(-S::V[i]));
+			result = MulAdd(term * xm1, result, one);
+		}
+		return t * result;
+	}
+
+	template<size_t Terms, size_t W>
+	QuatPack<W> SlerpPolynomial(const QuatPack<W>& a, const QuatPack<W>& b, const simd::Pack<float32, W>& t)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		const PackType one = PackType::Broadcast(1.0f);
+		PackType x = Dot(a, b);
+		auto flip = x < PackType::Zero();
+
+		PackType xm1 = Abs(x) - one;
+		PackType c0 = SlerpCoefficient<Terms>(one - t, xm1);
+		PackType c1 = SlerpCoefficient<Terms>(t, xm1);
+		c1 = Select(flip, -c1, c1);
+
+		QuatPack<W> result;
+		for (size_t c = 0; c < 4; ++c)
+		{
+			result.c[c] = MulAdd(b.c[c], c1, a.c[c] * c0);
+		}
+		return result;
+	}
+
+	template<size_t W>
+	QuatPack<W> Nlerp(const QuatPack<W>& a, const QuatPack<W>& b, const simd::Pack<float32, W>& t)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		PackType w1 = Select(Dot(a, b) < PackType::Zero(), -t, t);
+		PackType w0 = PackType::Broadcast(1.0f) - t;
+
+		QuatPack<W> result;
+		for (size_t c = 0; c < 4; ++c)
+		{
+			result.c[c] = MulAdd(b.c[c], w1, a.c[c] * w0);
+		}
+
+		PackType len = Sqrt(Dot(result, result));
+		for (size_t c = 0; c < 4; ++c)
+		{
+			result.c[c] = result.c[c] / len;
+		}
+		return result;
+	}
+
+	// Runs blend(a, b, i, lanes) over W poses at a time, transposing the x, y, z, w
+	// arrays in and out of registers.
+	template<size_t W, typename Blend>
+	void ForEachPosePack(std::span<const Quaternion> a, std::span<const Quaternion> b, std::span<Quaternion> out, Blend&& blend)
+	{
+		assert(b.size() == a.size() && out.size() >= a.size());
+
+		const float32* pa = reinterpret_cast<const float32*>(a.data());
+		const float32* pb = reinterpret_cast<const float32*>(b.data());
+		float32* po = reinterpret_cast<float32*>(out.data());
+
+		simd::ForEachPack<float32, W>(a.size(), [&](size_t i, size_t lanes)
+		{
+			QuatPack<W> qa, qb;
+			if (lanes == W)
+			{
+				simd::LoadInterleaved4(pa + i * 4, qa.c[0], qa.c[1], qa.c[2], qa.c[3]);
+				simd::LoadInterleaved4(pb + i * 4, qb.c[0], qb.c[1], qb.c[2], qb.c[3]);
+				QuatPack<W> r = blend(qa, qb, i, lanes);
+				simd::StoreInterleaved4(po + i * 4, r.c[0], r.c[1], r.c[2], r.c[3]);
+				return;
+			}
+
+			// Tail: identity padding keeps the unused lanes finite. A single lane has none.
+			if constexpr (W > 1)
+			{
+				std::array<Quaternion, W> ta, tb, tr;
+				std::copy_n(a.begin() + i, lanes, ta.begin());
+				std::copy_n(b.begin() + i, lanes, tb.begin());
+
+				const float32* fa = reinterpret_cast<const float32*>(ta.data());
+				const float32* fb = reinterpret_cast<const float32*>(tb.data());
+				simd::LoadInterleaved4(fa, qa.c[0], qa.c[1], qa.c[2], qa.c[3]);
+				simd::LoadInterleaved4(fb, qb.c[0], qb.c[1], qb.c[2], qb.c[3]);
+				QuatPack<W> r = blend(qa, qb, i, lanes);
+				simd::StoreInterleaved4(reinterpret_cast<float32*>(tr.data()), r.c[0], r.c[1], r.c[2], r.c[3]);
+				std::copy_n(tr.begin(), lanes, out.begin() + i);
+			}
+		});
+	}
+
+	template<size_t W, typename Blend>
+	void ForEachPosePack(const QuaternionStream& a, const QuaternionStream& b, QuaternionStream& out, Blend&& blend)
+	{
+		assert(b.Size() == a.Size());
+		out.Resize(a.Size());
+
+		simd::ForEachPack<float32, W>(a.Size(), [&](size_t i, size_t lanes)
+		{
+			out.StorePack(i, lanes, blend(a.LoadPack<W>(i, lanes), b.LoadPack<W>(i, lanes), i, lanes));
+		});
+	}
+
+	template<typename Blend>
+	void ForEachPose(std::span<const Quaternion> a, std::span<const Quaternion> b, std::span<Quaternion> out, Blend&& blend)
+	{
+		assert(b.size() == a.size() && out.size() >= a.size());
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			out[i] = blend(a[i], b[i], i);
+		}
+	}
+
+	template<typename Blend>
+	void ForEachPose(const QuaternionStream& a, const QuaternionStream& b, QuaternionStream& out, Blend&& blend)
+	{
+		assert(b.Size() == a.Size());
+		out.Resize(a.Size());
+		for (size_t i = 0; i < a.Size(); ++i)
+		{
+			out.Set(i, blend(a.Get(i), b.Get(i), i));
+		}
+	}
+
+	// t[i * tStride]: stride 0 blends every pose by the same weight.
+	template<typename Poses, typename OutPoses>
+	void BlendPosesStrided(const Poses& a, const Poses& b, const float32* t, size_t tStride, OutPoses& out, SlerpPrecision precision)
+	{
+		if (precision == SlerpPrecision::Exact)
+		{
+			ForEachPose(a, b, out, [&](const Quaternion& qa, const Quaternion& qb, size_t i)
+			{
+				return Slerp(qa, qb, t[i * tStride]);
+			});
+			return;
+		}
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			auto weights = [=](size_t i, size_t lanes)
+			{
+				return tStride == 0 ? PackType::Broadcast(*t) : PackType::LoadPartial(t + i, lanes);
+			};
+
+			if (precision == SlerpPrecision::Accurate)
+			{
+				ForEachPosePack<W>(a, b, out, [&](const QuatPack<W>& qa, const QuatPack<W>& qb, size_t i, size_t lanes)
+				{
+					return SlerpPolynomial<16>(qa, qb, weights(i, lanes));
+				});
+			}
+			else
+			{
+				ForEachPosePack<W>(a, b, out, [&](const QuatPack<W>& qa, const QuatPack<W>& qb, size_t i, size_t lanes)
+				{
+					return SlerpPolynomial<8>(qa, qb, weights(i, lanes));
+				});
+			}
+		});
+	}
+
+	// Slerp of bone rotation arrays, AoS spans or SoA streams. Exact loops Slerp(); the
+	// polynomial tiers (see SlerpPrecision) need unit inputs and call no acos/sin.
+	// Max error against double-precision slerp, per component:
+	//   Accurate: 2e-7 (float32 rounding)
+	//   Fast:     3e-5
+	inline void BlendPoses(std::span<const Quaternion> a, std::span<const Quaternion> b, float32 t, std::span<Quaternion> out, SlerpPrecision precision = SlerpPrecision::Accurate)
+	{
+		BlendPosesStrided(a, b, &t, 0, out, precision);
+	}
+
+	inline void BlendPoses(std::span<const Quaternion> a, std::span<const Quaternion> b, std::span<const float32> t, std::span<Quaternion> out, SlerpPrecision precision = SlerpPrecision::Accurate)
+	{
+		assert(t.size() >= a.size());
+		BlendPosesStrided(a, b, t.data(), 1, out, precision);
+	}
+
+	inline void BlendPoses(const QuaternionStream& a, const QuaternionStream& b, float32 t, QuaternionStream& out, SlerpPrecision precision = SlerpPrecision::Accurate)
+	{
+		BlendPosesStrided(a, b, &t, 0, out, precision);
+	}
+
+	inline void BlendPoses(const QuaternionStream& a, const QuaternionStream& b, std::span<const float32> t, QuaternionStream& out, SlerpPrecision precision = SlerpPrecision::Accurate)
+	{
+		assert(t.size() >= a.Size());
+		BlendPosesStrided(a, b, t.data(), 1, out, precision);
+	}
+
+	// Nlerp() of bone rotation arrays, t[i * tStride] as in BlendPosesStrided.
+	template<typename Poses, typename OutPoses>
+	void NlerpPosesStrided(const Poses& a, const Poses& b, const float32* t, size_t tStride, OutPoses& out)
+	{
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			ForEachPosePack<W>(a, b, out, [&](const QuatPack<W>& qa, const QuatPack<W>& qb, size_t i, size_t lanes)
+			{
+				return Nlerp(qa, qb, tStride == 0 ? PackType::Broadcast(*t) : PackType::LoadPartial(t + i, lanes));
+			});
+		});
+	}
+
+	inline void NlerpPoses(std::span<const Quaternion> a, std::span<const Quaternion> b, float32 t, std::span<Quaternion> out)
+	{
+		NlerpPosesStrided(a, b, &t, 0, out);
+	}
+
+	inline void NlerpPoses(std::span<const Quaternion> a, std::span<const Quaternion> b, std::span<const float32> t, std::span<Quaternion> out)
+	{
+		assert(t.size() >= a.size());
+		NlerpPosesStrided(a, b, t.data(), 1, out);
+	}
+
+	inline void NlerpPoses(const QuaternionStream& a, const QuaternionStream& b, float32 t, QuaternionStream& out)
+	{
+		NlerpPosesStrided(a, b, &t, 0, out);
+	}
+
+	inline void NlerpPoses(const QuaternionStream& a, const QuaternionStream& b, std::span<const float32> t, QuaternionStream& out)
+	{
+		assert(t.size() >= a.Size());
+		NlerpPosesStrided(a, b, t.data(), 1, out);
+	}
+
+	// ROTATION CONVERSIONS
+	// SoA versions of the Quaternion conversions, one simd::Dispatch pack per iteration.
+	// Max error against the scalar functions: 2e-7 per component for FromRotationMatrix,
+	// ToMatrix3 and ToMatrix4; FromEuler and ToEuler add the math::fast error of the tier,
+	// ToEuler away from gimbal lock (mathlib/tests.cpp checks each at every level).
+
+	// Quaternion::FromEuler() of (pitch, yaw, roll) triples.
+	inline void FromEuler(const Vec3Stream& euler, QuaternionStream& out, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		out.Resize(euler.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType half = PackType::Broadcast(0.5f);
+
+			simd::ForEachPack<float32, W>(euler.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<3, float32, W> angles = euler.LoadPack<W>(i, lanes);
+
+				PackType sp, cp, sy, cy, sr, cr;
+				fast::SinCos(angles.c[0] * half, sp, cp, precision);
+				fast::SinCos(angles.c[1] * half, sy, cy, precision);
+				fast::SinCos(angles.c[2] * half, sr, cr, precision);
+
+				PackType cpcy = cp * cy, spsy = sp * sy, cpsy = cp * sy, spcy = sp * cy;
+
+				QuatPack<W> q;
+				q.c[0] = sr * cpcy - cr * spsy;
+				q.c[1] = cr * spcy + sr * cpsy;
+				q.c[2] = cr * cpsy - sr * spcy;
+				q.c[3] = cr * cpcy + sr * spsy;
+
+				out.StorePack(i, lanes, q);
+			});
+		});
+	}
+
+	// Quaternion::ToEuler() of each rotation, gimbal lock clamped to +-pi/2 pitch.
+	inline void ToEuler(const QuaternionStream& rotations, Vec3Stream& out, TrigPrecision precision = TrigPrecision::Accurate)
+	{
+		out.Resize(rotations.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType one = PackType::Broadcast(1.0f);
+			const PackType two = PackType::Broadcast(2.0f);
+
+			simd::ForEachPack<float32, W>(rotations.Size(), [&](size_t i, size_t lanes)
+			{
+				QuatPack<W> q = rotations.LoadPack<W>(i, lanes);
+				const PackType& x = q.c[0];
+				const PackType& y = q.c[1];
+				const PackType& z = q.c[2];
+				const PackType& w = q.c[3];
+
+				PackType sinp = two * (w * x - z * y);
+
+				VecPack<3, float32, W> angles;
+				angles.c[0] = fast::Asin(Max(Min(sinp, one), -one), precision);
+				angles.c[1] = fast::Atan2(two * (w * y + z * x), one - two * (x * x + y * y), precision);
+				angles.c[2] = fast::Atan2(two * (w * z + x * y), one - two * (z * z + x * x), precision);
+
+				out.StorePack(i, lanes, angles);
+			});
+		});
+	}
+
+	// Quaternion::FromRotationMatrix() without the branch on the trace: the four
+	// candidates share one sqrt, the largest diagonal term is picked per lane.
+	inline void FromRotationMatrix(const Mat3Stream& m, QuaternionStream& out)
+	{
+		out.Resize(m.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType one = PackType::Broadcast(1.0f);
+			const PackType half = PackType::Broadcast(0.5f);
+			const PackType zero = PackType::Zero();
+
+			simd::ForEachPack<float32, W>(m.Size(), [&](size_t i, size_t lanes)
+			{
+				auto at = [&](size_t row, size_t col) { return PackType::LoadPartial(m.Data(row, col) + i, lanes); };
+
+				PackType m00 = at(0, 0), m11 = at(1, 1), m22 = at(2, 2);
+				PackType m01 = at(0, 1), m10 = at(1, 0);
+				PackType m02 = at(0, 2), m20 = at(2, 0);
+				PackType m12 = at(1, 2), m21 = at(2, 1);
+
+				PackType trace = m00 + m11 + m22;
+				// Same priority as the scalar branches: w, then x, then y, else z.
+				auto useW = trace > zero;
+				auto useX = (m00 > m11) & (m00 > m22);
+				auto useY = m11 > m22;
+
+				// Scaled by 4 s: the picked component is its radicand, the others the
+				// sums and differences of the off-diagonal terms.
+				PackType rw = trace + one;
+				PackType rx = one + m00 - m11 - m22;
+				PackType ry = one + m11 - m00 - m22;
+				PackType rz = one + m22 - m00 - m11;
+				PackType dx = m21 - m12, dy = m02 - m20, dz = m10 - m01;
+				PackType sxy = m01 + m10, sxz = m02 + m20, syz = m12 + m21;
+
+				PackType radicand = Select(useW, rw, Select(useX, rx, Select(useY, ry, rz)));
+				PackType scale = half / Sqrt(radicand);
+
+				QuatPack<W> q;
+				q.c[0] = Select(useW, dx, Select(useX, rx, Select(useY, sxy, sxz))) * scale;
+				q.c[1] = Select(useW, dy, Select(useX, sxy, Select(useY, ry, syz))) * scale;
+				q.c[2] = Select(useW, dz, Select(useX, sxz, Select(useY, syz, rz))) * scale;
+				q.c[3] = Select(useW, rw, Select(useX, dx, Select(useY, dy, dz))) * scale;
+
+				out.StorePack(i, lanes, q);
+			});
+		});
+	}
+
+	template<size_t W>
+	void RotationColumns(const QuatPack<W>& q, std::array<simd::Pack<float32, W>, 9>& r)
+	{
+		using PackType = simd::Pack<float32, W>;
+
+		const PackType one = PackType::Broadcast(1.0f);
+		const PackType two = PackType::Broadcast(2.0f);
+
+		const PackType& x = q.c[0];
+		const PackType& y = q.c[1];
+		const PackType& z = q.c[2];
+		const PackType& w = q.c[3];
+
+		PackType xx = x * x, yy = y * y, zz = z * z;
+		PackType xy = x * y, xz = x * z, yz = y * z;
+		PackType wx = w * x, wy = w * y, wz = w * z;
+
+		r[0] = one - two * (yy + zz);
+		r[1] = two * (xy + wz);
+		r[2] = two * (xz - wy);
+
+		r[3] = two * (xy - wz);
+		r[4] = one - two * (xx + zz);
+		r[5] = two * (yz + wx);
+
+		r[6] = two * (xz + wy);
+		r[7] = two * (yz - wx);
+		r[8] = one - two * (xx + yy);
+	}
+
+	inline void ToMatrix3(const QuaternionStream& rotations, Mat3Stream& out)
+	{
+		out.Resize(rotations.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::ForEachPack<float32, W>(rotations.Size(), [&](size_t i, size_t lanes)
+			{
+				VecPack<9, float32, W> m;
+				RotationColumns(rotations.LoadPack<W>(i, lanes), m.c);
+				out.StorePack(i, lanes, m);
+			});
+		});
+	}
+
+	inline void ToMatrix4(const QuaternionStream& rotations, Mat4Stream& out)
+	{
+		out.Resize(rotations.Size());
+
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			using PackType = simd::Pack<float32, W>;
+
+			const PackType zero = PackType::Zero();
+			const PackType one = PackType::Broadcast(1.0f);
+
+			simd::ForEachPack<float32, W>(rotations.Size(), [&](size_t i, size_t lanes)
+			{
+				std::array<PackType, 9> r;
+				RotationColumns(rotations.LoadPack<W>(i, lanes), r);
+
+				VecPack<16, float32, W> m;
+				for (size_t col = 0; col < 3; ++col)
+				{
+					for (size_t row = 0; row < 3; ++row)
+					{
+						m.c[col * 4 + row] = r[col * 3 + row];
+					}
+					m.c[col * 4 + 3] = zero;
+					m.c[12 + col] = zero;
+				}
+				m.c[15] = one;
+
+				out.StorePack(i, lanes, m);
+			});
+		});
+	}
+}
+
+#endif // MATHLIB_STREAM_HPP
@@ -3,12 +3,17 @@
 #pragma once
 
 #include <math/matrix.hpp>
+#include <math/quaternion.hpp>
+#include <math/fast.hpp>
+
+#include <cstddef>
+#include <span>
 
 namespace math
 {
 	// TRANSFORM MATRIX
 
-	inline Mat4 Translate(const Vec3& t)
+	constexpr Mat4 Translate(const Vec3& t)
 	{
 		Mat4 result = Identity<Mat4>();
 		result(0, 3) = t[0];
@@ -17,7 +22,7 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 Scale(const Vec3& s)
+	constexpr Mat4 Scale(const Vec3& s)
 	{
 		Mat4 result = Identity<Mat4>();
 		result(0, 0) = s[0];
@@ -26,11 +31,11 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 RotateX(float32 angle)
+	constexpr Mat4 RotateX(float32 angle, TrigPrecision precision = TrigPrecision::Exact)
 	{
 		Mat4 result = Identity<Mat4>();
-		float32 c = std::cos(angle);
-		float32 s = std::sin(angle);
+		float32 s, c;
+		fast::SinCos(angle, s, c, precision);
 
 		result(1, 1) = c;
 		result(1, 2) = -s;
@@ -40,11 +45,11 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 RotateY(float32 angle)
+	constexpr Mat4 RotateY(float32 angle, TrigPrecision precision = TrigPrecision::Exact)
 	{
 		Mat4 result = Identity<Mat4>();
-		float32 c = std::cos(angle);
-		float32 s = std::sin(angle);
+		float32 s, c;
+		fast::SinCos(angle, s, c, precision);
 
 		result(0, 0) = c;
 		result(0, 2) = s;
@@ -54,11 +59,11 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 RotateZ(float32 angle)
+	constexpr Mat4 RotateZ(float32 angle, TrigPrecision precision = TrigPrecision::Exact)
 	{
 		Mat4 result = Identity<Mat4>();
-		float32 c = std::cos(angle);
-		float32 s = std::sin(angle);
+		float32 s, c;
+		fast::SinCos(angle, s, c, precision);
 
 		result(0, 0) = c;
 		result(0, 1) = -s;
@@ -68,14 +73,14 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 Rotate(float32 pitch, float32 yaw, float32 roll)
+	constexpr Mat4 Rotate(float32 pitch, float32 yaw, float32 roll, TrigPrecision precision = TrigPrecision::Exact)
 	{
-		return RotateZ(roll) * RotateY(yaw) * RotateX(pitch);
+		return RotateZ(roll, precision) * RotateY(yaw, precision) * RotateX(pitch, precision);
 	}
 
 	// CAMERA MATRIX
 
-	inline Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+	constexpr Mat4 LookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
 	{
 		Vec3 forward = (target - eye).Normalize();
 		Vec3 right = Cross(up.Normalize(), forward).Normalize();
@@ -104,12 +109,12 @@ namespace math
 
 	// PROJECTION MATRIX
 
-	inline Mat4 Perspective(float32 fovRadians, float32 aspect, float32 nearZ, float32 farZ)
+	constexpr Mat4 Perspective(float32 fovRadians, float32 aspect, float32 nearZ, float32 farZ, TrigPrecision precision = TrigPrecision::Exact)
 	{
 		assert(aspect != 0);
 		assert(farZ != nearZ);
 
-		float32 f = 1.0f / std::tan(fovRadians / 2.0f);
+		float32 f = 1.0f / fast::Tan(fovRadians / 2.0f, precision);
 
 		Mat4 result = Zero<Mat4>();
 		result(0, 0) = f / aspect;
@@ -121,7 +126,7 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 Ortho(float32 left, float32 right, float32 bottom, float32 top, float32 nearZ, float32 farZ)
+	constexpr Mat4 Ortho(float32 left, float32 right, float32 bottom, float32 top, float32 nearZ, float32 farZ)
 	{
 		Mat4 result = Identity<Mat4>();
 
@@ -136,15 +141,36 @@ namespace math
 		return result;
 	}
 
-	inline Mat4 TransformMatrix(const Vec3& position, const Vec3& rotationEuler, const Vec3& scale)
+	// Translate(position) * Rotate(pitch, yaw, roll) * Scale(scale), written in one pass.
+	constexpr Mat4 TransformMatrix(const Vec3& position, const Vec3& rotationEuler, const Vec3& scale)
 	{
-		Mat4 T = Translate(position);
-		Mat4 R = Rotate(rotationEuler[0], rotationEuler[1], rotationEuler[2]);
-		Mat4 S = Scale(scale);
-		return T * R * S;
+		Vec3 s, c;
+		fast::SinCos(rotationEuler, s, c, TrigPrecision::Exact);
+
+		// RotateZ(roll) * RotateY(yaw) * RotateX(pitch)
+		float32 sx = s[0], sy = s[1], sz = s[2];
+		float32 cx = c[0], cy = c[1], cz = c[2];
+
+		Mat4 result = Identity<Mat4>();
+		result(0, 0) = cz * cy * scale[0];
+		result(1, 0) = sz * cy * scale[0];
+		result(2, 0) = -sy * scale[0];
+
+		result(0, 1) = (cz * sy * sx - sz * cx) * scale[1];
+		result(1, 1) = (sz * sy * sx + cz * cx) * scale[1];
+		result(2, 1) = cy * sx * scale[1];
+
+		result(0, 2) = (cz * sy * cx + sz * sx) * scale[2];
+		result(1, 2) = (sz * sy * cx - cz * sx) * scale[2];
+		result(2, 2) = cy * cx * scale[2];
+
+		result(0, 3) = position[0];
+		result(1, 3) = position[1];
+		result(2, 3) = position[2];
+		return result;
 	}
 
-	inline Mat4 InverseLookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
+	constexpr Mat4 InverseLookAt(const Vec3& eye, const Vec3& target, const Vec3& up)
 	{
 		Vec3 forward = (target - eye).Normalize();
 		Vec3 right = Cross(up.Normalize(), forward).Normalize();
@@ -171,7 +197,7 @@ namespace math
 		return result;
 	}
 
-	inline void DecomposeTransform(const Mat4& m, Vec3& position, Vec3& rotationEuler, Vec3& scale)
+	constexpr void DecomposeTransform(const Mat4& m, Vec3& position, Vec3& rotationEuler, Vec3& scale)
 	{
 		position = { m(0, 3), m(1, 3), m(2, 3) };
 
@@ -184,24 +210,24 @@ namespace math
 		rot(0, 1) /= scale[1]; rot(1, 1) /= scale[1]; rot(2, 1) /= scale[1];
 		rot(0, 2) /= scale[2]; rot(1, 2) /= scale[2]; rot(2, 2) /= scale[2];
 
-		rotationEuler[1] = std::asin(-rot(0, 2));
-		if (std::cos(rotationEuler[1]) != 0.0f)
+		rotationEuler[1] = Asin(-rot(0, 2));
+		if (Cos(rotationEuler[1]) != 0.0f)
 		{
-			rotationEuler[0] = std::atan2(rot(1, 2), rot(2, 2));
-			rotationEuler[2] = std::atan2(rot(0, 1), rot(0, 0));
+			rotationEuler[0] = Atan2(rot(1, 2), rot(2, 2));
+			rotationEuler[2] = Atan2(rot(0, 1), rot(0, 0));
 		}
 		else
 		{
 			rotationEuler[0] = 0;
-			rotationEuler[2] = std::atan2(-rot(1, 0), rot(1, 1));
+			rotationEuler[2] = Atan2(-rot(1, 0), rot(1, 1));
 		}
 	}
 
-	inline Mat4 RotateAxis(const Vec3& axis, float32 angle)
+	constexpr Mat4 RotateAxis(const Vec3& axis, float32 angle, TrigPrecision precision = TrigPrecision::Exact)
 	{
 		Vec3 a = axis.Normalize();
-		float32 c = std::cos(angle);
-		float32 s = std::sin(angle);
+		float32 s, c;
+		fast::SinCos(angle, s, c, precision);
 		float32 t = 1.0f - c;
 
 		Mat4 result = Identity<Mat4>();
@@ -221,27 +247,27 @@ namespace math
 		return result;
 	}
 
-	inline Vec3 ExtractRight(const Mat4& m)
+	constexpr Vec3 ExtractRight(const Mat4& m)
 	{
 		return Vec3(m(0, 0), m(1, 0), m(2, 0));
 	}
 
-	inline Vec3 ExtractUp(const Mat4& m)
+	constexpr Vec3 ExtractUp(const Mat4& m)
 	{
 		return Vec3(m(0, 1), m(1, 1), m(2, 1));
 	}
 
-	inline Vec3 ExtractForward(const Mat4& m)
+	constexpr Vec3 ExtractForward(const Mat4& m)
 	{
 		return Vec3(m(0, 2), m(1, 2), m(2, 2));
 	}
 
-	inline Vec3 ExtractPosition(const Mat4& m)
+	constexpr Vec3 ExtractPosition(const Mat4& m)
 	{
 		return Vec3(m(0, 3), m(1, 3), m(2, 3));
 	}
 
-	inline Vec3 ExtractScale(const Mat4& m)
+	constexpr Vec3 ExtractScale(const Mat4& m)
 	{
 		Vec3 right = ExtractRight(m);
 		Vec3 up = ExtractUp(m);
@@ -250,7 +276,7 @@ namespace math
 		return Vec3(right.Length(), up.Length(), forward.Length());
 	}
 
-	inline Mat4 FromBasis(const Vec3& right, const Vec3& up, const Vec3& forward, const Vec3& position = Vec3(0, 0, 0))
+	constexpr Mat4 FromBasis(const Vec3& right, const Vec3& up, const Vec3& forward, const Vec3& position = Vec3(0, 0, 0))
 	{
 		Mat4 result = Identity<Mat4>();
 
@@ -272,6 +298,236 @@ namespace math
 
 		return result;
 	}
+
+	// AFFINE INVERSE
+
+	// Inverse of an affine matrix (bottom row 0, 0, 0, 1), as built by TransformMatrix,
+	// Translate, Scale, RotateAxis, LookAt or FromBasis.
+	constexpr Mat4 InverseAffine(const Mat4& m)
+	{
+		Mat4 result;
+#if defined(MATHLIB_SSE2)
+		if (!std::is_constant_evaluated())
+		{
+			simd::InverseAffine4(m.Data(), result.Data());
+			return result;
+		}
+#endif
+		float32 c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+		float32 c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+		float32 c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+
+		float32 det = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+		assert(det != 0.0f);
+		float32 invDet = 1.0f / det;
+
+		result(0, 0) = c00 * invDet;
+		result(1, 0) = c01 * invDet;
+		result(2, 0) = c02 * invDet;
+		result(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * invDet;
+		result(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * invDet;
+		result(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * invDet;
+		result(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * invDet;
+		result(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * invDet;
+		result(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * invDet;
+
+		for (size_t i = 0; i < 3; ++i)
+		{
+			result(i, 3) = -(result(i, 0) * m(0, 3) + result(i, 1) * m(1, 3) + result(i, 2) * m(2, 3));
+		}
+		result(3, 3) = 1.0f;
+		return result;
+	}
+
+	// Inverse of a rotation + translation matrix (no scale), as built by LookAt or
+	// FromBasis with an orthonormal basis.
+	constexpr Mat4 InverseRigid(const Mat4& m)
+	{
+		Mat4 result;
+#if defined(MATHLIB_SSE2)
+		if (!std::is_constant_evaluated())
+		{
+			simd::InverseRigid4(m.Data(), result.Data());
+			return result;
+		}
+#endif
+		for (size_t i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				result(i, j) = m(j, i);
+			}
+			result(i, 3) = -(m(0, i) * m(0, 3) + m(1, i) * m(1, 3) + m(2, i) * m(2, 3));
+		}
+		result(3, 3) = 1.0f;
+		return result;
+	}
+
+	// TRS TRANSFORM
+	// Translation, rotation and scale kept apart, applied scale first: p + r * (s * v).
+	// Each member starts a 16-byte slot so it loads as one register; the padding lanes
+	// of position and scale are not read.
+
+	struct alignas(16) Transform
+	{
+		alignas(16) Vec3 position;
+		alignas(16) Quaternion rotation;
+		alignas(16) Vec3 scale;
+
+		constexpr Transform() : position(0, 0, 0), rotation(), scale(1, 1, 1) {}
+		constexpr Transform(const Vec3& position, const Quaternion& rotation, const Vec3& scale = Vec3(1, 1, 1)) : position(position), rotation(rotation), scale(scale) {}
+
+		// Affine matrix without shear; scale signs are folded into the rotation.
+		static constexpr Transform FromMatrix(const Mat4& m)
+		{
+			Vec3 s = ExtractScale(m);
+			if (Dot(Cross(ExtractRight(m), ExtractUp(m)), ExtractForward(m)) < 0.0f)
+			{
+				s[0] = -s[0];
+			}
+
+			Mat3 r;
+			for (size_t col = 0; col < 3; ++col)
+			{
+				for (size_t row = 0; row < 3; ++row)
+				{
+					r(row, col) = m(row, col) / s[col];
+				}
+			}
+			return Transform(ExtractPosition(m), Quaternion::FromRotationMatrix(r).Normalize(), s);
+		}
+
+		constexpr Vec3 TransformPoint(const Vec3& p) const
+		{
+#if defined(MATHLIB_SSE2)
+			if (!std::is_constant_evaluated())
+			{
+				Vec3 result;
+				simd::TransformPointTRS(reinterpret_cast<const float32*>(this), p.Data(), result.Data());
+				return result;
+			}
+#endif
+			return position + rotation * (scale * p);
+		}
+
+		constexpr Vec3 TransformVector(const Vec3& v) const
+		{
+			return rotation * (scale * v);
+		}
+
+		constexpr Vec3 InverseTransformPoint(const Vec3& p) const
+		{
+			return (rotation.Conjugate() * (p - position)) / scale;
+		}
+
+		// Exact when scale is uniform; with non-uniform scale the result keeps the TRS
+		// form, so the shear the exact inverse would need is dropped.
+		constexpr Transform Inverse() const
+		{
+			Vec3 invScale = Vec3(1, 1, 1) / scale;
+			Quaternion invRotation = rotation.Conjugate();
+			return Transform(invRotation * (position * -1.0f) * invScale, invRotation, invScale);
+		}
+
+		// Translate(position) * rotation * Scale(scale), written in one pass.
+		constexpr Mat4 ToMatrix4() const
+		{
+			const float32 x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+			float32 xx = x * x, yy = y * y, zz = z * z;
+			float32 xy = x * y, xz = x * z, yz = y * z;
+			float32 wx = w * x, wy = w * y, wz = w * z;
+
+			Mat4 result = Identity<Mat4>();
+			result(0, 0) = (1.0f - 2.0f * (yy + zz)) * scale[0];
+			result(1, 0) = 2.0f * (xy + wz) * scale[0];
+			result(2, 0) = 2.0f * (xz - wy) * scale[0];
+
+			result(0, 1) = 2.0f * (xy - wz) * scale[1];
+			result(1, 1) = (1.0f - 2.0f * (xx + zz)) * scale[1];
+			result(2, 1) = 2.0f * (yz + wx) * scale[1];
+
+			result(0, 2) = 2.0f * (xz + wy) * scale[2];
+			result(1, 2) = 2.0f * (yz - wx) * scale[2];
+			result(2, 2) = (1.0f - 2.0f * (xx + yy)) * scale[2];
+
+			result(0, 3) = position[0];
+			result(1, 3) = position[1];
+			result(2, 3) = position[2];
+			return result;
+		}
+
+		constexpr bool operator==(const Transform& other) const
+		{
+			return position == other.position && rotation == other.rotation && scale == other.scale;
+		}
+
+		constexpr bool NearlyEquals(const Transform& other, float32 epsilon = EPSILON_f32) const
+		{
+			return position.NearlyEquals(other.position, epsilon) && rotation.NearlyEquals(other.rotation, epsilon) && scale.NearlyEquals(other.scale, epsilon);
+		}
+	};
+
+	// The simd TRS kernels take the whole Transform as one float array.
+	static_assert(sizeof(Transform) == 48 && alignof(Transform) == 16, "Transform must be three 16-byte slots");
+	static_assert(offsetof(Transform, position) == 0 && offsetof(Transform, rotation) == 16 && offsetof(Transform, scale) == 32, "Transform slots are position, rotation, scale");
+
+	// parent applied after child, as the Mat4 product parent * child. Scales multiply per
+	// axis: exact when the parent scale is uniform or the child rotation keeps the axes.
+	constexpr Transform Compose(const Transform& parent, const Transform& child)
+	{
+#if defined(MATHLIB_SSE2)
+		if (!std::is_constant_evaluated())
+		{
+			Transform result;
+			simd::ComposeTRS(reinterpret_cast<const float32*>(&parent), reinterpret_cast<const float32*>(&child), reinterpret_cast<float32*>(&result));
+			return result;
+		}
+#endif
+		return Transform(parent.TransformPoint(child.position), parent.rotation * child.rotation, parent.scale * child.scale);
+	}
+
+	constexpr Transform operator*(const Transform& parent, const Transform& child)
+	{
+		return Compose(parent, child);
+	}
+
+	// Position and scale interpolate linearly, rotation along the shorter arc (Nlerp).
+	constexpr Transform Lerp(const Transform& a, const Transform& b, float32 t)
+	{
+		return Transform(Lerp(a.position, b.position, t), Nlerp(a.rotation, b.rotation, t), Lerp(a.scale, b.scale, t));
+	}
+
+	// BATCHED TRANSFORMS
+	// out may alias points. Outputs over MATHLIB_STREAMING_STORE_BYTES use non-temporal stores.
+
+	static_assert(sizeof(Vec3) == 3 * sizeof(float32), "Batched transforms read Vec3 spans as packed floats");
+
+	inline void TransformPoints(const Mat4& m, std::span<const Vec3> points, std::span<Vec3> out)
+	{
+		assert(out.size() >= points.size());
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::TransformVec3<simd::TransformKind::Point, W>(m.Data(), reinterpret_cast<const float32*>(points.data()), reinterpret_cast<float32*>(out.data()), points.size());
+		});
+	}
+
+	inline void TransformDirections(const Mat4& m, std::span<const Vec3> directions, std::span<Vec3> out)
+	{
+		assert(out.size() >= directions.size());
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::TransformVec3<simd::TransformKind::Direction, W>(m.Data(), reinterpret_cast<const float32*>(directions.data()), reinterpret_cast<float32*>(out.data()), directions.size());
+		});
+	}
+
+	inline void TransformPointsProjective(const Mat4& m, std::span<const Vec3> points, std::span<Vec3> out)
+	{
+		assert(out.size() >= points.size());
+		simd::Dispatch<float32>([&]<size_t W>()
+		{
+			simd::TransformVec3<simd::TransformKind::Projective, W>(m.Data(), reinterpret_cast<const float32*>(points.data()), reinterpret_cast<float32*>(out.data()), points.size());
+		});
+	}
 }
 
 #endif //MATHLIB_TRANSFORM_HPP
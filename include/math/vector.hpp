@@ -2,7 +2,9 @@
 #define MATH_VECTOR_HPP
 
 #include <math/common.hpp>
+#include <math/simd.hpp>
 
+#include <algorithm>
 #include <array>
 #include <assert.h>
 
@@ -17,22 +19,47 @@ namespace math
 	public:
 		Vec() = default;
 
-		Vec(std::initializer_list<T> list)
+		constexpr Vec(std::initializer_list<T> list)
 		{
 			assert(list.size() == N);
 			std::copy(list.begin(), list.end(), values.begin());
 		}
 
 		template<typename... Args, typename = std::enable_if_t<sizeof...(Args) == N>>
-		Vec(Args... args) : values{ static_cast<T>(args)... } {}
+		constexpr Vec(Args... args) : values{ static_cast<T>(args)... } {}
 
-		T operator[](size_t i) const { return values[i]; }
-		T& operator[](size_t i) { return values[i]; }
+		constexpr T operator[](size_t i) const { return values[i]; }
+		constexpr T& operator[](size_t i) { return values[i]; }
+
+		constexpr const T* Data() const { return values.data(); }
+		constexpr T* Data() { return values.data(); }
+
+		// SIMD BRIDGE
+
+		simd::Pack<T, 4> ToPack() const
+		{
+			return simd::LoadVec<N>(values.data());
+		}
+
+		static Vec<N, T> FromPack(const simd::Pack<T, 4>& pack)
+		{
+			Vec<N, T> result;
+			simd::StoreVec<N>(pack, result.values.data());
+			return result;
+		}
 
 		// OVERLOADED OPERATORS
 
-		Vec<N, T> operator+(const Vec<N, T>& other) const
+		constexpr Vec<N, T> operator+(const Vec<N, T>& other) const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() + other.ToPack());
+				}
+			}
+
 			Vec<N, T> result;
 			for (int32 i = 0; i < N; ++i)
 			{
@@ -41,8 +68,17 @@ namespace math
 			return result;
 		}
 
-		Vec<N, T> operator+=(const Vec<N, T>& other)
+		constexpr Vec<N, T> operator+=(const Vec<N, T>& other)
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					*this = FromPack(ToPack() + other.ToPack());
+					return *this;
+				}
+			}
+
 			for (int32 i = 0; i < N; ++i)
 			{
 				values[i] += other[i];
@@ -50,8 +86,16 @@ namespace math
 			return *this;
 		}
 
-		Vec<N, T> operator-(const Vec<N, T>& other) const
+		constexpr Vec<N, T> operator-(const Vec<N, T>& other) const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() - other.ToPack());
+				}
+			}
+
 			Vec<N, T> result;
 			for (int32 i = 0; i < N; ++i)
 			{
@@ -60,8 +104,17 @@ namespace math
 			return result;
 		}
 
-		Vec<N, T> operator-=(const Vec<N, T>& other)
+		constexpr Vec<N, T> operator-=(const Vec<N, T>& other)
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					*this = FromPack(ToPack() - other.ToPack());
+					return *this;
+				}
+			}
+
 			for (int32 i = 0; i < N; ++i)
 			{
 				values[i] -= other[i];
@@ -69,8 +122,16 @@ namespace math
 			return *this;
 		}
 
-		Vec<N, T> operator-() const
+		constexpr Vec<N, T> operator-() const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(-ToPack());
+				}
+			}
+
 			Vec<N, T> result;
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -79,8 +140,16 @@ namespace math
 			return result;
 		}
 
-		Vec<N, T> operator*(const Vec<N, T>& other) const
+		constexpr Vec<N, T> operator*(const Vec<N, T>& other) const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() * other.ToPack());
+				}
+			}
+
 			Vec<N, T> result;
 			for (int32 i = 0; i < N; ++i)
 			{
@@ -89,8 +158,17 @@ namespace math
 			return result;
 		}
 
-		Vec<N, T> operator*=(const Vec<N, T>& other)
+		constexpr Vec<N, T> operator*=(const Vec<N, T>& other)
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					*this = FromPack(ToPack() * other.ToPack());
+					return *this;
+				}
+			}
+
 			for (int32 i = 0; i < N; ++i)
 			{
 				values[i] *= other[i];
@@ -98,8 +176,16 @@ namespace math
 			return *this;
 		}
 
-		Vec<N, T> operator*(T scalar) const
+		constexpr Vec<N, T> operator*(T scalar) const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() * simd::Pack<T, 4>::Broadcast(scalar));
+				}
+			}
+
 			Vec<N, T> result;
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -108,13 +194,21 @@ namespace math
 			return result;
 		}
 
-		friend Vec<N, T> operator*(T scalar, const Vec<N, T>& vec)
+		friend constexpr Vec<N, T> operator*(T scalar, const Vec<N, T>& vec)
 		{
 			return vec * scalar;
 		}
 
-		Vec<N, T> operator/(const Vec<N, T>& other) const
+		constexpr Vec<N, T> operator/(const Vec<N, T>& other) const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() / other.ToPack());
+				}
+			}
+
 			Vec<N, T> result;
 			for (int32 i = 0; i < N; ++i)
 			{
@@ -123,8 +217,17 @@ namespace math
 			return result;
 		}
 
-		Vec<N, T> operator/=(const Vec<N, T>& other)
+		constexpr Vec<N, T> operator/=(const Vec<N, T>& other)
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					*this = FromPack(ToPack() / other.ToPack());
+					return *this;
+				}
+			}
+
 			for (int32 i = 0; i < N; ++i)
 			{
 				values[i] /= other[i];
@@ -132,7 +235,7 @@ namespace math
 			return *this;
 		}
 
-		bool operator==(const Vec<N, T>& other) const
+		constexpr bool operator==(const Vec<N, T>& other) const
 		{
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -144,12 +247,12 @@ namespace math
 			return true;
 		}
 
-		bool operator!=(const Vec<N, T>& other) const
+		constexpr bool operator!=(const Vec<N, T>& other) const
 		{
 			return !(*this == other);
 		}
 
-		bool NearlyEquals(const Vec<N, T>& other, T epsilon = static_cast<T>(EPSILON_f32)) const
+		constexpr bool NearlyEquals(const Vec<N, T>& other, T epsilon = static_cast<T>(EPSILON_f32)) const
 		{
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -161,18 +264,34 @@ namespace math
 			return true;
 		}
 
-		T Length() const
+		constexpr T Length() const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return Sqrt(simd::Dot<N>(ToPack(), ToPack()));
+				}
+			}
+
 			T sum = 0;
 			for (size_t i = 0; i < N; ++i)
 			{
 				sum += values[i] * values[i];
 			}
-			return std::sqrt(sum);
+			return Sqrt(sum);
 		}
 
-		T LengthSquared() const
+		constexpr T LengthSquared() const
 		{
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return simd::Dot<N>(ToPack(), ToPack());
+				}
+			}
+
 			T sum = 0;
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -181,11 +300,19 @@ namespace math
 			return sum;
 		}
 
-		Vec<N, T> Normalize() const
+		constexpr Vec<N, T> Normalize() const
 		{
 			T len = Length();
 			assert(len > 0);
 
+			if constexpr (simd::IsPackable<N, T>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					return FromPack(ToPack() / simd::Pack<T, 4>::Broadcast(len));
+				}
+			}
+
 			Vec<N, T> result;
 			for (size_t i = 0; i < N; ++i)
 			{
@@ -194,6 +321,34 @@ namespace math
 
 			return result;
 		}
+
+		constexpr T InvLength(SqrtPrecision precision = SqrtPrecision::Accurate) const
+		{
+			return simd::InvSqrt(LengthSquared(), precision);
+		}
+
+		// Multiplies by InvLength(precision) instead of dividing by Length().
+		constexpr Vec<N, T> NormalizeFast(SqrtPrecision precision = SqrtPrecision::Accurate) const
+		{
+			if (precision == SqrtPrecision::Exact)
+			{
+				return Normalize();
+			}
+
+			T lengthSquared = LengthSquared();
+			assert(lengthSquared > 0);
+			return (*this) * simd::InvSqrt(lengthSquared, precision);
+		}
+
+		// Returns fallback for zero, denormal-length or NaN vectors instead of asserting.
+		constexpr Vec<N, T> NormalizeSafe(const Vec<N, T>& fallback = Vec<N, T>(), SqrtPrecision precision = SqrtPrecision::Exact) const
+		{
+			if (!(LengthSquared() > std::numeric_limits<T>::min()))
+			{
+				return fallback;
+			}
+			return NormalizeFast(precision);
+		}
 	private:
 	};
 
@@ -208,6 +363,14 @@ namespace math
 	template<size_t N, typename T>
 	constexpr T Dot(const math::Vec<N, T> a, const math::Vec<N, T> b)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				return simd::Dot<N>(a.ToPack(), b.ToPack());
+			}
+		}
+
 		T sum = 0;
 		for (size_t i = 0; i < N; ++i)
 		{
@@ -229,14 +392,23 @@ namespace math
 	}
 
 	template<size_t N, typename T>
-	T Distance(const math::Vec<N, T>& a, const math::Vec<N, T>& b)
+	constexpr T Distance(const math::Vec<N, T>& a, const math::Vec<N, T>& b)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				simd::Pack<T, 4> diff = b.ToPack() - a.ToPack();
+				return Sqrt(simd::Dot<N>(diff, diff));
+			}
+		}
+
 		T sum = 0;
 		for (size_t i = 0; i < N; ++i)
 		{
 			sum += (b[i] - a[i]) * (b[i] - a[i]);
 		}
-		return std::sqrt(sum);
+		return Sqrt(sum);
 	}
 
 	template<size_t N, typename T>
@@ -248,7 +420,7 @@ namespace math
 	}
 
 	template<size_t N, typename T>
-	Vec<N, T> Refract(const Vec<N, T>& I, const Vec<N, T>& Norm, T Eta_In, T Eta_Out)
+	constexpr Vec<N, T> Refract(const Vec<N, T>& I, const Vec<N, T>& Norm, T Eta_In, T Eta_Out)
 	{
 		Vec<N, T> N_unit = Norm;           
 		Vec<N, T> I_unit = I;              
@@ -266,7 +438,7 @@ namespace math
 		}
 		else
 		{
-			T cos2 = std::sqrt(k);
+			T cos2 = Sqrt(k);
 			result = eta * I_unit + (eta * cosi - cos2) * N_unit;
 		}
 
@@ -276,6 +448,15 @@ namespace math
 	template<size_t N, typename T>
 	constexpr Vec<N, T> Lerp(const Vec<N, T>& a, const Vec<N, T>& b, T t)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				simd::Pack<T, 4> pa = a.ToPack();
+				return Vec<N, T>::FromPack(MulAdd(b.ToPack() - pa, simd::Pack<T, 4>::Broadcast(t), pa));
+			}
+		}
+
 		return a + (b - a) * t;
 	}
 
@@ -291,7 +472,7 @@ namespace math
 	}
 
 	template<size_t N, typename T>
-	T Angle(const Vec<N, T>& a, const Vec<N, T>& b)
+	constexpr T Angle(const Vec<N, T>& a, const Vec<N, T>& b)
 	{
 		T lenA = a.Length();
 		T lenB = b.Length();
@@ -301,12 +482,21 @@ namespace math
 		T cosAngle = Dot(a, b) / (lenA * lenB);
 		cosAngle = Clamp(cosAngle, T(-1), T(1)); 
 
-		return std::acos(cosAngle); 
+		return Acos(cosAngle); 
 	}
 
 	template<size_t N, typename T>
 	constexpr T DistanceSquared(const Vec<N, T>& a, const Vec<N, T>& b)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				simd::Pack<T, 4> diff = b.ToPack() - a.ToPack();
+				return simd::Dot<N>(diff, diff);
+			}
+		}
+
 		T sum = 0;
 		for (size_t i = 0; i < N; ++i)
 		{
@@ -319,6 +509,14 @@ namespace math
 	template<size_t N, typename T>
 	constexpr Vec<N, T> Min(const Vec<N, T>& a, const Vec<N, T>& b)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				return Vec<N, T>::FromPack(Min(a.ToPack(), b.ToPack()));
+			}
+		}
+
 		Vec<N, T> result;
 		for (size_t i = 0; i < N; ++i)
 			result[i] = Min(a[i], b[i]);
@@ -328,6 +526,14 @@ namespace math
 	template<size_t N, typename T>
 	constexpr Vec<N, T> Max(const Vec<N, T>& a, const Vec<N, T>& b)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				return Vec<N, T>::FromPack(Max(a.ToPack(), b.ToPack()));
+			}
+		}
+
 		Vec<N, T> result;
 		for (size_t i = 0; i < N; ++i)
 		{
@@ -339,6 +545,14 @@ namespace math
 	template<size_t N, typename T>
 	constexpr Vec<N, T> Clamp(const Vec<N, T>& v, const Vec<N, T>& min, const Vec<N, T>& max)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				return Vec<N, T>::FromPack(Min(Max(v.ToPack(), min.ToPack()), max.ToPack()));
+			}
+		}
+
 		Vec<N, T> result;
 		for (size_t i = 0; i < N; ++i)
 		{
@@ -350,6 +564,14 @@ namespace math
 	template<size_t N, typename T>
 	constexpr Vec<N, T> Abs(const Vec<N, T>& v)
 	{
+		if constexpr (simd::IsPackable<N, T>)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				return Vec<N, T>::FromPack(Abs(v.ToPack()));
+			}
+		}
+
 		Vec<N, T> result;
 		for (size_t i = 0; i < N; ++i)
 		{
@@ -358,12 +580,12 @@ namespace math
 		return result;
 	}
 
-	inline Vec3 Vec3Right()	{ return Vec3(1, 0, 0);	}
-	inline Vec3 Vec3Left()	{ return Vec3(-1, 0, 0);}
-	inline Vec3 Vec3Up()		{ return Vec3(0, 1, 0); }
-	inline Vec3 Vec3Down()	{ return Vec3(0, -1, 0);}
-	inline Vec3 Vec3Forward() { return Vec3(0, 0, 1); }
-	inline Vec3 Vec3Back()	{ return Vec3(0, 0, -1);}
+	constexpr Vec3 Vec3Right()	{ return Vec3(1, 0, 0);	}
+	constexpr Vec3 Vec3Left()	{ return Vec3(-1, 0, 0);}
+	constexpr Vec3 Vec3Up()		{ return Vec3(0, 1, 0); }
+	constexpr Vec3 Vec3Down()	{ return Vec3(0, -1, 0);}
+	constexpr Vec3 Vec3Forward() { return Vec3(0, 0, 1); }
+	constexpr Vec3 Vec3Back()	{ return Vec3(0, 0, -1);}
 }
 
 #endif //MATH_VECTOR_HPP
\ No newline at end of file
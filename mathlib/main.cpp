@@ -1,9 +1,99 @@
 #include <iostream>
 #include <math/math.hpp>
+#include <math/expression.hpp>
 
 using namespace math;
 
+// CONSTANT EVALUATION
+// Everything below is computed by the compiler; a failing line does not build.
+
+static_assert(Sqrt(4.0f) == 2.0f && Sqrt(2.0) == 1.4142135623730951);
+static_assert(NearlyEquals(Sin(PI_f32 / 6.0f), 0.5f, 1e-7f) && NearlyEquals(Cos(PI_f64 / 3.0), 0.5, 1e-15));
+static_assert(NearlyEquals(Tan(PI_f64 / 4.0), 1.0, 1e-15) && NearlyEquals(Atan2(1.0, -1.0), 0.75 * PI_f64, 1e-15));
+static_assert(NearlyEquals(Asin(1.0), PI_f64 / 2.0, 1e-15) && NearlyEquals(Acos(-1.0f), PI_f32, 1e-6f));
+static_assert(NearlyEquals(fast::Sin(PI_f32 / 6.0f), 0.5f, 1e-7f) && NearlyEquals(fast::Cos(PI_f32 / 3.0f, TrigPrecision::Fast), 0.5f, 1e-5f));
+static_assert(NearlyEquals(fast::Atan2(1.0f, -1.0f), 0.75f * PI_f32, 1e-6f) && NearlyEquals(fast::Acos(-1.0f), PI_f32, 1e-6f));
+
+static_assert(Vec3(1, 2, 3) + Vec3(4, 5, 6) == Vec3(5, 7, 9));
+static_assert(Dot(Vec3(1, 2, 3), Vec3(4, 5, 6)) == 32.0f);
+static_assert(Cross(Vec3Right(), Vec3Up()) == Vec3Forward());
+static_assert(Vec3(3, 0, 4).Length() == 5.0f && Vec3(0, 3, 4).Normalize() == Vec3(0, 0.6f, 0.8f));
+static_assert(Vec4(1, 2, 3, 4).LengthSquared() == 30.0f && Distance(Vec2(0, 0), Vec2(3, 4)) == 5.0f);
+static_assert(Lerp(Vec3(0, 0, 0), Vec3(2, 4, 8), 0.5f) == Vec3(1, 2, 4));
+static_assert(Reflect(Vec3(1, -1, 0), Vec3(0, 1, 0)) == Vec3(1, 1, 0));
+
+constexpr Mat4 ROTATION = RotateZ(PI_f32 / 2.0f);
+constexpr Mat4 MODEL = Translate(Vec3(1, 2, 3)) * ROTATION * Scale(Vec3(2, 2, 2));
+
+static_assert((MODEL * Vec4(1, 0, 0, 1)).NearlyEquals(Vec4(1, 4, 3, 1)));
+static_assert(NearlyEquals(Determinant(MODEL), 8.0f, 1e-5f));
+static_assert((Inverse(MODEL) * MODEL).GetColumn(2).NearlyEquals(Vec4(0, 0, 1, 0)));
+static_assert((InverseAffine(MODEL) * Vec4(1, 4, 3, 1)).NearlyEquals(Vec4(1, 0, 0, 1)));
+static_assert(Transpose(ROTATION)(0, 1) == ROTATION(1, 0));
+static_assert(NearlyEquals(Perspective(PI_f32 / 2.0f, 1.0f, 0.1f, 100.0f)(1, 1), 1.0f, 1e-6f));
+
+static_assert(Vec3(2.0f * Lazy(Vec3(1, 2, 3)) + Vec3(1, 1, 1) * Lazy(Vec3(2, 4, 8))) == Vec3(4, 8, 14));
+static_assert((Lazy(Translate(Vec3(1, 2, 3))) * ROTATION * Scale(Vec3(2, 2, 2)) * Vec4(1, 0, 0, 1)).NearlyEquals(MODEL * Vec4(1, 0, 0, 1)));
+
+constexpr Quaternion QUARTER_TURN = Quaternion::FromAxisAngle(Vec3(0, 0, 1), PI_f32 / 2.0f);
+
+static_assert((QUARTER_TURN * Vec3(1, 0, 0)).NearlyEquals(Vec3(0, 1, 0)));
+static_assert((QUARTER_TURN.ToMatrix4() * Vec4(1, 0, 0, 0)).NearlyEquals(ROTATION * Vec4(1, 0, 0, 0)));
+static_assert(Quaternion::FromRotationMatrix(ROTATION).NearlyEquals(QUARTER_TURN));
+static_assert(Slerp(Quaternion(), QUARTER_TURN, 0.5f).NearlyEquals(Quaternion::FromAxisAngle(Vec3(0, 0, 1), PI_f32 / 4.0f)));
+static_assert(NearlyEquals(QUARTER_TURN.ToEuler()[2], PI_f32 / 2.0f, 1e-5f));
+static_assert(Quaternion::FromEuler(0.3f, -0.2f, 0.9f, TrigPrecision::Accurate).NearlyEquals(Quaternion::FromEuler(0.3f, -0.2f, 0.9f)));
+static_assert(NearlyEquals(AngleBetween(Quaternion(), QUARTER_TURN), PI_f32 / 2.0f, 1e-5f));
+
+constexpr Transform TRS(Vec3(1, 2, 3), QUARTER_TURN, Vec3(2, 2, 2));
+
+static_assert((TRS.ToMatrix4() * Vec4(1, 1, 1, 1)).NearlyEquals(Translate(Vec3(1, 2, 3)) * QUARTER_TURN.ToMatrix4() * Scale(Vec3(2, 2, 2)) * Vec4(1, 1, 1, 1)));
+static_assert(TRS.TransformPoint(Vec3(1, 0, 0)).NearlyEquals(Vec3(1, 4, 3)));
+static_assert((TRS * TRS.Inverse()).NearlyEquals(Transform(), 1e-5f));
+static_assert(Transform::FromMatrix(TRS.ToMatrix4()).NearlyEquals(TRS, 1e-5f));
+static_assert(TransformMatrix(Vec3(1, 2, 3), Vec3(0.3f, -0.2f, 0.9f), Vec3(1, 2, 3)).GetColumn(1).NearlyEquals((Rotate(0.3f, -0.2f, 0.9f) * Scale(Vec3(1, 2, 3))).GetColumn(1)));
+
+constexpr DualQuaternion RIGID = DualQuaternion::FromRotationTranslation(QUARTER_TURN, Vec3(1, 2, 3));
+
+static_assert(RIGID.TransformPoint(Vec3(1, 0, 0)).NearlyEquals(Vec3(1, 3, 3)));
+static_assert(RIGID.GetTranslation().NearlyEquals(Vec3(1, 2, 3)));
+static_assert((RIGID * RIGID.Conjugate()).NearlyEquals(DualQuaternion()));
+static_assert((RIGID * RIGID).TransformPoint(Vec3(1, 0, 0)).NearlyEquals(RIGID.TransformPoint(RIGID.TransformPoint(Vec3(1, 0, 0))), 1e-5f));
+static_assert(DualQuaternion::FromMatrix(RIGID.ToMatrix4()).NearlyEquals(RIGID));
+static_assert(Sclerp(DualQuaternion(), DualQuaternion::FromTranslation(Vec3(2, 0, 0)), 0.5f).GetTranslation().NearlyEquals(Vec3(1, 0, 0)));
+static_assert(Sclerp(DualQuaternion(), RIGID, 1.0f).NearlyEquals(RIGID, 1e-5f));
+static_assert(Dlb(DualQuaternion(), RIGID, 1.0f).NearlyEquals(RIGID));
+
+constexpr Frustum VIEW = Frustum::FromViewProj(Perspective(PI_f32 / 2.0f, 1.0f, 0.1f, 100.0f) * LookAt(Vec3(0, 0, 5), Vec3(0, 0, 0), Vec3Up()));
+
+static_assert(VIEW.Contains(Vec3(0, 0, 0)) && !VIEW.Contains(Vec3(0, 0, 6)) && !VIEW.Contains(Vec3(10, 0, 0)));
+static_assert(VIEW.Intersects(Sphere(Vec3(10, 0, 0), 6.0f)) && !VIEW.Intersects(Sphere(Vec3(0, 0, -200), 1.0f)));
+static_assert(VIEW.Intersects(AABB(Vec3(-1, -1, 4), Vec3(1, 1, 6))) && !VIEW.Intersects(AABB(Vec3(-1, -1, 6), Vec3(1, 1, 7))));
+static_assert(NearlyEquals(Plane::FromPoints(Vec3(0, 1, 0), Vec3(0, 1, 1), Vec3(1, 1, 0)).SignedDistance(Vec3(0, 3, 0)), 2.0f, 1e-6f));
+static_assert(Overlaps(AABB(Vec3(0, 0, 0), Vec3(1, 1, 1)), Sphere(Vec3(2, 0.5f, 0.5f), 1.0f)) && !Overlaps(AABB(Vec3(0, 0, 0), Vec3(1, 1, 1)), AABB(Vec3(2, 0, 0), Vec3(3, 1, 1))));
+
+template<typename Primitive>
+constexpr float32 HitDistance(const Ray& ray, const Primitive& primitive)
+{
+	float32 t = -1.0f;
+	if constexpr (std::is_same_v<Primitive, Plane>) RayPlane(ray, primitive, t);
+	else if constexpr (std::is_same_v<Primitive, Sphere>) RaySphere(ray, primitive, t);
+	else if constexpr (std::is_same_v<Primitive, AABB>) RayAABB(ray, primitive, t);
+	else RayTriangle(ray, primitive, t);
+	return t;
+}
+
+constexpr Ray DOWN(Vec3(0.5f, 5, 0.25f), Vec3(0, -1, 0));
+
+static_assert(HitDistance(DOWN, Plane(Vec3Up(), -1.0f)) == 4.0f && HitDistance(Ray(DOWN.origin, Vec3(1, 0, 0)), Plane(Vec3Up(), -1.0f)) == -1.0f);
+static_assert(NearlyEquals(HitDistance(DOWN, Sphere(Vec3(0.5f, 0, 0.25f), 2.0f)), 3.0f, 1e-6f) && HitDistance(DOWN, Sphere(Vec3(0, 10, 0), 1.0f)) == -1.0f);
+static_assert(HitDistance(DOWN, AABB(Vec3(0, 0, 0), Vec3(1, 1, 1))) == 4.0f && HitDistance(DOWN, AABB(Vec3(2, 0, 0), Vec3(3, 1, 1))) == -1.0f);
+static_assert(HitDistance(Ray(Vec3(0.5f, 0.5f, 0.5f), Vec3(1, 0, 0)), AABB(Vec3(0, 0, 0), Vec3(1, 1, 1))) == 0.0f);
+static_assert(HitDistance(DOWN, Triangle(Vec3(0, 1, 0), Vec3(0, 1, 1), Vec3(1, 1, 0))) == 4.0f && HitDistance(DOWN, Triangle(Vec3(1, 1, 0), Vec3(1, 1, 1), Vec3(2, 1, 0))) == -1.0f);
+static_assert(Bounds(Triangle(Vec3(0, 1, 0), Vec3(2, -1, 0), Vec3(1, 1, 3))).max == Vec3(2, 1, 3) && Bounds(Sphere(Vec3(1, 1, 1), 2.0f)).min == Vec3(-1, -1, -1));
+static_assert(MatrixView(MODEL).Block(0, 3, 3, 1)(1, 0) == 2.0f && MatrixView(MODEL).Block(1, 1, 2, 2).Stride() == 4);
+
 int main()
 {
 	return 0;
-}
\ No newline at end of file
+}
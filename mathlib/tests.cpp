@@ -0,0 +1,1550 @@
+#include <cstdio>
+#include <map>
+#include <random>
+#include <math/math.hpp>
+
+using namespace math;
+
+// RUN-TIME CHECKS
+// Error bounds of the approximate and batched paths, measured against float64 references
+// or the scalar functions. Each check prints the largest error it saw; the exit code is
+// the number of failed checks. ctest runs it once per MATHLIB_ISA level.
+
+static int failures = 0;
+
+static void Check(const char* name, float64 error, float64 bound)
+{
+	const bool passed = error <= bound;
+	std::printf("%-40s max error %.3g (bound %.3g)%s\n", name, error, bound, passed ? "" : "  FAILED");
+	failures += !passed;
+}
+
+static std::array<float32, 4> Components(const Quaternion& q)
+{
+	return { q.x, q.y, q.z, q.w };
+}
+
+template<typename F>
+static float64 MaxComponentError(size_t count, size_t components, F&& error)
+{
+	float64 result = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (size_t c = 0; c < components; ++c)
+		{
+			result = Max(result, float64(error(i, c)));
+		}
+	}
+	return result;
+}
+
+// Components in [-1, 1] scaled by 2^-20 to 2^20.
+template<size_t N>
+static std::vector<Vec<N, float32>> RandomVectors(size_t count, uint32 seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float32> component(-1.0f, 1.0f);
+	std::uniform_int_distribution<int32> exponent(-20, 20);
+
+	std::vector<Vec<N, float32>> result(count);
+	for (Vec<N, float32>& v : result)
+	{
+		do
+		{
+			for (size_t c = 0; c < N; ++c)
+			{
+				v[c] = component(rng);
+			}
+		} while (v.LengthSquared() < 1e-4f);
+		v = v * std::ldexp(1.0f, exponent(rng));
+	}
+	return result;
+}
+
+// SQRT PRECISION
+// Relative error of InvLength and component error of NormalizeFast at each tier.
+
+constexpr SqrtPrecision PRECISIONS[] = { SqrtPrecision::Fast, SqrtPrecision::Accurate, SqrtPrecision::Exact };
+constexpr const char* PRECISION_NAMES[] = { "Fast", "Accurate", "Exact" };
+
+// rsqrtps is within 1.5 * 2^-12, one Newton-Raphson step squares that, Exact is within two roundings.
+constexpr float64 PRECISION_BOUNDS[] = { 3.7e-4, 4e-7, 2.4e-7 };
+
+template<size_t N, typename V, typename F>
+static void CheckNormalize(const char* type, const std::vector<V>& values, F&& components)
+{
+	for (size_t p = 0; p < std::size(PRECISIONS); ++p)
+	{
+		float64 invLengthError = 0.0, normalizeError = 0.0;
+		for (const V& v : values)
+		{
+			const std::array<float32, N> x = components(v);
+			const std::array<float32, N> n = components(v.NormalizeFast(PRECISIONS[p]));
+
+			float64 lengthSquared = 0.0;
+			for (size_t c = 0; c < N; ++c)
+			{
+				lengthSquared += float64(x[c]) * float64(x[c]);
+			}
+			const float64 invLength = 1.0 / std::sqrt(lengthSquared);
+
+			invLengthError = Max(invLengthError, std::abs(v.InvLength(PRECISIONS[p]) / invLength - 1.0));
+			for (size_t c = 0; c < N; ++c)
+			{
+				normalizeError = Max(normalizeError, std::abs(n[c] - x[c] * invLength));
+			}
+		}
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "%s::InvLength(%s)", type, PRECISION_NAMES[p]);
+		Check(name, invLengthError, PRECISION_BOUNDS[p]);
+		std::snprintf(name, sizeof(name), "%s::NormalizeFast(%s)", type, PRECISION_NAMES[p]);
+		Check(name, normalizeError, PRECISION_BOUNDS[p]);
+	}
+}
+
+static void CheckSqrtPrecision()
+{
+	constexpr size_t COUNT = 1 << 18;
+
+	CheckNormalize<3>("Vec3", RandomVectors<3>(COUNT, 1), [](const Vec3& v) { return std::array<float32, 3>{ v[0], v[1], v[2] }; });
+	CheckNormalize<4>("Vec4", RandomVectors<4>(COUNT, 2), [](const Vec4& v) { return std::array<float32, 4>{ v[0], v[1], v[2], v[3] }; });
+
+	std::vector<Quaternion> quaternions;
+	for (const Vec4& v : RandomVectors<4>(COUNT, 3))
+	{
+		quaternions.emplace_back(v[0], v[1], v[2], v[3]);
+	}
+	CheckNormalize<4>("Quaternion", quaternions, Components);
+}
+
+// FAST TRIGONOMETRY
+// Span math::fast functions against float64 std:: functions over |x| < 100, in the units
+// of the fast.hpp table: ulps for Accurate; relative error for Fast SinCos and Atan2,
+// absolute for Fast Acos.
+
+// Distance from reference in units of the float32 spacing at reference.
+static float64 Ulps(float32 value, float64 reference)
+{
+	const float32 rounded = Absolute(static_cast<float32>(reference));
+	return std::abs(value - reference) / (std::nextafter(rounded, std::numeric_limits<float32>::infinity()) - rounded);
+}
+
+static void CheckFastTrigonometry()
+{
+	constexpr size_t COUNT = 100003;
+
+	std::mt19937 rng(8);
+	std::uniform_real_distribution<float32> wide(-100.0f, 100.0f), unit(-1.0f, 1.0f);
+	std::vector<float32> x(COUNT), y(COUNT), cosines(COUNT), sines(COUNT), out(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		x[i] = wide(rng);
+		y[i] = wide(rng);
+		cosines[i] = unit(rng);
+	}
+
+	for (TrigPrecision precision : { TrigPrecision::Accurate, TrigPrecision::Fast })
+	{
+		const bool accurate = precision == TrigPrecision::Accurate;
+		auto error = [&](float32 value, float64 reference, bool relative)
+		{
+			return accurate ? Ulps(value, reference) : std::abs(value - reference) / (relative ? std::abs(reference) : 1.0);
+		};
+
+		std::vector<float32> s(COUNT), c(COUNT);
+		fast::SinCos(x, s, c, precision);
+		Check(accurate ? "fast::SinCos(Accurate) ulp" : "fast::SinCos(Fast) relative", MaxComponentError(COUNT, 2, [&](size_t i, size_t k)
+		{
+			return k == 0 ? error(s[i], std::sin(float64(x[i])), true) : error(c[i], std::cos(float64(x[i])), true);
+		}), accurate ? 2.5 : 2e-6);
+
+		fast::Acos(cosines, out, precision);
+		Check(accurate ? "fast::Acos(Accurate) ulp" : "fast::Acos(Fast) absolute", MaxComponentError(COUNT, 1, [&](size_t i, size_t)
+		{
+			return error(out[i], std::acos(float64(cosines[i])), false);
+		}), accurate ? 1.5 : 4e-5);
+
+		fast::Atan2(y, x, out, precision);
+		Check(accurate ? "fast::Atan2(Accurate) ulp" : "fast::Atan2(Fast) relative", MaxComponentError(COUNT, 1, [&](size_t i, size_t)
+		{
+			return error(out[i], std::atan2(float64(y[i]), float64(x[i])), true);
+		}), accurate ? 3.5 : 3.1e-5);
+	}
+}
+
+// POSE BLENDING
+// BlendPoses polynomial tiers against a float64 slerp along the shorter arc, per
+// component, over AoS spans and SoA streams. Every seventh pair is nearly identical.
+
+static std::array<float64, 4> SlerpReference(const Quaternion& a, const Quaternion& b, float64 t)
+{
+	const std::array<float32, 4> qa = Components(a), qb = Components(b);
+	float64 dot = 0.0;
+	for (size_t c = 0; c < 4; ++c)
+	{
+		dot += float64(qa[c]) * float64(qb[c]);
+	}
+	const float64 sign = dot < 0.0 ? -1.0 : 1.0;
+	const float64 theta = std::acos(Min(std::abs(dot), 1.0));
+
+	float64 w0 = 1.0 - t, w1 = t;
+	if (theta > 1e-9)
+	{
+		w0 = std::sin((1.0 - t) * theta) / std::sin(theta);
+		w1 = std::sin(t * theta) / std::sin(theta);
+	}
+
+	std::array<float64, 4> result;
+	for (size_t c = 0; c < 4; ++c)
+	{
+		result[c] = qa[c] * w0 + sign * qb[c] * w1;
+	}
+	return result;
+}
+
+static std::vector<Quaternion> RandomRotations(size_t count, uint32 seed)
+{
+	std::mt19937 rng(seed);
+	std::normal_distribution<float32> normal;
+
+	std::vector<Quaternion> result(count);
+	for (Quaternion& q : result)
+	{
+		q = Quaternion(normal(rng), normal(rng), normal(rng), normal(rng)).Normalize();
+	}
+	return result;
+}
+
+static void CheckPoseBlending()
+{
+	constexpr size_t COUNT = 10007;
+
+	const std::vector<Quaternion> a = RandomRotations(COUNT, 5);
+	std::vector<Quaternion> b = RandomRotations(COUNT, 6);
+	std::vector<float32> t(COUNT);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float32> unit(0.0f, 1.0f);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		t[i] = unit(rng);
+		if (i % 7 == 0)
+		{
+			b[i] = Quaternion(a[i].x + 1e-4f, a[i].y, a[i].z, a[i].w).Normalize();
+		}
+	}
+
+	constexpr SlerpPrecision SLERP_PRECISIONS[] = { SlerpPrecision::Accurate, SlerpPrecision::Fast };
+	constexpr const char* SLERP_NAMES[] = { "Accurate", "Fast" };
+	constexpr float64 SLERP_BOUNDS[] = { 2e-7, 3e-5 };
+
+	const QuaternionStream streamA{ std::span<const Quaternion>(a) }, streamB{ std::span<const Quaternion>(b) };
+	for (size_t p = 0; p < std::size(SLERP_PRECISIONS); ++p)
+	{
+		std::vector<Quaternion> blended(COUNT);
+		BlendPoses(a, b, t, blended, SLERP_PRECISIONS[p]);
+		QuaternionStream streamBlended;
+		BlendPoses(streamA, streamB, t, streamBlended, SLERP_PRECISIONS[p]);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "BlendPoses(%s)", SLERP_NAMES[p]);
+		Check(name, MaxComponentError(COUNT, 4, [&](size_t i, size_t c)
+		{
+			return std::abs(Components(blended[i])[c] - SlerpReference(a[i], b[i], t[i])[c]);
+		}), SLERP_BOUNDS[p]);
+		std::snprintf(name, sizeof(name), "BlendPoses(%s) stream", SLERP_NAMES[p]);
+		Check(name, MaxComponentError(COUNT, 4, [&](size_t i, size_t c)
+		{
+			return std::abs(streamBlended.components[c][i] - SlerpReference(a[i], b[i], t[i])[c]);
+		}), SLERP_BOUNDS[p]);
+	}
+}
+
+// SKINNING
+// SkinLinear and SkinDualQuaternion on a vertex count that is neither a multiple of the
+// pack width nor of SKIN_GRAIN, against per-vertex loops: the weighted sum of the bone
+// matrices, and Dlb() of the bone dual quaternions. Rigid bones, so every palette type
+// gives the same transforms; normals must come out unit length. Outputs aliasing the
+// inputs must give the same result.
+
+static float64 MaxVec3Error(const Vec3Stream& stream, const std::vector<Vec3>& expected)
+{
+	return MaxComponentError(expected.size(), 3, [&](size_t i, size_t c) { return std::abs(stream.components[c][i] - expected[i][c]); });
+}
+
+static float64 MaxStreamDifference(const Vec3Stream& a, const Vec3Stream& b)
+{
+	return MaxComponentError(a.Size(), 3, [&](size_t i, size_t c) { return std::abs(a.components[c][i] - b.components[c][i]); });
+}
+
+static void CheckSkinning()
+{
+	constexpr size_t COUNT = 2 * SKIN_GRAIN + 37;
+	constexpr size_t BONES = 32;
+	constexpr size_t INFLUENCES = 4;
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), positive(0.0f, 1.0f);
+
+	const std::vector<Quaternion> boneRotations = RandomRotations(BONES, 12);
+	std::vector<Mat4> matrices(BONES);
+	std::vector<Mat3x4> affine(BONES);
+	std::vector<DualQuaternion> dualQuaternions(BONES);
+	for (size_t b = 0; b < BONES; ++b)
+	{
+		const Vec3 translation(2.0f * unit(rng), 2.0f * unit(rng), 2.0f * unit(rng));
+		matrices[b] = Translate(translation) * boneRotations[b].ToMatrix4();
+		for (size_t row = 0; row < 3; ++row)
+		{
+			for (size_t col = 0; col < 4; ++col)
+			{
+				affine[b](row, col) = matrices[b](row, col);
+			}
+		}
+		dualQuaternions[b] = DualQuaternion::FromRotationTranslation(boneRotations[b], translation);
+	}
+
+	// Weights sum to 1, every fourth vertex leaves its last slot unused.
+	std::vector<uint32> bones(COUNT * INFLUENCES);
+	std::vector<float32> weights(COUNT * INFLUENCES);
+	std::vector<Vec3> positions(COUNT), normals(COUNT);
+	for (size_t v = 0; v < COUNT; ++v)
+	{
+		float32 sum = 0.0f;
+		for (size_t k = 0; k < INFLUENCES; ++k)
+		{
+			bones[v * INFLUENCES + k] = rng() % BONES;
+			weights[v * INFLUENCES + k] = (v % 4 == 0 && k == INFLUENCES - 1) ? 0.0f : 0.05f + positive(rng);
+			sum += weights[v * INFLUENCES + k];
+		}
+		for (size_t k = 0; k < INFLUENCES; ++k)
+		{
+			weights[v * INFLUENCES + k] /= sum;
+		}
+		positions[v] = Vec3(unit(rng), unit(rng), unit(rng));
+		normals[v] = Vec3(unit(rng), unit(rng), unit(rng)).NormalizeSafe(Vec3(0, 1, 0));
+	}
+	const SkinInfluences influences{ bones, weights, INFLUENCES };
+	const Vec3Stream positionStream{ std::span<const Vec3>(positions) }, normalStream{ std::span<const Vec3>(normals) };
+
+	std::vector<Vec3> linearPositions(COUNT), linearNormals(COUNT), dualPositions(COUNT), dualNormals(COUNT);
+	for (size_t v = 0; v < COUNT; ++v)
+	{
+		Mat4 blend;
+		std::array<DualQuaternion, INFLUENCES> transforms;
+		for (size_t e = 0; e < 16; ++e)
+		{
+			blend.Data()[e] = 0.0f;
+		}
+		for (size_t k = 0; k < INFLUENCES; ++k)
+		{
+			const uint32 b = bones[v * INFLUENCES + k];
+			for (size_t e = 0; e < 16; ++e)
+			{
+				blend.Data()[e] += weights[v * INFLUENCES + k] * matrices[b].Data()[e];
+			}
+			transforms[k] = dualQuaternions[b];
+		}
+
+		const Vec4 p = blend * Vec4(positions[v][0], positions[v][1], positions[v][2], 1.0f);
+		const Vec4 n = blend * Vec4(normals[v][0], normals[v][1], normals[v][2], 0.0f);
+		linearPositions[v] = Vec3(p[0], p[1], p[2]);
+		linearNormals[v] = Vec3(n[0], n[1], n[2]).Normalize();
+
+		const DualQuaternion dual = Dlb(transforms, std::span<const float32>(weights.data() + v * INFLUENCES, INFLUENCES));
+		dualPositions[v] = dual.TransformPoint(positions[v]);
+		dualNormals[v] = dual.real * normals[v];
+	}
+
+	Vec3Stream outPositions, outNormals;
+	SkinLinear(std::span<const Mat4>(matrices), influences, positionStream, normalStream, outPositions, outNormals);
+	Check("SkinLinear Mat4 positions", MaxVec3Error(outPositions, linearPositions), 1e-5);
+	Check("SkinLinear Mat4 normals", MaxVec3Error(outNormals, linearNormals), 1e-5);
+
+	SkinLinear(std::span<const Mat3x4>(affine), influences, positionStream, normalStream, outPositions, outNormals);
+	Check("SkinLinear Mat3x4 positions", MaxVec3Error(outPositions, linearPositions), 1e-5);
+	Check("SkinLinear Mat3x4 normals", MaxVec3Error(outNormals, linearNormals), 1e-5);
+
+	Vec3Stream aliasPositions = positionStream, aliasNormals = normalStream;
+	SkinLinear(std::span<const Mat3x4>(affine), influences, aliasPositions, aliasNormals, aliasPositions, aliasNormals);
+	Check("SkinLinear aliased outputs", Max(MaxStreamDifference(aliasPositions, outPositions), MaxStreamDifference(aliasNormals, outNormals)), 0.0);
+
+	auto checkDual = [&](const char* name, auto&& skin)
+	{
+		skin(positionStream, normalStream, outPositions, outNormals);
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "SkinDualQuaternion %s positions", name);
+		Check(label, MaxVec3Error(outPositions, dualPositions), 1e-5);
+		std::snprintf(label, sizeof(label), "SkinDualQuaternion %s normals", name);
+		Check(label, MaxVec3Error(outNormals, dualNormals), 1e-5);
+		std::snprintf(label, sizeof(label), "SkinDualQuaternion %s unit normals", name);
+		Check(label, MaxComponentError(COUNT, 1, [&](size_t i, size_t)
+		{
+			return std::abs(outNormals.Get(i).Length() - 1.0f);
+		}), 1e-6);
+
+		Vec3Stream aliasPositions = positionStream, aliasNormals = normalStream;
+		skin(aliasPositions, aliasNormals, aliasPositions, aliasNormals);
+		std::snprintf(label, sizeof(label), "SkinDualQuaternion %s aliased outputs", name);
+		Check(label, Max(MaxStreamDifference(aliasPositions, outPositions), MaxStreamDifference(aliasNormals, outNormals)), 0.0);
+	};
+
+	checkDual("DualQuaternion", [&](const Vec3Stream& p, const Vec3Stream& n, Vec3Stream& op, Vec3Stream& on)
+	{
+		SkinDualQuaternion(std::span<const DualQuaternion>(dualQuaternions), influences, p, n, op, on);
+	});
+	checkDual("Mat4", [&](const Vec3Stream& p, const Vec3Stream& n, Vec3Stream& op, Vec3Stream& on)
+	{
+		SkinDualQuaternion(std::span<const Mat4>(matrices), influences, p, n, op, on);
+	});
+	checkDual("Mat3x4", [&](const Vec3Stream& p, const Vec3Stream& n, Vec3Stream& op, Vec3Stream& on)
+	{
+		SkinDualQuaternion(std::span<const Mat3x4>(affine), influences, p, n, op, on);
+	});
+
+	SkinLinear(std::span<const Mat4>(matrices), influences, positionStream, normalStream, outPositions, outNormals);
+	Check("SkinLinear unit normals", MaxComponentError(COUNT, 1, [&](size_t i, size_t)
+	{
+		return std::abs(outNormals.Get(i).Length() - 1.0f);
+	}), 1e-6);
+}
+
+// DUAL QUATERNIONS
+// DualQuaternionStream kernels against the scalar members on a count that is not a
+// multiple of the pack width, then Sclerp halfway composed twice against the end point
+// and FromMatrix(ToMatrix4()) round trips. Transforms are compared as Mat4 elements, so
+// the sign of the dual quaternion does not matter.
+
+static std::array<float32, 8> Components(const DualQuaternion& dq)
+{
+	return { dq.real.x, dq.real.y, dq.real.z, dq.real.w, dq.dual.x, dq.dual.y, dq.dual.z, dq.dual.w };
+}
+
+static float64 MaxMatrixError(const Mat4& a, const Mat4& b)
+{
+	return MaxComponentError(16, 1, [&](size_t e, size_t) { return std::abs(a.Data()[e] - b.Data()[e]); });
+}
+
+static void CheckDualQuaternions()
+{
+	constexpr size_t COUNT = 1003;
+
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), scale(0.5f, 2.0f);
+
+	const std::vector<Quaternion> rotationsA = RandomRotations(COUNT, 14), rotationsB = RandomRotations(COUNT, 15);
+	std::vector<DualQuaternion> a(COUNT), b(COUNT), unnormalized(COUNT);
+	std::vector<Vec3> points(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		a[i] = DualQuaternion::FromRotationTranslation(rotationsA[i], Vec3(4.0f * unit(rng), 4.0f * unit(rng), 4.0f * unit(rng)));
+		b[i] = DualQuaternion::FromRotationTranslation(rotationsB[i], Vec3(4.0f * unit(rng), 4.0f * unit(rng), 4.0f * unit(rng)));
+		unnormalized[i] = DualQuaternion(a[i].real * scale(rng), a[i].dual + Quaternion(unit(rng), unit(rng), unit(rng), unit(rng)) * 0.1f);
+		points[i] = Vec3(4.0f * unit(rng), 4.0f * unit(rng), 4.0f * unit(rng));
+	}
+
+	const DualQuaternionStream streamA(a), streamB(b), streamUnnormalized(unnormalized);
+	DualQuaternionStream product, normalized;
+	Multiply(streamA, streamB, product);
+	Check("DualQuaternionStream Multiply", MaxComponentError(COUNT, 8, [&](size_t i, size_t c)
+	{
+		return std::abs(Components(product.Get(i))[c] - Components(a[i] * b[i])[c]);
+	}), 1e-5);
+
+	Normalize(streamUnnormalized, normalized);
+	Check("DualQuaternionStream Normalize", MaxComponentError(COUNT, 8, [&](size_t i, size_t c)
+	{
+		return std::abs(Components(normalized.Get(i))[c] - Components(unnormalized[i].Normalize())[c]);
+	}), 1e-6);
+
+	Vec3Stream transformed;
+	TransformPoints(streamA, Vec3Stream(std::span<const Vec3>(points)), transformed);
+	Check("DualQuaternionStream TransformPoints", MaxComponentError(COUNT, 3, [&](size_t i, size_t c)
+	{
+		return std::abs(transformed.components[c][i] - a[i].TransformPoint(points[i])[c]);
+	}), 1e-5);
+
+	float64 sclerpError = 0.0, roundTripError = 0.0;
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		const DualQuaternion half = Sclerp(a[i], b[i], 0.5f);
+		const DualQuaternion step = a[i].Conjugate() * half;
+		sclerpError = Max(sclerpError, MaxMatrixError((half * step).ToMatrix4(), b[i].ToMatrix4()));
+
+		const Mat4 m = a[i].ToMatrix4();
+		roundTripError = Max(roundTripError, MaxMatrixError(DualQuaternion::FromMatrix(m).ToMatrix4(), m));
+	}
+	Check("Sclerp(a, b, 0.5) twice", sclerpError, 1e-4);
+	Check("FromMatrix(ToMatrix4())", roundTripError, 1e-5);
+}
+
+// FRUSTUM CULLING
+// CullSpheres and CullBoxes, bitmask and index list, against Frustum::Intersects for
+// counts around the 64-bit words. Objects come in clusters of 16 so whole packs get
+// rejected and cached in lastPlane; then every cluster moves, which leaves the cache
+// stale, and a cache of random planes must not change the result either.
+
+template<typename Object, typename Stream, typename Cull, typename Make>
+static void CheckCulling(const char* type, Cull&& cull, Make&& make)
+{
+	const Frustum frustum = Frustum::FromViewProj(Perspective(1.0f, 1.5f, 0.5f, 60.0f) * LookAt(Vec3(0, 0, 0), Vec3(0, 0, -1), Vec3(0, 1, 0)));
+
+	std::mt19937 rng(16);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f);
+
+	size_t maskMismatches = 0, strayBits = 0, indexMismatches = 0, cachedMismatches = 0;
+	for (size_t count : { 1, 63, 64, 65, 10001 })
+	{
+		std::vector<Object> objects(count);
+		std::vector<Vec3> clusters((count + 15) / 16);
+		auto place = [&]()
+		{
+			for (Vec3& cluster : clusters)
+			{
+				cluster = Vec3(80.0f * unit(rng), 80.0f * unit(rng), 80.0f * unit(rng));
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				objects[i] = make(clusters[i / 16] + Vec3(unit(rng), unit(rng), unit(rng)) * 2.0f, 0.2f + Absolute(unit(rng)));
+			}
+		};
+
+		std::vector<uint64> mask((count + 63) / 64);
+		std::vector<uint32> indices(count);
+		std::vector<uint8> lastPlane(count, 0);
+		auto compare = [&](std::span<uint8> cache, size_t& mismatches)
+		{
+			const Stream stream{ std::span<const Object>(objects) };
+			std::fill(mask.begin(), mask.end(), ~uint64(0));
+			cull(frustum, stream, std::span<uint64>(mask), cache);
+
+			std::vector<uint32> expected;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const bool visible = frustum.Intersects(objects[i]);
+				mismatches += ((mask[i / 64] >> (i % 64)) & 1) != visible;
+				if (visible)
+				{
+					expected.push_back(static_cast<uint32>(i));
+				}
+			}
+			if (count % 64 != 0)
+			{
+				strayBits += (mask.back() >> (count % 64)) != 0;
+			}
+
+			const size_t written = cull(frustum, stream, std::span<uint32>(indices), cache);
+			indexMismatches += written != expected.size() || !std::equal(expected.begin(), expected.end(), indices.begin());
+		};
+
+		place();
+		compare({}, maskMismatches);
+		compare(lastPlane, cachedMismatches);
+		compare(lastPlane, cachedMismatches);
+
+		place();
+		compare(lastPlane, cachedMismatches);
+		for (uint8& plane : lastPlane)
+		{
+			plane = static_cast<uint8>(rng() % Frustum::PLANE_COUNT);
+		}
+		compare(lastPlane, cachedMismatches);
+	}
+
+	char label[64];
+	std::snprintf(label, sizeof(label), "%s bitmask mismatches", type);
+	Check(label, float64(maskMismatches), 0.0);
+	std::snprintf(label, sizeof(label), "%s bits set past count", type);
+	Check(label, float64(strayBits), 0.0);
+	std::snprintf(label, sizeof(label), "%s index list mismatches", type);
+	Check(label, float64(indexMismatches), 0.0);
+	std::snprintf(label, sizeof(label), "%s lastPlane cache mismatches", type);
+	Check(label, float64(cachedMismatches), 0.0);
+}
+
+static void CheckFrustumCulling()
+{
+	CheckCulling<Sphere, SphereStream>("CullSpheres", [](auto&&... args) { return CullSpheres(args...); }, [](const Vec3& center, float32 size)
+	{
+		return Sphere(center, size);
+	});
+	CheckCulling<AABB, AABBStream>("CullBoxes", [](auto&&... args) { return CullBoxes(args...); }, [](const Vec3& center, float32 size)
+	{
+		return AABB::FromCenterExtents(center, Vec3(size, 0.5f * size, 2.0f * size));
+	});
+}
+
+// RAY BATCHES
+// The stream overloads of intersection.hpp against the scalar tests, both directions:
+// 301 rays against one primitive, and rays against 301 spheres, boxes and triangles.
+// About half the rays aim at the primitives. Hit bits must match and missed lanes must
+// read infinity; distance error is relative to max(1, distance).
+
+struct RayBatchErrors
+{
+	size_t mismatches = 0;
+	float64 distance = 0.0;
+};
+
+// batch(hits, distances) runs the stream overload, scalar(i, distance) the scalar test.
+template<typename Batch, typename Scalar>
+static void CompareRayBatch(size_t count, RayBatchErrors& errors, Batch&& batch, Scalar&& scalar)
+{
+	std::vector<uint64> hits((count + 63) / 64, ~uint64(0)), hitsOnly((count + 63) / 64, ~uint64(0));
+	std::vector<float32> distances(count);
+	batch(std::span<uint64>(hits), std::span<float32>(distances));
+	batch(std::span<uint64>(hitsOnly), std::span<float32>());
+
+	errors.mismatches += hits != hitsOnly;
+	for (size_t i = 0; i < count; ++i)
+	{
+		float32 distance = INFINITY;
+		const bool hit = scalar(i, distance);
+		if (hit != (((hits[i / 64] >> (i % 64)) & 1) != 0) || (!hit && distances[i] != INFINITY))
+		{
+			++errors.mismatches;
+		}
+		else if (hit)
+		{
+			errors.distance = Max(errors.distance, std::abs(float64(distances[i]) - distance) / Max(1.0, float64(distance)));
+		}
+	}
+	if (count % 64 != 0)
+	{
+		errors.mismatches += (hits.back() >> (count % 64)) != 0;
+	}
+}
+
+static void CheckRayBatch(const char* name, const RayBatchErrors& errors)
+{
+	char label[64];
+	std::snprintf(label, sizeof(label), "%s hit mismatches", name);
+	Check(label, float64(errors.mismatches), 0.0);
+	std::snprintf(label, sizeof(label), "%s distances", name);
+	Check(label, errors.distance, 1e-4);
+}
+
+static void CheckRayBatches()
+{
+	constexpr size_t COUNT = 301;
+	constexpr size_t SINGLE_RAYS = 16;
+
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), positive(0.2f, 1.5f);
+	auto randomVector = [&](float32 scale) { return Vec3(unit(rng), unit(rng), unit(rng)) * scale; };
+
+	const Plane plane = Plane::FromPointNormal(randomVector(1.0f), randomVector(1.0f).NormalizeSafe(Vec3(0, 1, 0)));
+	const Sphere sphere(randomVector(1.0f), 2.0f);
+	const AABB box = AABB::FromCenterExtents(randomVector(1.0f), Vec3(1.5f, 1.0f, 2.0f));
+	const Triangle triangle(Vec3(-4, -3, 0) + randomVector(1.0f), Vec3(4, -3, 1) + randomVector(1.0f), Vec3(0, 4, -1) + randomVector(1.0f));
+
+	// Rays from a shell around the origin, every other one aimed near it.
+	auto randomRay = [&](size_t i)
+	{
+		const Vec3 origin = randomVector(8.0f);
+		const Vec3 target = i % 2 == 0 ? randomVector(2.0f) : randomVector(8.0f);
+		return Ray(origin, (target - origin) * positive(rng));
+	};
+
+	std::vector<Ray> rays(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		rays[i] = randomRay(i);
+	}
+	const RayStream rayStream{ std::span<const Ray>(rays) };
+
+	RayBatchErrors planeErrors, sphereErrors, boxErrors, triangleErrors;
+	CompareRayBatch(COUNT, planeErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RayPlane(rayStream, plane, hits, distances); },
+		[&](size_t i, float32& distance) { return RayPlane(rays[i], plane, distance); });
+	CompareRayBatch(COUNT, sphereErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RaySphere(rayStream, sphere, hits, distances); },
+		[&](size_t i, float32& distance) { return RaySphere(rays[i], sphere, distance); });
+	CompareRayBatch(COUNT, boxErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RayAABB(rayStream, box, hits, distances); },
+		[&](size_t i, float32& distance) { return RayAABB(rays[i], box, distance); });
+	CompareRayBatch(COUNT, triangleErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RayTriangle(rayStream, triangle, hits, distances); },
+		[&](size_t i, float32& distance) { return RayTriangle(rays[i], triangle, distance); });
+	CheckRayBatch("RayPlane over rays", planeErrors);
+	CheckRayBatch("RaySphere over rays", sphereErrors);
+	CheckRayBatch("RayAABB over rays", boxErrors);
+	CheckRayBatch("RayTriangle over rays", triangleErrors);
+
+	std::vector<Sphere> spheres(COUNT);
+	std::vector<AABB> boxes(COUNT);
+	std::vector<Triangle> triangles(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		spheres[i] = Sphere(randomVector(4.0f), positive(rng));
+		boxes[i] = AABB::FromCenterExtents(randomVector(4.0f), Vec3(positive(rng), positive(rng), positive(rng)));
+		const Vec3 corner = randomVector(4.0f);
+		triangles[i] = Triangle(corner, corner + randomVector(2.0f), corner + randomVector(2.0f));
+	}
+	const SphereStream sphereStream{ std::span<const Sphere>(spheres) };
+	const AABBStream boxStream{ std::span<const AABB>(boxes) };
+	const TriangleStream triangleStream{ std::span<const Triangle>(triangles) };
+
+	sphereErrors = boxErrors = triangleErrors = {};
+	for (size_t r = 0; r < SINGLE_RAYS; ++r)
+	{
+		const Ray ray = randomRay(r);
+		CompareRayBatch(COUNT, sphereErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RaySphere(ray, sphereStream, hits, distances); },
+			[&](size_t i, float32& distance) { return RaySphere(ray, spheres[i], distance); });
+		CompareRayBatch(COUNT, boxErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RayAABB(ray, boxStream, hits, distances); },
+			[&](size_t i, float32& distance) { return RayAABB(ray, boxes[i], distance); });
+		CompareRayBatch(COUNT, triangleErrors, [&](std::span<uint64> hits, std::span<float32> distances) { RayTriangle(ray, triangleStream, hits, distances); },
+			[&](size_t i, float32& distance) { return RayTriangle(ray, triangles[i], distance); });
+	}
+	CheckRayBatch("RaySphere over spheres", sphereErrors);
+	CheckRayBatch("RayAABB over boxes", boxErrors);
+	CheckRayBatch("RayTriangle over triangles", triangleErrors);
+}
+
+// BVH
+// Bvh queries against brute-force loops over the primitives, for triangle and box
+// hierarchies larger than PARALLEL_GRAIN, after Build() and after moving the primitives
+// and Refit(). Closest hits are compared by distance, ties may pick either primitive.
+// The last hierarchy stacks thousands of boxes on one centroid, which the binning cannot
+// split.
+
+struct BvhMismatches
+{
+	size_t closest = 0;
+	size_t any = 0;
+	size_t overlap = 0;
+};
+
+static bool RayPrimitive(const Ray& ray, const Triangle& triangle, float32& distance)
+{
+	return RayTriangle(ray, triangle, distance);
+}
+
+static bool RayPrimitive(const Ray& ray, const AABB& box, float32& distance)
+{
+	return RayAABB(ray, box, distance);
+}
+
+static AABB PrimitiveBounds(const Triangle& triangle)
+{
+	return Bounds(triangle);
+}
+
+static AABB PrimitiveBounds(const AABB& box)
+{
+	return box;
+}
+
+template<typename Primitive>
+static BvhMismatches CompareBvh(const Bvh& bvh, std::span<const Primitive> primitives, uint32 seed)
+{
+	constexpr size_t RAYS = 300;
+	constexpr size_t VOLUMES = 100;
+
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), positive(0.5f, 4.0f);
+	auto randomVector = [&](float32 scale) { return Vec3(unit(rng), unit(rng), unit(rng)) * scale; };
+
+	BvhMismatches mismatches;
+
+	// Every other ray is limited to a distance of 10.
+	std::vector<Ray> rays(RAYS);
+	std::vector<BvhHit> expected(RAYS);
+	for (size_t i = 0; i < RAYS; ++i)
+	{
+		const Vec3 origin = randomVector(30.0f);
+		rays[i] = Ray(origin, randomVector(10.0f) - origin);
+	}
+	for (float32 maxDistance : { INFINITY, 10.0f })
+	{
+		for (size_t i = 0; i < RAYS; ++i)
+		{
+			expected[i] = BvhHit();
+			for (size_t k = 0; k < primitives.size(); ++k)
+			{
+				float32 t;
+				if (RayPrimitive(rays[i], primitives[k], t) && t < maxDistance && t < expected[i].distance)
+				{
+					expected[i] = { static_cast<uint32>(k), t };
+				}
+			}
+
+			BvhHit hit;
+			float32 distance;
+			const bool found = bvh.ClosestHit(rays[i], hit, maxDistance);
+			mismatches.closest += found != (expected[i].primitive != BvhHit::NONE) || hit.distance != expected[i].distance;
+			mismatches.closest += found && (!RayPrimitive(rays[i], primitives[hit.primitive], distance) || distance != hit.distance);
+			mismatches.any += bvh.AnyHit(rays[i], maxDistance) != (expected[i].primitive != BvhHit::NONE);
+		}
+
+		std::vector<BvhHit> hits(RAYS);
+		std::vector<uint64> occluded((RAYS + 63) / 64, ~uint64(0));
+		bvh.ClosestHit(rays, hits, maxDistance);
+		bvh.AnyHit(rays, occluded, maxDistance);
+		for (size_t i = 0; i < RAYS; ++i)
+		{
+			mismatches.closest += hits[i].distance != expected[i].distance || (hits[i].primitive == BvhHit::NONE) != (expected[i].primitive == BvhHit::NONE);
+			mismatches.any += ((occluded[i / 64] >> (i % 64)) & 1) != (expected[i].primitive != BvhHit::NONE);
+		}
+		mismatches.any += (occluded.back() >> (RAYS % 64)) != 0;
+	}
+
+	// Sorted primitive lists; a primitive reported twice is a mismatch too.
+	auto compareOverlap = [&](auto&& overlaps, auto&& query)
+	{
+		std::vector<uint32> found, brute;
+		query([&](uint32 primitive) { found.push_back(primitive); });
+		for (size_t k = 0; k < primitives.size(); ++k)
+		{
+			if (overlaps(PrimitiveBounds(primitives[k])))
+			{
+				brute.push_back(static_cast<uint32>(k));
+			}
+		}
+		std::sort(found.begin(), found.end());
+		mismatches.overlap += found != brute;
+	};
+	for (size_t i = 0; i < VOLUMES; ++i)
+	{
+		const AABB box = AABB::FromCenterExtents(randomVector(25.0f), Vec3(positive(rng), positive(rng), positive(rng)));
+		const Sphere sphere(randomVector(25.0f), positive(rng));
+		compareOverlap([&](const AABB& bounds) { return Overlaps(bounds, box); }, [&](auto&& f) { bvh.Overlap(box, f); });
+		compareOverlap([&](const AABB& bounds) { return Overlaps(bounds, sphere); }, [&](auto&& f) { bvh.Overlap(sphere, f); });
+	}
+	return mismatches;
+}
+
+static void CheckBvhMismatches(const char* name, const BvhMismatches& mismatches)
+{
+	char label[64];
+	std::snprintf(label, sizeof(label), "%s ClosestHit mismatches", name);
+	Check(label, float64(mismatches.closest), 0.0);
+	std::snprintf(label, sizeof(label), "%s AnyHit mismatches", name);
+	Check(label, float64(mismatches.any), 0.0);
+	std::snprintf(label, sizeof(label), "%s Overlap mismatches", name);
+	Check(label, float64(mismatches.overlap), 0.0);
+}
+
+static void CheckBvh()
+{
+	constexpr size_t COUNT = 3 * Bvh::PARALLEL_GRAIN + 123;
+
+	std::mt19937 rng(18);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), positive(0.05f, 0.5f);
+	auto randomVector = [&](float32 scale) { return Vec3(unit(rng), unit(rng), unit(rng)) * scale; };
+
+	std::vector<Triangle> triangles(COUNT);
+	for (Triangle& triangle : triangles)
+	{
+		const Vec3 corner = randomVector(20.0f);
+		triangle = Triangle(corner, corner + randomVector(1.0f), corner + randomVector(1.0f));
+	}
+
+	Bvh bvh;
+	bvh.Build(std::span<const Triangle>(triangles));
+	CheckBvhMismatches("Bvh triangles", CompareBvh<Triangle>(bvh, triangles, 19));
+
+	for (Triangle& triangle : triangles)
+	{
+		triangle = Triangle(triangle.a + randomVector(0.5f), triangle.b + randomVector(0.5f), triangle.c + randomVector(0.5f));
+	}
+	bvh.Refit(std::span<const Triangle>(triangles));
+	CheckBvhMismatches("Bvh triangles after Refit", CompareBvh<Triangle>(bvh, triangles, 20));
+
+	std::vector<AABB> boxes(COUNT);
+	for (AABB& box : boxes)
+	{
+		box = AABB::FromCenterExtents(randomVector(20.0f), Vec3(positive(rng), positive(rng), positive(rng)));
+	}
+	bvh.Build(std::span<const AABB>(boxes));
+	CheckBvhMismatches("Bvh boxes", CompareBvh<AABB>(bvh, boxes, 21));
+
+	for (AABB& box : boxes)
+	{
+		box = AABB::FromCenterExtents(box.Center() + randomVector(0.5f), box.Extents());
+	}
+	bvh.Refit(std::span<const AABB>(boxes));
+	CheckBvhMismatches("Bvh boxes after Refit", CompareBvh<AABB>(bvh, boxes, 22));
+
+	// Nested boxes around one point, then the rest scattered.
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		boxes[i] = i < 2 * Bvh::PARALLEL_GRAIN
+			? AABB::FromCenterExtents(Vec3(1, 2, 3), Vec3(positive(rng), positive(rng), positive(rng)) * 8.0f)
+			: AABB::FromCenterExtents(randomVector(20.0f), Vec3(positive(rng), positive(rng), positive(rng)));
+	}
+	bvh.Build(std::span<const AABB>(boxes));
+	CheckBvhMismatches("Bvh shared centroid", CompareBvh<AABB>(bvh, boxes, 23));
+}
+
+// SPATIAL HASH GRID
+// SpatialHashGrid queries against brute-force DistanceSquared loops over more than
+// PARALLEL_GRAIN points: radii below and equal to the cell size, and one wider than the
+// table, which scans every point. The build must keep the points of each cell in input
+// order, which both the serial and the parallel sort guarantee.
+
+static void CheckSpatialHashGrid()
+{
+	constexpr size_t COUNT = 3 * SpatialHashGrid::PARALLEL_GRAIN + 321;
+	constexpr size_t QUERIES = 200;
+	constexpr float32 CELL_SIZE = 1.0f;
+
+	std::mt19937 rng(24);
+	std::uniform_real_distribution<float32> coordinate(-15.0f, 15.0f);
+	auto randomPoint = [&]() { return Vec3(coordinate(rng), coordinate(rng), coordinate(rng)); };
+
+	std::vector<Vec3> source(COUNT);
+	for (Vec3& p : source)
+	{
+		p = randomPoint();
+	}
+
+	SpatialHashGrid grid;
+	grid.Build(source, CELL_SIZE);
+
+	size_t orderMismatches = 0;
+	std::map<std::array<float32, 3>, uint32> lastInCell;
+	for (size_t slot = 0; slot < COUNT; ++slot)
+	{
+		const uint32 index = grid.Indices()[slot];
+		const Vec3& p = grid.Points()[slot];
+		orderMismatches += index >= COUNT || p != source[index];
+
+		const std::array<float32, 3> cell = { std::floor(p[0] / CELL_SIZE), std::floor(p[1] / CELL_SIZE), std::floor(p[2] / CELL_SIZE) };
+		auto [it, inserted] = lastInCell.try_emplace(cell, index);
+		orderMismatches += !inserted && it->second >= index;
+		it->second = index;
+	}
+	Check("SpatialHashGrid build order mismatches", float64(orderMismatches), 0.0);
+
+	auto brute = [&](const Vec3& center, float32 radius)
+	{
+		std::vector<uint32> result;
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			if (DistanceSquared(source[i], center) <= radius * radius)
+			{
+				result.push_back(static_cast<uint32>(i));
+			}
+		}
+		return result;
+	};
+
+	std::vector<Vec3> centers(QUERIES);
+	for (Vec3& center : centers)
+	{
+		center = randomPoint();
+	}
+
+	for (float32 radius : { 0.4f, CELL_SIZE, 16.0f })
+	{
+		size_t mismatches = 0;
+		float64 distanceError = 0.0;
+		for (const Vec3& center : centers)
+		{
+			std::vector<uint32> found;
+			grid.Query(center, radius, [&](uint32 index, float32 distanceSquared)
+			{
+				found.push_back(index);
+				const float64 expected = DistanceSquared(source[index], center);
+				distanceError = Max(distanceError, std::abs(distanceSquared - expected) / Max(1.0, expected));
+			});
+			std::sort(found.begin(), found.end());
+			mismatches += found != brute(center, radius);
+		}
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "SpatialHashGrid Query r=%g mismatches", radius);
+		Check(label, float64(mismatches), 0.0);
+		std::snprintf(label, sizeof(label), "SpatialHashGrid Query r=%g distances", radius);
+		Check(label, distanceError, 1e-6);
+	}
+
+	std::vector<uint32> offsets, neighbors;
+	grid.Query(centers, CELL_SIZE, offsets, neighbors);
+	size_t batchMismatches = offsets.size() != QUERIES + 1 || offsets.back() != neighbors.size();
+	for (size_t i = 0; i < QUERIES && !batchMismatches; ++i)
+	{
+		std::vector<uint32> found(neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]);
+		std::sort(found.begin(), found.end());
+		batchMismatches += found != brute(centers[i], CELL_SIZE);
+	}
+	Check("SpatialHashGrid batched Query mismatches", float64(batchMismatches), 0.0);
+
+	// Pairs as (smaller, larger); a self pair or a pair reported twice is a mismatch.
+	constexpr float32 PAIR_RADIUS = 0.3f;
+	std::vector<std::pair<uint32, uint32>> pairs, expectedPairs;
+	size_t pairMismatches = 0;
+	grid.ForEachPair(PAIR_RADIUS, [&](uint32 a, uint32 b, float32)
+	{
+		pairMismatches += a == b;
+		pairs.emplace_back(Min(a, b), Max(a, b));
+	});
+	for (uint32 a = 0; a < COUNT; ++a)
+	{
+		for (uint32 b = a + 1; b < COUNT; ++b)
+		{
+			if (DistanceSquared(source[a], source[b]) <= PAIR_RADIUS * PAIR_RADIUS)
+			{
+				expectedPairs.emplace_back(a, b);
+			}
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+	pairMismatches += pairs != expectedPairs;
+	Check("SpatialHashGrid ForEachPair mismatches", float64(pairMismatches), 0.0);
+}
+
+// K-D TREE
+// KdTree queries against brute-force DistanceSquared loops. Points sit on an integer
+// grid, so there are duplicates and points at exactly the query radius. Nearest results
+// are compared by distance, ties may pick either point. With epsilon each neighbour must
+// be within (1 + epsilon) of the true one of the same rank. Distances may differ in the
+// last bit where the compiler contracts them to FMAs, they are compared relatively.
+
+static bool CloseDistance(float32 value, float32 reference)
+{
+	return std::abs(float64(value) - reference) <= 1e-6 * Max(1.0, float64(reference));
+}
+
+template<size_t N>
+static std::vector<float32> SortedDistances(std::span<const Vec<N, float32>> points, const Vec<N, float32>& query)
+{
+	std::vector<float32> result(points.size());
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		result[i] = DistanceSquared(query, points[i]);
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+// Mismatches of found against the brute-force distances, exact when epsilon is 0.
+template<size_t N>
+static size_t CompareNearest(std::span<const Vec<N, float32>> points, const Vec<N, float32>& query, std::span<const typename KdTree<N>::Neighbor> found, size_t k, float32 epsilon)
+{
+	const std::vector<float32> expected = SortedDistances<N>(points, query);
+	const float64 scale = (1.0 + epsilon) * (1.0 + epsilon) * (1.0 + 1e-6);
+
+	size_t mismatches = found.size() != Min(k, points.size());
+	std::vector<uint32> indices;
+	for (size_t r = 0; r < found.size() && r < expected.size(); ++r)
+	{
+		const auto& neighbor = found[r];
+		if (neighbor.index >= points.size())
+		{
+			++mismatches;
+			continue;
+		}
+		indices.push_back(neighbor.index);
+		mismatches += !CloseDistance(neighbor.distanceSquared, DistanceSquared(query, points[neighbor.index]));
+		mismatches += r > 0 && neighbor.distanceSquared < found[r - 1].distanceSquared;
+		mismatches += epsilon == 0.0f ? !CloseDistance(neighbor.distanceSquared, expected[r]) : neighbor.distanceSquared > expected[r] * scale;
+	}
+	std::sort(indices.begin(), indices.end());
+	mismatches += std::adjacent_find(indices.begin(), indices.end()) != indices.end();
+	return mismatches;
+}
+
+static void CheckKdTree()
+{
+	constexpr size_t COUNT = 3 * KdTree<3>::PARALLEL_GRAIN + 77;
+	constexpr size_t QUERIES = 100;
+
+	std::mt19937 rng(25);
+	std::uniform_int_distribution<int32> grid(-20, 20);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f);
+	auto gridPoint = [&]() { return Vec3(float32(grid(rng)), float32(grid(rng)), float32(grid(rng))); };
+
+	std::vector<Vec3> points(COUNT);
+	for (Vec3& p : points)
+	{
+		p = gridPoint();
+	}
+	KdTree<3> tree;
+	tree.Build(points);
+
+	// Grid queries tie with many points, the others fall between the grid points.
+	std::vector<Vec3> queries(QUERIES);
+	for (size_t q = 0; q < QUERIES; ++q)
+	{
+		queries[q] = q % 2 == 0 ? gridPoint() : Vec3(unit(rng), unit(rng), unit(rng)) * 22.0f;
+	}
+
+	using Neighbor = KdTree<3>::Neighbor;
+	for (size_t k : { 1, 8, 29 })
+	{
+		for (float32 epsilon : { 0.0f, 0.5f })
+		{
+			size_t mismatches = 0;
+			std::vector<Neighbor> found(k);
+			for (const Vec3& query : queries)
+			{
+				const size_t written = tree.Nearest(query, found, epsilon);
+				mismatches += CompareNearest<3>(points, query, std::span<const Neighbor>(found.data(), written), k, epsilon);
+			}
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "KdTree Nearest k=%zu eps=%g mismatches", k, epsilon);
+			Check(label, float64(mismatches), 0.0);
+		}
+	}
+
+	constexpr size_t BATCH_K = 8;
+	std::vector<Neighbor> batch(QUERIES * BATCH_K);
+	tree.Nearest(queries, BATCH_K, batch);
+	size_t batchMismatches = 0;
+	for (size_t q = 0; q < QUERIES; ++q)
+	{
+		batchMismatches += CompareNearest<3>(points, queries[q], std::span<const Neighbor>(batch).subspan(q * BATCH_K, BATCH_K), BATCH_K, 0.0f);
+	}
+	Check("KdTree batched Nearest mismatches", float64(batchMismatches), 0.0);
+
+	// Sorted indices, the integer radius lands exactly on grid points. Each reported
+	// distance must match the point's.
+	auto brute = [&](const Vec3& query, float32 radius)
+	{
+		std::vector<uint32> result;
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			if (DistanceSquared(query, points[i]) <= radius * radius)
+			{
+				result.push_back(static_cast<uint32>(i));
+			}
+		}
+		return result;
+	};
+	auto collect = [&](const Vec3& query, size_t& mismatches, uint32 index, float32 distanceSquared, std::vector<uint32>& found)
+	{
+		mismatches += index >= COUNT || !CloseDistance(distanceSquared, DistanceSquared(query, points[index]));
+		found.push_back(index);
+	};
+
+	for (float32 radius : { 3.0f, 5.5f })
+	{
+		size_t mismatches = 0;
+		for (const Vec3& query : queries)
+		{
+			std::vector<uint32> found;
+			tree.Radius(query, radius, [&](uint32 index, float32 distanceSquared) { collect(query, mismatches, index, distanceSquared, found); });
+			std::sort(found.begin(), found.end());
+			mismatches += found != brute(query, radius);
+		}
+
+		std::vector<uint32> offsets;
+		std::vector<Neighbor> neighbors;
+		tree.Radius(queries, radius, offsets, neighbors);
+		mismatches += offsets.size() != QUERIES + 1 || offsets.back() != neighbors.size();
+		for (size_t q = 0; q < QUERIES && offsets.size() == QUERIES + 1; ++q)
+		{
+			std::vector<uint32> found;
+			for (uint32 n = offsets[q]; n < offsets[q + 1]; ++n)
+			{
+				collect(queries[q], mismatches, neighbors[n].index, neighbors[n].distanceSquared, found);
+			}
+			std::sort(found.begin(), found.end());
+			mismatches += found != brute(queries[q], radius);
+		}
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "KdTree Radius r=%g mismatches", radius);
+		Check(label, float64(mismatches), 0.0);
+	}
+
+	// Fewer points than k: the batched results are padded with default Neighbors.
+	size_t paddingMismatches = 0;
+	KdTree<3> small;
+	small.Build(std::span<const Vec3>(points.data(), 5));
+	std::fill(batch.begin(), batch.end(), Neighbor{ 0, 0.0f });
+	small.Nearest(std::span<const Vec3>(queries.data(), 4), BATCH_K, batch);
+	for (size_t q = 0; q < 4; ++q)
+	{
+		std::span<const Neighbor> result = std::span<const Neighbor>(batch).subspan(q * BATCH_K, BATCH_K);
+		paddingMismatches += CompareNearest<3>(std::span<const Vec3>(points.data(), 5), queries[q], result.first(5), BATCH_K, 0.0f);
+		for (const Neighbor& padding : result.subspan(5))
+		{
+			paddingMismatches += padding.index != Neighbor::NONE || padding.distanceSquared != INFINITY;
+		}
+	}
+	Check("KdTree Nearest padding mismatches", float64(paddingMismatches), 0.0);
+
+	// Empty tree: nothing found, every batched result is padding.
+	size_t emptyMismatches = 0;
+	KdTree<3> empty;
+	empty.Build({});
+	std::vector<Neighbor> found(BATCH_K);
+	emptyMismatches += empty.Nearest(queries[0], found) != 0;
+	empty.Radius(queries[0], 100.0f, [&](uint32, float32) { ++emptyMismatches; });
+	std::fill(batch.begin(), batch.end(), Neighbor{ 0, 0.0f });
+	empty.Nearest(std::span<const Vec3>(queries.data(), 2), BATCH_K, batch);
+	for (size_t n = 0; n < 2 * BATCH_K; ++n)
+	{
+		emptyMismatches += batch[n].index != Neighbor::NONE;
+	}
+	std::vector<uint32> offsets;
+	std::vector<Neighbor> neighbors;
+	empty.Radius(queries, 100.0f, offsets, neighbors);
+	emptyMismatches += !neighbors.empty() || offsets.size() != QUERIES + 1 || offsets.back() != 0;
+	Check("KdTree empty tree mismatches", float64(emptyMismatches), 0.0);
+
+	// Eight dimensions, continuous coordinates.
+	using Vec8 = Vec<8, float32>;
+	std::vector<Vec8> points8(2000);
+	for (Vec8& p : points8)
+	{
+		for (size_t c = 0; c < 8; ++c)
+		{
+			p[c] = unit(rng);
+		}
+	}
+	KdTree<8> tree8;
+	tree8.Build(points8);
+
+	size_t mismatches8 = 0;
+	std::vector<KdTree<8>::Neighbor> found8(8);
+	for (size_t q = 0; q < QUERIES; ++q)
+	{
+		Vec8 query;
+		for (size_t c = 0; c < 8; ++c)
+		{
+			query[c] = unit(rng);
+		}
+		const size_t written = tree8.Nearest(query, found8);
+		mismatches8 += CompareNearest<8>(points8, query, std::span<const KdTree<8>::Neighbor>(found8.data(), written), 8, 0.0f);
+	}
+	Check("KdTree<8> Nearest k=8 mismatches", float64(mismatches8), 0.0);
+}
+
+// GEMM
+// Gemm and Gemv against a float64 triple loop, on shapes that are not multiples of the
+// pack width, GEMM_NR or GEMM_KC, on Blocks of a larger DynMatrix and on fixed-size
+// matrices through MatrixView. With beta = 0 the old C is not read, so NaNs there must
+// not leak. Error relative to alpha * sum |a| |b| + |beta c| per element.
+
+template<typename T>
+static void FillRandom(MatrixView<T> m, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float64> unit(-1.0, 1.0);
+	for (size_t j = 0; j < m.Cols(); ++j)
+	{
+		for (size_t i = 0; i < m.Rows(); ++i)
+		{
+			m(i, j) = T(unit(rng));
+		}
+	}
+}
+
+// c holds alpha * a * b + beta * old, where old is c before the product.
+template<typename T>
+static float64 GemmError(MatrixView<const T> a, MatrixView<const T> b, MatrixView<const T> old, MatrixView<const T> c, float64 alpha, float64 beta)
+{
+	float64 error = 0.0;
+	for (size_t j = 0; j < c.Cols(); ++j)
+	{
+		for (size_t i = 0; i < c.Rows(); ++i)
+		{
+			float64 sum = 0.0, magnitude = 0.0;
+			for (size_t k = 0; k < a.Cols(); ++k)
+			{
+				sum += float64(a(i, k)) * float64(b(k, j));
+				magnitude += std::abs(float64(a(i, k)) * float64(b(k, j)));
+			}
+			const float64 previous = beta == 0.0 ? 0.0 : beta * float64(old(i, j));
+			const float64 scale = std::abs(alpha) * magnitude + std::abs(previous);
+			const float64 difference = std::abs(float64(c(i, j)) - (alpha * sum + previous));
+			error = Max(error, std::isfinite(difference) ? difference / Max(scale, 1e-30) : INFINITY);
+		}
+	}
+	return error;
+}
+
+template<typename T>
+static void CheckGemmType(const char* type, float64 bound)
+{
+	std::mt19937 rng(26);
+	char label[64];
+
+	struct Shape
+	{
+		size_t m, n, k;
+	};
+	for (Shape shape : { Shape{ 130, 600, 257 }, Shape{ 1, 1, 1 } })
+	{
+		DynMatrix<T> a(shape.m, shape.k), b(shape.k, shape.n), c(shape.m, shape.n);
+		FillRandom<T>(a, rng);
+		FillRandom<T>(b, rng);
+
+		float64 error = 0.0;
+		for (auto [alpha, beta] : { std::pair{ 1.0, 0.0 }, std::pair{ -1.5, 0.0 }, std::pair{ 0.75, 0.5 } })
+		{
+			if (beta == 0.0)
+			{
+				std::fill(c.Data(), c.Data() + shape.m * shape.n, std::numeric_limits<T>::quiet_NaN());
+			}
+			else
+			{
+				FillRandom<T>(c, rng);
+			}
+			const DynMatrix<T> old = c;
+			Gemm<T>(a, b, c, T(alpha), T(beta));
+			error = Max(error, GemmError<T>(a, b, old, c, alpha, beta));
+		}
+		std::snprintf(label, sizeof(label), "Gemm<%s> %zux%zux%zu", type, shape.m, shape.n, shape.k);
+		Check(label, error, bound);
+	}
+
+	// A, B and C as disjoint Blocks of one matrix; the rest of it must not change.
+	DynMatrix<T> storage(400, 700);
+	FillRandom<T>(storage, rng);
+	const DynMatrix<T> before = storage;
+	MatrixView<T> a = storage.Block(3, 5, 130, 257), b = storage.Block(140, 5, 257, 301), c = storage.Block(7, 320, 130, 301);
+	Gemm<T>(a, b, c, T(0.5), T(0.5));
+	const float64 blockError = GemmError<T>(a, b, before.Block(7, 320, 130, 301), c, 0.5, 0.5);
+	size_t outside = 0;
+	for (size_t j = 0; j < storage.Cols(); ++j)
+	{
+		for (size_t i = 0; i < storage.Rows(); ++i)
+		{
+			const bool inC = i >= 7 && i < 7 + 130 && j >= 320 && j < 320 + 301;
+			outside += !inC && storage(i, j) != before(i, j);
+		}
+	}
+	std::snprintf(label, sizeof(label), "Gemm<%s> on Blocks", type);
+	Check(label, blockError, bound);
+	std::snprintf(label, sizeof(label), "Gemm<%s> writes outside C", type);
+	Check(label, float64(outside), 0.0);
+
+	// Gemv on a Block, beta = 0 over NaNs then beta = 0.5.
+	MatrixView<const T> matrix = storage.Block(11, 13, 201, 257);
+	std::vector<T> x(257), y(201, std::numeric_limits<T>::quiet_NaN());
+	FillRandom<T>(MatrixView<T>(x.data(), 257, 1), rng);
+	float64 gemvError = 0.0;
+	for (auto [alpha, beta] : { std::pair{ 1.5, 0.0 }, std::pair{ -1.0, 0.5 } })
+	{
+		const std::vector<T> previous = y;
+		Gemv<T>(matrix, x, y, T(alpha), T(beta));
+		gemvError = Max(gemvError, GemmError<T>(matrix, MatrixView<const T>(x.data(), 257, 1), MatrixView<const T>(previous.data(), 201, 1), MatrixView<const T>(y.data(), 201, 1), alpha, beta));
+	}
+	std::snprintf(label, sizeof(label), "Gemv<%s> on a Block", type);
+	Check(label, gemvError, bound);
+}
+
+static void CheckGemm()
+{
+	CheckGemmType<float32>("float32", 1e-5);
+	CheckGemmType<float64>("float64", 1e-13);
+
+	// Fixed-size matrices through MatrixView.
+	std::mt19937 rng(27);
+	Mat4 a;
+	Matrix<4, 3, float32> b, c;
+	FillRandom<float32>(MatrixView<float32>(a), rng);
+	FillRandom<float32>(MatrixView<float32>(b), rng);
+	Gemm<float32>(a, b, c);
+	const Matrix<4, 3, float32> expected = a * b;
+	Check("Gemm Mat4 * Matrix<4, 3>", Max(GemmError<float32>(a, b, c, c, 1.0, 0.0), MaxComponentError(12, 1, [&](size_t e, size_t)
+	{
+		return std::abs(c.Data()[e] - expected.Data()[e]);
+	})), 1e-5);
+}
+
+// TRANSFORM HIERARCHY
+// Every GetWorld() against world[parent] * Translate * R * Scale recomputed from the
+// handles, after the first Update(), after moving random nodes and after reparenting
+// and adding nodes, which re-sorts the levels. Error relative to max(1, |element|).
+
+static void CheckTransformHierarchy()
+{
+	constexpr uint32 COUNT = 20000;
+	static_assert(COUNT > TransformHierarchy::PARALLEL_GRAIN);
+
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<float32> unit(-1.0f, 1.0f), scale(0.9f, 1.1f);
+	const std::vector<Quaternion> rotations = RandomRotations(COUNT + 100, 10);
+
+	std::vector<uint32> parents;
+	std::vector<Vec3> scales;
+	std::vector<Mat4> locals;
+	TransformHierarchy hierarchy;
+	auto add = [&](uint32 parent)
+	{
+		const uint32 node = static_cast<uint32>(parents.size());
+		const Vec3 position(unit(rng), unit(rng), unit(rng)), scaling(scale(rng), scale(rng), scale(rng));
+		hierarchy.AddNode(parent, position, rotations[node], scaling);
+		parents.push_back(parent);
+		scales.push_back(scaling);
+		locals.push_back(Translate(position) * rotations[node].ToMatrix4() * Scale(scaling));
+	};
+	add(TransformHierarchy::NO_PARENT);
+	for (uint32 i = 1; i < COUNT; ++i)
+	{
+		add(i % 1000 == 0 ? TransformHierarchy::NO_PARENT : static_cast<uint32>(rng() % i));
+	}
+
+	auto compare = [&](const char* name)
+	{
+		hierarchy.Update();
+
+		std::vector<Mat4> worlds(parents.size());
+		std::vector<uint8> done(parents.size(), 0);
+		auto world = [&](auto& self, uint32 node) -> const Mat4&
+		{
+			if (!done[node])
+			{
+				worlds[node] = parents[node] == TransformHierarchy::NO_PARENT ? locals[node] : self(self, parents[node]) * locals[node];
+				done[node] = 1;
+			}
+			return worlds[node];
+		};
+
+		float64 error = 0.0;
+		size_t wrongParents = 0;
+		for (uint32 node = 0; node < parents.size(); ++node)
+		{
+			const Mat4& expected = world(world, node);
+			for (size_t e = 0; e < 16; ++e)
+			{
+				const float64 reference = expected.Data()[e];
+				error = Max(error, std::abs(hierarchy.GetWorld(node).Data()[e] - reference) / Max(1.0, std::abs(reference)));
+			}
+			wrongParents += hierarchy.GetParent(node) != parents[node];
+		}
+		Check(name, error, 1e-5);
+		Check("TransformHierarchy GetParent mismatches", float64(wrongParents), 0.0);
+	};
+
+	compare("TransformHierarchy first Update");
+
+	for (size_t k = 0; k < COUNT / 20; ++k)
+	{
+		const uint32 node = rng() % COUNT;
+		const Vec3 position(unit(rng), unit(rng), unit(rng));
+		hierarchy.SetPosition(node, position);
+		locals[node] = Translate(position) * rotations[node].ToMatrix4() * Scale(scales[node]);
+	}
+	compare("TransformHierarchy after SetPosition");
+
+	auto isAncestor = [&](uint32 node, uint32 candidate)
+	{
+		for (uint32 h = candidate; h != TransformHierarchy::NO_PARENT; h = parents[h])
+		{
+			if (h == node)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	for (size_t k = 0; k < 200; ++k)
+	{
+		const uint32 node = rng() % COUNT;
+		uint32 parent = k % 10 == 0 ? TransformHierarchy::NO_PARENT : static_cast<uint32>(rng() % COUNT);
+		if (parent != TransformHierarchy::NO_PARENT && isAncestor(node, parent))
+		{
+			continue;
+		}
+		hierarchy.SetParent(node, parent);
+		parents[node] = parent;
+	}
+	for (size_t k = 0; k < 100; ++k)
+	{
+		add(static_cast<uint32>(rng() % parents.size()));
+	}
+	compare("TransformHierarchy after SetParent");
+}
+
+// ROTATION CONVERSIONS
+// Batched stream.hpp conversions against the scalar Quaternion functions, per component.
+// The scalar side is Exact, so FromEuler and ToEuler also carry the math::fast error of
+// the tier. ToEuler is ill-conditioned at gimbal lock, its rotations keep the asin
+// argument within +-0.99.
+
+static void CheckRotationConversions()
+{
+	// Not a multiple of any pack width: every level runs a tail.
+	constexpr size_t COUNT = 100003;
+
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float32> angle(-PI_f32, PI_f32);
+
+	std::vector<Vec3> euler(COUNT);
+	std::vector<Quaternion> rotations(COUNT);
+	std::vector<Mat3> matrices(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		euler[i] = Vec3(angle(rng), angle(rng), angle(rng));
+		do
+		{
+			rotations[i] = Quaternion::FromEuler(angle(rng), angle(rng), angle(rng));
+		} while (Absolute(2.0f * (rotations[i].w * rotations[i].x - rotations[i].z * rotations[i].y)) > 0.99f);
+		matrices[i] = rotations[i].ToMatrix3();
+	}
+
+	const Vec3Stream eulerStream{ std::span<const Vec3>(euler) };
+	const QuaternionStream rotationStream{ std::span<const Quaternion>(rotations) };
+	const Mat3Stream matrixStream{ std::span<const Mat3>(matrices) };
+
+	// math::fast tiers: Accurate is a few ulp, Fast Sin/Cos 2e-6 and Atan2 3.1e-5 relative.
+	constexpr TrigPrecision TRIG_PRECISIONS[] = { TrigPrecision::Accurate, TrigPrecision::Fast };
+	constexpr const char* TRIG_NAMES[] = { "Accurate", "Fast" };
+	constexpr float64 FROM_EULER_BOUNDS[] = { 1e-6, 5e-6 };
+	constexpr float64 TO_EULER_BOUNDS[] = { 2e-6, 1e-4 };
+
+	for (size_t p = 0; p < std::size(TRIG_PRECISIONS); ++p)
+	{
+		char name[64];
+
+		QuaternionStream fromEuler;
+		FromEuler(eulerStream, fromEuler, TRIG_PRECISIONS[p]);
+		std::snprintf(name, sizeof(name), "FromEuler(%s)", TRIG_NAMES[p]);
+		Check(name, MaxComponentError(COUNT, 4, [&](size_t i, size_t c)
+		{
+			return std::abs(fromEuler.components[c][i] - Components(Quaternion::FromEuler(euler[i][0], euler[i][1], euler[i][2]))[c]);
+		}), FROM_EULER_BOUNDS[p]);
+
+		Vec3Stream toEuler;
+		ToEuler(rotationStream, toEuler, TRIG_PRECISIONS[p]);
+		std::snprintf(name, sizeof(name), "ToEuler(%s)", TRIG_NAMES[p]);
+		Check(name, MaxComponentError(COUNT, 3, [&](size_t i, size_t c)
+		{
+			return std::abs(toEuler.components[c][i] - rotations[i].ToEuler()[c]);
+		}), TO_EULER_BOUNDS[p]);
+	}
+
+	QuaternionStream fromMatrix;
+	FromRotationMatrix(matrixStream, fromMatrix);
+	Check("FromRotationMatrix", MaxComponentError(COUNT, 4, [&](size_t i, size_t c)
+	{
+		return std::abs(fromMatrix.components[c][i] - Components(Quaternion::FromRotationMatrix(matrices[i]))[c]);
+	}), 2e-7);
+
+	Mat3Stream toMatrix3;
+	ToMatrix3(rotationStream, toMatrix3);
+	Check("ToMatrix3", MaxComponentError(COUNT, 9, [&](size_t i, size_t c)
+	{
+		return std::abs(toMatrix3.components[c][i] - matrices[i].Data()[c]);
+	}), 2e-7);
+
+	Mat4Stream toMatrix4;
+	ToMatrix4(rotationStream, toMatrix4);
+	Check("ToMatrix4", MaxComponentError(COUNT, 16, [&](size_t i, size_t c)
+	{
+		return std::abs(toMatrix4.components[c][i] - rotations[i].ToMatrix4().Data()[c]);
+	}), 2e-7);
+}
+
+int main()
+{
+	std::printf("dispatch level %s\n", simd::IsaName(simd::ActiveIsa()));
+	CheckSqrtPrecision();
+	CheckFastTrigonometry();
+	CheckPoseBlending();
+	CheckRotationConversions();
+	CheckSkinning();
+	CheckDualQuaternions();
+	CheckFrustumCulling();
+	CheckRayBatches();
+	CheckBvh();
+	CheckSpatialHashGrid();
+	CheckKdTree();
+	CheckGemm();
+	CheckTransformHierarchy();
+	return failures;
+}